@@ -0,0 +1,128 @@
+/* This is bench.c.  Timing, reporting and baseline comparison for the
+   benchmarks, see bench.h. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "bench.h"
+
+#define BENCH_LINE_LIMIT 256
+
+int    bench_quick;
+int    bench_repeats = BENCH_REPEATS;
+
+static const char *bench_name;
+static const char *baseline_path;
+static double      tolerance = BENCH_TOLERANCE;
+static int         num_regressions;
+
+static void usage(const char *program) /* Print usage and exit */
+{
+    printf("USAGE ERROR: Usage %s [--quick] [--repeat n] [--compare baseline_file] [--tolerance percent]\n", program);
+    exit(1);
+}
+
+void bench_init(int argc, char **argv, const char *name) /* Parse the common options */
+{
+    int i;
+
+    bench_name = name;
+    for (i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+            bench_quick = 1;
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0)
+            bench_repeats = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else
+            usage(argv[0]);
+    }
+}
+
+double bench_now(void) /* Monotonic wall clock, seconds */
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+double bench_best(double (*run)(int arg), int arg) /* Largest result of repeated runs */
+{
+    double best, result;
+    int    i;
+
+    best = run(arg);
+    for (i = 1; i < bench_repeats && !bench_quick; i++)
+    {
+        if ((result = run(arg)) > best)
+            best = result;
+    }
+    return best;
+}
+
+long bench_peak_rss(void) /* Peak resident set size of this process, kilobytes */
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static int find_baseline(const char *metric, double *value) /* Look up a metric in the baseline file */
+{
+    FILE  *file;
+    char   line[BENCH_LINE_LIMIT], name[BENCH_LINE_LIMIT], key[BENCH_LINE_LIMIT];
+    double saved;
+    int    found = 0;
+
+    if ((file = fopen(baseline_path, "r")) == NULL)
+    {
+        printf("FILE ERROR: Baseline File \"%s\" Cannot Be Opened\n", baseline_path);
+        exit(4);
+    }
+    while (!found && fgets(line, BENCH_LINE_LIMIT, file) != NULL)
+    {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%255s %255s %lf", name, key, &saved) == 3 &&
+            strcmp(name, bench_name) == 0 && strcmp(key, metric) == 0)
+        {
+            *value = saved;
+            found = 1;
+        }
+    }
+    fclose(file);
+    return found;
+}
+
+void bench_report(const char *metric, double value, const char *unit, int better) /* Print one result */
+{
+    double saved, change;
+
+    printf("%s %s %.6g %s %s\n", bench_name, metric, value, unit, better == BENCH_HIGHER ? "higher" : "lower");
+    if (baseline_path == NULL || bench_quick)
+        return;
+
+    if (!find_baseline(metric, &saved) || saved == 0)
+    {
+        printf("# %s %s: no baseline\n", bench_name, metric);
+        return;
+    }
+    change = 100.0 * (value - saved) / saved;
+    if (better == BENCH_LOWER) change = -change;
+    printf("# %s %s: %+.1f%% against baseline %.6g%s\n", bench_name, metric, change, saved,
+           change < -tolerance ? "  REGRESSION" : "");
+    if (change < -tolerance)
+        num_regressions++;
+}
+
+int bench_finish(void) /* Exit status:  1 if any metric regressed */
+{
+    fflush(stdout);
+    return num_regressions > 0;
+}
@@ -0,0 +1,33 @@
+/* This is bench.h.  Shared harness for the benchmarks in this directory.
+
+   Every benchmark prints its results as lines of
+
+       <benchmark> <metric> <value> <unit> <higher|lower>
+
+   where the last field says which direction is better.  Saving that output
+   gives a baseline;  running a benchmark with --compare <baseline> checks
+   each metric against the saved line of the same benchmark and metric, and
+   exits with status 1 if any is worse by more than the tolerance.  Rates are
+   the best of several repetitions, which is far steadier than a mean on a
+   shared machine. */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#define BENCH_TOLERANCE  10.0   /* Default allowed regression, percent. */
+#define BENCH_REPEATS    3      /* Default repetitions, the best is reported. */
+
+#define BENCH_HIGHER     1      /* Larger values are better, e.g. rates. */
+#define BENCH_LOWER      2      /* Smaller values are better, e.g. memory. */
+
+extern int    bench_quick;      /* --quick:  shorter runs, for smoke tests. */
+extern int    bench_repeats;    /* --repeat n:  repetitions of each measurement. */
+
+extern void   bench_init(int argc, char **argv, const char *name);
+extern double bench_now(void);
+extern double bench_best(double (*run)(int arg), int arg);
+extern long   bench_peak_rss(void);
+extern void   bench_report(const char *metric, double value, const char *unit, int better);
+extern int    bench_finish(void);
+
+#endif
@@ -0,0 +1,92 @@
+/* End-to-end benchmark:  the emergency department model of er_bench.cfg run
+   in process at a fixed seed, reporting events per second and peak memory. */
+
+#include <string.h>
+#include "simlib.h"
+#include "pathway.h"
+#include "scenario.h"
+#include "bench.h"
+
+#define MAX_NUM_PATIENTS    100  /* As in er_sim.c. */
+#define THRESHOLD_SEVERITY    4
+#define MIN_DURATION        0.1
+
+static struct scenario scenario;
+static long   events;
+
+static void bench_error(char *msg, int code) /* Stop on a model error */
+{
+    printf("%s", msg);
+    exit(code);
+}
+
+static double run(int unused) /* Events per second of one run of the scenario */
+{
+    double start;
+    int    i;
+
+    (void) unused;
+    maxatr = 4;
+    pathway_size();
+    init_simlib();
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        pathway.stages[i].stream = i;
+        lcgrandst(stream_seed(scenario.seed, i), i);
+    }
+    pathway_start();
+
+    /* The event loop of er_sim. */
+    events = 0;
+    start = bench_now();
+    while (pathway.num_completed <= scenario.value[P_GOAL_PATIENTS_SIMULATED])
+    {
+        timing();
+        pathway_dispatch();
+        events++;
+    }
+    return events / (bench_now() - start);
+}
+
+int main(int argc, char **argv)
+{
+    struct config   cfg;
+    struct param    params[NUM_PARAMS + 2];
+    double rate;
+    int    i;
+
+    bench_init(argc, argv, "er");
+
+    /* Load the scenario and the pathway from the same file. */
+    if (config_read(&cfg, BENCH_DIR "/er_bench.cfg") != 0)
+        return 13;
+    scenario_defaults(&scenario);
+    if (scenario_load(&scenario, &cfg, config_find(&cfg, "defaults", NULL)) != 0)
+        return 2;
+    if (bench_quick)
+        scenario.value[P_GOAL_PATIENTS_SIMULATED] = 10000;
+
+    for (i = 0; i < NUM_PARAMS; i++)
+    {
+        strcpy(params[i].name, param_specs[i].name);
+        params[i].value = scenario.value[i];
+    }
+    strcpy(params[NUM_PARAMS].name, "max_num_patients");
+    params[NUM_PARAMS].value = MAX_NUM_PATIENTS;
+    strcpy(params[NUM_PARAMS + 1].name, "threshold_severity");
+    params[NUM_PARAMS + 1].value = THRESHOLD_SEVERITY;
+
+    pathway.min_duration = MIN_DURATION;
+    pathway.on_error = bench_error;
+    if (pathway_compile(&cfg, params, NUM_PARAMS + 2) != 0)
+        return 13;
+
+    rate = bench_best(run, 0);
+    bench_report("events_per_sec", rate,             "events/s", BENCH_HIGHER);
+    bench_report("run_time",       events / rate,    "s",        BENCH_LOWER);
+    bench_report("peak_rss",       bench_peak_rss(), "kB",       BENCH_LOWER);
+    printf("# events %ld, mean patients %.3f\n", events, filest(pathway_resource("patients")->list));
+    pathway_free();
+    config_free(&cfg);
+    return bench_finish();
+}
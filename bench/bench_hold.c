@@ -0,0 +1,38 @@
+/* Event-list hold benchmark:  keep n events pending, then repeatedly take the
+   next one with timing() and schedule a replacement an exponential time
+   later, the classic "hold" model of a future event list. */
+
+#include "simlib.h"
+#include "bench.h"
+
+static long ops;
+
+static double hold(int pending) /* Holds per second with this many events pending */
+{
+    double start;
+    long   i;
+
+    maxatr = 4;
+    init_simlib();
+    for (i = 0; i < pending; i++)
+        event_schedule(expon(1.0, 1), 1);
+
+    start = bench_now();
+    for (i = 0; i < ops; i++)
+    {
+        timing();
+        event_schedule(sim_time + expon(1.0, 1), 1);
+    }
+    return ops / (bench_now() - start);
+}
+
+int main(int argc, char **argv)
+{
+    bench_init(argc, argv, "hold");
+    ops = bench_quick ? 100000 : 2000000;
+
+    bench_report("holds_per_sec_100",    bench_best(hold, 100),    "ops/s", BENCH_HIGHER);
+    bench_report("holds_per_sec_10000",  bench_best(hold, 10000),  "ops/s", BENCH_HIGHER);
+    bench_report("holds_per_sec_100000", bench_best(hold, 100000), "ops/s", BENCH_HIGHER);
+    return bench_finish();
+}
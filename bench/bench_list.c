@@ -0,0 +1,47 @@
+/* List churn benchmark:  list_file and list_remove on a list kept at a fixed
+   length, both as a FIFO queue and ordered on an attribute. */
+
+#include "simlib.h"
+#include "bench.h"
+
+static long ops;
+static int  option;
+
+static double churn(int length) /* File/remove pairs per second */
+{
+    double start;
+    long   i;
+
+    maxatr = 4;
+    init_simlib();
+    list_rank[1] = 1;
+    for (i = 0; i < length; i++)
+    {
+        transfer[1] = length * lcgrand(2);
+        list_file(option, 1);
+    }
+
+    /* Ranks drift upwards, so ordered inserts land anywhere in the list. */
+    start = bench_now();
+    for (i = 0; i < ops; i++)
+    {
+        transfer[1] = i + length * lcgrand(2);
+        list_file(option, 1);
+        list_remove(FIRST, 1);
+    }
+    return ops / (bench_now() - start);
+}
+
+int main(int argc, char **argv)
+{
+    bench_init(argc, argv, "list");
+    ops = bench_quick ? 100000 : 2000000;
+
+    option = LAST;
+    bench_report("fifo_per_sec_10",        bench_best(churn, 10),   "ops/s", BENCH_HIGHER);
+    bench_report("fifo_per_sec_1000",      bench_best(churn, 1000), "ops/s", BENCH_HIGHER);
+    option = INCREASING;
+    bench_report("increasing_per_sec_10",  bench_best(churn, 10),   "ops/s", BENCH_HIGHER);
+    bench_report("increasing_per_sec_100", bench_best(churn, 100),  "ops/s", BENCH_HIGHER);
+    return bench_finish();
+}
@@ -0,0 +1,118 @@
+/* Process benchmark:  the hold model of bench_hold with each pending event a
+   coroutine delaying itself again, the memory a process costs while it
+   waits, and patients seizing and releasing nurses through an M/M/c queue. */
+
+#include "simlib.h"
+#include "process.h"
+#include "bench.h"
+
+#define EVENT_RESUME  1
+
+struct visit {                  /* Frame of a patient process. */
+    struct process process;
+    float  arrived;
+    float  severity;
+};
+
+static long ops, completed;
+static struct process_resource nurses;
+
+static void holder(struct process *self) /* Delays itself forever */
+{
+    PROCESS_BEGIN(self);
+    for (;;)
+        PROCESS_DELAY(self, expon(1.0, 1));
+    PROCESS_END(self);
+}
+
+static void patient(struct process *self) /* Triage by a nurse, then leave */
+{
+    struct visit *visit = (struct visit *) self;
+
+    PROCESS_BEGIN(self);
+    visit->arrived = sim_time;
+    PROCESS_SEIZE(self, &nurses);
+    visit->severity = normal(3, 2);
+    PROCESS_DELAY(self, expon(10.0, 2));
+    process_release(&nurses);
+    completed++;
+    PROCESS_END(self);
+}
+
+static void arrivals(struct process *self) /* Starts a patient every 1.5 minutes on average */
+{
+    PROCESS_BEGIN(self);
+    for (;;)
+    {
+        process_start(patient, 0);
+        PROCESS_DELAY(self, expon(1.5, 3));
+    }
+    PROCESS_END(self);
+}
+
+static double hold(int pending) /* Resumes per second with this many processes waiting */
+{
+    double start;
+    long   i;
+
+    maxatr = 4;
+    init_simlib();
+    process_init(sizeof(struct visit), EVENT_RESUME);
+    for (i = 0; i < pending; i++)
+        process_start(holder, expon(1.0, 1));
+
+    start = bench_now();
+    for (i = 0; i < ops; i++)
+    {
+        timing();
+        process_resume();
+    }
+    return ops / (bench_now() - start);
+}
+
+static double flow(int servers) /* Patients through the nurses per second */
+{
+    double start;
+
+    maxatr = 4;
+    init_simlib();
+    process_init(sizeof(struct visit), EVENT_RESUME);
+    nurses = (struct process_resource) {.capacity = servers};
+    completed = 0;
+    process_start(arrivals, 0);
+
+    start = bench_now();
+    while (completed < ops / 4)
+    {
+        timing();
+        process_resume();
+    }
+    return completed / (bench_now() - start);
+}
+
+static double frame_bytes(int pending) /* Memory of each waiting process, frame and event */
+{
+    long before, i;
+
+    maxatr = 4;
+    init_simlib();
+    process_init(sizeof(struct visit), EVENT_RESUME);
+    before = bench_peak_rss();
+    for (i = 0; i < pending; i++)
+        process_start(holder, expon(1.0, 1));
+    return (bench_peak_rss() - before) * 1024.0 / pending;
+}
+
+int main(int argc, char **argv)
+{
+    bench_init(argc, argv, "process");
+    ops = bench_quick ? 100000 : 2000000;
+
+    /* Memory first, while the peak resident size is still that of startup. */
+    bench_report("bytes_per_process_1000000", frame_bytes(1000000), "bytes", BENCH_LOWER);
+    bench_report("resumes_per_sec_100",    bench_best(hold, 100),    "ops/s", BENCH_HIGHER);
+    bench_report("resumes_per_sec_100000", bench_best(hold, 100000), "ops/s", BENCH_HIGHER);
+    bench_report("patients_per_sec_7",     bench_best(flow, 7),      "patients/s", BENCH_HIGHER);
+    process_free();
+    return bench_finish();
+}
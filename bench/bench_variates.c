@@ -0,0 +1,45 @@
+/* Variate generation benchmark:  draws per second from each simlib
+   generator.  The sum is printed so the draws cannot be optimized away. */
+
+#include "simlib.h"
+#include "bench.h"
+
+#define VARIATE_LCGRAND  1
+#define VARIATE_EXPON    2
+#define VARIATE_NORMAL   3
+#define VARIATE_UNIFORM  4
+#define VARIATE_ERLANG   5
+
+static double sum;
+static long   n;
+
+static double draws(int variate) /* Draws per second */
+{
+    double start;
+    long   i;
+
+    start = bench_now();
+    switch (variate)
+    {
+        case VARIATE_LCGRAND: for (i = 0; i < n; i++) sum += lcgrand(3);                break;
+        case VARIATE_EXPON:   for (i = 0; i < n; i++) sum += expon(10.0, 3);            break;
+        case VARIATE_NORMAL:  for (i = 0; i < n; i++) sum += normal(10.0, 3);           break;
+        case VARIATE_UNIFORM: for (i = 0; i < n; i++) sum += uniform(5.0, 15.0, 3);     break;
+        case VARIATE_ERLANG:  for (i = 0; i < n; i++) sum += erlang(3, 10.0, 3);        break;
+    }
+    return n / (bench_now() - start);
+}
+
+int main(int argc, char **argv)
+{
+    bench_init(argc, argv, "variates");
+    n = bench_quick ? 200000 : 10000000;
+
+    bench_report("lcgrand_per_sec", bench_best(draws, VARIATE_LCGRAND), "draws/s", BENCH_HIGHER);
+    bench_report("expon_per_sec",   bench_best(draws, VARIATE_EXPON),   "draws/s", BENCH_HIGHER);
+    bench_report("normal_per_sec",  bench_best(draws, VARIATE_NORMAL),  "draws/s", BENCH_HIGHER);
+    bench_report("uniform_per_sec", bench_best(draws, VARIATE_UNIFORM), "draws/s", BENCH_HIGHER);
+    bench_report("erlang_per_sec",  bench_best(draws, VARIATE_ERLANG),  "draws/s", BENCH_HIGHER);
+    printf("# checksum %.6g\n", sum);
+    return bench_finish();
+}
@@ -0,0 +1,23 @@
+# Writes OUTPUT, a header defining ER_SIM_BUILD_ID as a hash of the sources
+# in SOURCE_DIR, for the result cache (see results.h).  The header is only
+# rewritten when the hash changes.
+#
+#   cmake -DSOURCE_DIR=<dir> -DOUTPUT=<header> -P build_id.cmake
+
+file(GLOB sources ${SOURCE_DIR}/*.c ${SOURCE_DIR}/*.h ${SOURCE_DIR}/CMakeLists.txt)
+list(SORT sources)
+set(hashes "")
+foreach(source ${sources})
+    file(SHA256 ${source} hash)
+    string(APPEND hashes ${hash})
+endforeach()
+string(SHA256 id "${hashes}")
+string(SUBSTRING ${id} 0 16 id)
+
+set(header "#define ER_SIM_BUILD_ID \"${id}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} old)
+endif()
+if(NOT old STREQUAL header)
+    file(WRITE ${OUTPUT} ${header})
+endif()
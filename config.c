@@ -0,0 +1,230 @@
+/* This is config.c.  Reader for the sectioned configuration files described
+   in config.h. */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+static char *trim(char *str) /* Strip leading and trailing whitespace */
+{
+    char *end;
+
+    while (isspace((unsigned char)*str)) str++;
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return str;
+}
+
+static char *copy_string(const char *str) /* Heap copy of a string */
+{
+    char *copy = (char *) malloc(strlen(str) + 1);
+
+    strcpy(copy, str);
+    return copy;
+}
+
+static int parse_line(struct config *cfg, char *line, int line_num) /* Parse one line */
+{
+    char *comment, *close, *name, *key, *value;
+    struct config_section *section;
+    struct config_entry   *entry;
+
+    if ((comment = strpbrk(line, "#;")) != NULL) *comment = '\0';
+    line = trim(line);
+    if (*line == '\0') return 0;
+
+    /* Section header. */
+    if (*line == '[')
+    {
+        if ((close = strchr(line, ']')) == NULL || close[1] != '\0')
+        {
+            printf("CONFIG ERROR: %s:%d: Unterminated Section Header\n", cfg->origin, line_num);
+            return -1;
+        }
+        *close = '\0';
+        line = trim(line + 1);
+        name = line + strcspn(line, " \t");
+        if (*name != '\0') *name++ = '\0';
+        name = trim(name);
+        if (*line == '\0')
+        {
+            printf("CONFIG ERROR: %s:%d: Empty Section Header\n", cfg->origin, line_num);
+            return -1;
+        }
+
+        if (cfg->num_sections == cfg->max_sections)
+        {
+            cfg->max_sections = cfg->max_sections ? 2 * cfg->max_sections : 16;
+            cfg->sections = (struct config_section *)
+                realloc(cfg->sections, cfg->max_sections * sizeof(struct config_section));
+        }
+        section = &cfg->sections[cfg->num_sections++];
+        section->type        = copy_string(line);
+        section->name        = copy_string(name);
+        section->line        = line_num;
+        section->first_entry = cfg->num_entries;
+        section->num_entries = 0;
+        return 0;
+    }
+
+    /* Key = value entry. */
+    if ((value = strchr(line, '=')) == NULL)
+    {
+        printf("CONFIG ERROR: %s:%d: Expected \"key = value\"\n", cfg->origin, line_num);
+        return -1;
+    }
+    *value++ = '\0';
+    key   = trim(line);
+    value = trim(value);
+    if (*key == '\0')
+    {
+        printf("CONFIG ERROR: %s:%d: Missing Key\n", cfg->origin, line_num);
+        return -1;
+    }
+    if (cfg->num_sections == 0)
+    {
+        printf("CONFIG ERROR: %s:%d: Entry Outside Of Any Section\n", cfg->origin, line_num);
+        return -1;
+    }
+
+    if (cfg->num_entries == cfg->max_entries)
+    {
+        cfg->max_entries = cfg->max_entries ? 2 * cfg->max_entries : 64;
+        cfg->entries = (struct config_entry *)
+            realloc(cfg->entries, cfg->max_entries * sizeof(struct config_entry));
+    }
+    entry = &cfg->entries[cfg->num_entries++];
+    entry->key   = copy_string(key);
+    entry->value = copy_string(value);
+    entry->line  = line_num;
+    cfg->sections[cfg->num_sections - 1].num_entries++;
+    return 0;
+}
+
+int config_parse(struct config *cfg, const char *text, const char *origin) /* Parse config text */
+{
+    char line[CONFIG_LINE_LIMIT];
+    int  line_num, length;
+
+    memset(cfg, 0, sizeof(struct config));
+    strncpy(cfg->origin, origin, CONFIG_LINE_LIMIT - 1);
+
+    for (line_num = 1; *text != '\0'; line_num++)
+    {
+        length = strcspn(text, "\n");
+        if (length >= CONFIG_LINE_LIMIT)
+        {
+            printf("CONFIG ERROR: %s:%d: Line Too Long\n", cfg->origin, line_num);
+            config_free(cfg);
+            return -1;
+        }
+        memcpy(line, text, length);
+        line[length] = '\0';
+        text += length;
+        if (*text == '\n') text++;
+
+        if (parse_line(cfg, line, line_num) != 0)
+        {
+            config_free(cfg);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int config_read(struct config *cfg, const char *path) /* Parse a config file */
+{
+    FILE *file;
+    char *text;
+    long  size;
+    int   status;
+
+    if ((file = fopen(path, "r")) == NULL)
+    {
+        printf("CONFIG ERROR: Config File \"%s\" Cannot Be Opened\n", path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    rewind(file);
+    text = (char *) malloc(size + 1);
+    size = fread(text, 1, size, file);
+    text[size] = '\0';
+    fclose(file);
+
+    status = config_parse(cfg, text, path);
+    free(text);
+    return status;
+}
+
+void config_merge(struct config *cfg, struct config *defaults) /* Append sections missing from cfg */
+{
+    struct config_section *section;
+    char   line[CONFIG_LINE_LIMIT];
+    int    i, j;
+
+    for (i = 0; i < defaults->num_sections; i++)
+    {
+        section = &defaults->sections[i];
+        if (config_find(cfg, section->type, section->name) != NULL)
+            continue;
+
+        snprintf(line, CONFIG_LINE_LIMIT, "[%s %s]", section->type, section->name);
+        parse_line(cfg, line, section->line);
+        for (j = section->first_entry; j < section->first_entry + section->num_entries; j++)
+        {
+            snprintf(line, CONFIG_LINE_LIMIT, "%s = %s", defaults->entries[j].key, defaults->entries[j].value);
+            parse_line(cfg, line, defaults->entries[j].line);
+        }
+    }
+}
+
+void config_free(struct config *cfg) /* Release a parsed config */
+{
+    int i;
+
+    for (i = 0; i < cfg->num_sections; i++)
+    {
+        free(cfg->sections[i].type);
+        free(cfg->sections[i].name);
+    }
+    for (i = 0; i < cfg->num_entries; i++)
+    {
+        free(cfg->entries[i].key);
+        free(cfg->entries[i].value);
+    }
+    free(cfg->sections);
+    free(cfg->entries);
+    cfg->sections = NULL;
+    cfg->entries = NULL;
+    cfg->num_sections = cfg->max_sections = 0;
+    cfg->num_entries = cfg->max_entries = 0;
+}
+
+struct config_section *config_find(struct config *cfg, const char *type, const char *name) /* Find a section */
+{
+    int i;
+
+    for (i = 0; i < cfg->num_sections; i++)
+    {
+        if (strcmp(cfg->sections[i].type, type) == 0 &&
+            (name == NULL || strcmp(cfg->sections[i].name, name) == 0))
+            return &cfg->sections[i];
+    }
+    return NULL;
+}
+
+char *config_value(struct config *cfg, struct config_section *section, const char *key) /* Look up a key */
+{
+    int i;
+
+    for (i = section->first_entry; i < section->first_entry + section->num_entries; i++)
+    {
+        if (strcmp(cfg->entries[i].key, key) == 0)
+            return cfg->entries[i].value;
+    }
+    return NULL;
+}
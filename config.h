@@ -0,0 +1,46 @@
+/* This is config.h. */
+
+/* Sectioned key = value configuration files:
+
+       # comment
+       [type name]
+       key = value
+
+   A section header is a type word optionally followed by a name, for example
+   [route follow_up].  Entries keep the order they appear in the file. */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#define CONFIG_LINE_LIMIT  512  /* Longest line accepted in a config file. */
+
+struct config_entry {
+    char *key;
+    char *value;
+    int   line;
+};
+
+struct config_section {
+    char *type;
+    char *name;                 /* Empty string when the header has no name. */
+    int   line;
+    int   first_entry;          /* Entries of a section are contiguous. */
+    int   num_entries;
+};
+
+struct config {
+    char                   origin[CONFIG_LINE_LIMIT];
+    struct config_section *sections;
+    struct config_entry   *entries;
+    int                    num_sections, max_sections;
+    int                    num_entries, max_entries;
+};
+
+extern int   config_read(struct config *cfg, const char *path);
+extern int   config_parse(struct config *cfg, const char *text, const char *origin);
+extern void  config_merge(struct config *cfg, struct config *defaults);
+extern void  config_free(struct config *cfg);
+extern struct config_section *config_find(struct config *cfg, const char *type, const char *name);
+extern char *config_value(struct config *cfg, struct config_section *section, const char *key);
+
+#endif
@@ -1,440 +1,1389 @@
-/* External definitions for emergency department using simlib. */
-
-#include "simlib.h"             /* Required for use of simlib.c. */
-#include <string.h>
-#include <time.h>
-
-#define EVENT_WALKIN_ARRIVAL          1  /* Event type walkin arrival */
-#define EVENT_AMBULANCE_ARRIVAL       2  /* Event type ambulance arrival */
-#define EVENT_TRIAGE_PATIENT          3  /* Event type triage patient */
-#define EVENT_INITIAL_ASSESMENT       4  /* Event type intial assesment */
-#define EVENT_RUN_TESTS               5  /* Event type run tests */
-#define EVENT_FOLLOW_UP_ASSESSMENT    6  /* Event type follow-up assessment */
-#define EVENT_PATIENT_DISCHARGE       7  /* Event type patient discharge */
-#define LIST_ACTIVE_PATIENTS          1  /* List number for tracking active patients */
-#define LIST_ACTIVE_NURSES            2  /* List number for tracking active nurses */
-#define LIST_ACTIVE_DOCTORS           3  /* List number for tracking active doctors */
-#define LIST_ACTIVE_EXAM_ROOMS        4  /* List number for tracking active exam rooms */
-#define LIST_ACTIVE_LABS              5  /* List number for tracking active labs */
-#define LIST_ACTIVE_HOSPITAL_ROOMS    6  /* List number for tracking active hospital rooms */
-#define MAX_NUM_PATIENTS            100  /* Maximum number of patients in the ER */
-#define FILENAME_LIMIT               50  /* Limit filename size */
-#define MIN_DURATION                0.1  /* Minimum duration of any process */
-#define THRESHOLD_SEVERITY            4  /* Sets the level of severity to be seen immediately */
-
-/* Declare non-simlib global variables. */
-int    RANDOM_STREAMS[8], num_patients_simulated;
-int    num_doctors, num_exam_rooms, num_nurses, num_labs, num_hospital_rooms, goal_patients_simulated; 
-float  mean_walkin_interarrival, mean_ambulance_interarrival, mean_triage_duration, 
-       mean_initial_assessment_duration, mean_follow_up_assessment_duration, 
-       mean_test_duration, mean_hospital_duration, mean_severity;
-float  addmittance_chance, specialist_chance, severity, random_var;
-FILE*  outfile;
-char   outfile_name[FILENAME_LIMIT];
-char   error_msg[100];
-time_t seconds;
-
-/* Declare non-simlib functions. */
-void try_input(float, char*);
-void try_output(int);
-void init_model(void);
-void catch_exception(char*, int);
-void report(void);
-
-int main(int argc, char** argv)  /* Main function. */
-{
-    /* Verify correct number of arguments. */
-    if (argc != 18)
-    {
-        printf("USAGE ERROR: Usage %s [mean_walkin_arrival] [mean_ambulance_arrival] [mean_triage_duration]\n\
-[mean_initial_assessment_duration] [mean_test_duration] [mean_follow_up_assessment_duration] [mean_hospital_duration]\n\
-[mean_severity] [num_doctors] [num_nurses] [num_exam_rooms] [num_labs] [num_hospital_rooms] [addmittance_chance]\n\
-[specialist_chance] [goal_patients_simulated] [output_file_name]\n", argv[0]);
-        exit(1);
-    }
-
-    /* Read and validate input parameters. */
-    try_input(mean_walkin_interarrival = atof(argv[1]), argv[1]);
-    try_input(mean_ambulance_interarrival = atof(argv[2]), argv[2]);
-    try_input(mean_triage_duration = atof(argv[3]), argv[3]);
-    try_input(mean_initial_assessment_duration = atof(argv[4]), argv[4]);
-    try_input(mean_test_duration = atof(argv[5]), argv[5]);
-    try_input(mean_follow_up_assessment_duration = atof(argv[6]), argv[6]);
-    try_input(mean_hospital_duration = atof(argv[7]), argv[7]);
-    try_input(mean_severity = atof(argv[8]), argv[8]);
-    try_input((float)(num_doctors = atoi(argv[9])), argv[9]);
-    try_input((float)(num_nurses = atoi(argv[10])), argv[10]);
-    try_input((float)(num_exam_rooms = atoi(argv[11])), argv[11]);
-    try_input((float)(num_labs = atoi(argv[12])), argv[12]);
-    try_input((float)(num_hospital_rooms = atoi(argv[13])), argv[13]);
-    try_input(addmittance_chance = atof(argv[14]), argv[14]);
-    try_input(specialist_chance = atof(argv[15]), argv[15]);
-    try_input((float)(goal_patients_simulated = atoi(argv[16])), argv[16]);
-
-    /* Calculate mean walk-in interarrival and mean ambulance interarrival time */
-    mean_walkin_interarrival = 1.0 / mean_walkin_interarrival;
-    mean_ambulance_interarrival = 1.0 / mean_ambulance_interarrival;
-
-    /* Verify probability adds to 1 for what can happen to a patient in EVENT_FOLLOW_UP_ASSESSMENT */
-    if (addmittance_chance + specialist_chance >= 1)
-    {
-        sprintf(error_msg, "PROBABILITY ERROR: Addmittance Chance And Specialist Chance Sum >= 1\n");
-        catch_exception(error_msg, 11);
-    }
-
-    /* Verify that outfile_name is within the FILENAME_LIMIT */
-    if (strlen(argv[17]) + 8 >= FILENAME_LIMIT)
-    {
-        printf("FILENAME ERROR: Filename Too Long\n");
-        exit(3);
-    }
-    strcpy(outfile_name, "out/");
-    strcat(outfile_name, argv[17]);
-    strcat(outfile_name, ".out");
-
-    /* Open Output file. */
-    outfile = fopen(outfile_name, "w");
-
-    /* Verify the output file has been sucessfully opened. */
-    if (outfile == NULL) {
-        printf("FILE ERROR: Output File \"%s\" Cannot Be Opened\n", outfile_name);
-        exit(4);
-    }
-
-    /* Write report heading and input parameters. */
-    try_output(fprintf(outfile, "            Emergency Room Simulation using Simlib\n"));
-    try_output(fprintf(outfile, "--------------------------------------------------------------\n\n"));
-    try_output(fprintf(outfile, "[CONSTANTS]\n\n"));
-    try_output(fprintf(outfile, "Maximum capacity of patients:%21d patients\n\n", MAX_NUM_PATIENTS));
-    try_output(fprintf(outfile, "Maximum length of filename:%23d characters\n\n", FILENAME_LIMIT));
-    try_output(fprintf(outfile, "Minimum duration of any process:%18.3f minutes\n\n", MIN_DURATION));
-    try_output(fprintf(outfile, "Severity threshold for immediate action:%10d\n\n\n", THRESHOLD_SEVERITY));
-    try_output(fprintf(outfile, "[INPUT PARAMETERS]\n\n"));
-    try_output(fprintf(outfile, "Mean walk-in arrival rate:%24.3f patients per minute\n\n",
-            1.0/mean_walkin_interarrival));
-    try_output(fprintf(outfile, "Mean ambulance arrival rate:%22.3f patients per minute\n\n",
-            1.0/mean_ambulance_interarrival));
-    try_output(fprintf(outfile, "Mean triage duration:%29.3f minutes\n\n", mean_triage_duration));
-    try_output(fprintf(outfile, "Mean initial assessment duration:%17.3f minutes\n\n", mean_initial_assessment_duration));
-    try_output(fprintf(outfile, "Mean test duration:%31.3f minutes\n\n", mean_test_duration));
-    try_output(fprintf(outfile, "Mean follow-up assessment duration:%15.3f minutes\n\n", mean_follow_up_assessment_duration));
-    try_output(fprintf(outfile, "Mean hospital stay duration:%22.3f minutes\n\n", mean_hospital_duration));
-    try_output(fprintf(outfile, "Mean patient severity:%28.3f\n\n", mean_severity));
-    try_output(fprintf(outfile, "Number of doctors available:%22d\n\n", num_doctors));
-    try_output(fprintf(outfile, "Number of nurses available:%23d\n\n", num_nurses));
-    try_output(fprintf(outfile, "Number of exam rooms available:%19d\n\n", num_exam_rooms));
-    try_output(fprintf(outfile, "Number of labs available:%25d\n\n", num_labs));
-    try_output(fprintf(outfile, "Number of hospital rooms available:%15d\n\n", num_hospital_rooms));
-    try_output(fprintf(outfile, "Chance to be admitted to the hospital:%12.3f\n\n", addmittance_chance));
-    try_output(fprintf(outfile, "Chance to see a specialist:%23.3f\n\n", specialist_chance));
-    try_output(fprintf(outfile, "Number of patients to simulate:%19d\n\n\n", goal_patients_simulated));
-    
-
-    /* Initialize simlib */
-    init_simlib();
-
-    /* Set maxatr = max(maximum number of attributes per record, 4) */
-    maxatr = 4;  /* NEVER SET maxatr TO BE SMALLER THAN 4. */
-
-    /* Initialize the model. */
-    init_model();
-
-    /* Run the simulation while more calls are still needed. */
-    while (num_patients_simulated <= goal_patients_simulated) {
-
-        /* Determine the next event. */
-        timing();
-        /* Invoke the appropriate event function. */
-        switch (next_event_type) {
-            case EVENT_WALKIN_ARRIVAL:
-                /* Add patient to list of active patients */
-                list_file(FIRST, LIST_ACTIVE_PATIENTS);
-                
-                /* Validate number of patients in the ER */
-                if (list_size[LIST_ACTIVE_PATIENTS] > MAX_NUM_PATIENTS) 
-                {
-                    sprintf(error_msg, "PATIENT ERROR: Patients In ER Exceeded %d\n", MAX_NUM_PATIENTS);
-                    catch_exception(error_msg, 6);
-                }
-
-                /* Schedule next walk-in patient */
-                event_schedule(sim_time + expon(mean_walkin_interarrival, RANDOM_STREAMS[EVENT_WALKIN_ARRIVAL]),
-                               EVENT_WALKIN_ARRIVAL);
-                
-
-                /* Add nurse to list of active nurses */
-                list_file(FIRST, LIST_ACTIVE_NURSES);
-
-                /* Validate number of nurses in the ER */
-                if (list_size[LIST_ACTIVE_NURSES] > num_nurses)
-                {
-                    sprintf(error_msg, "NURSE ERROR: Number Of Active Nurses Exceeded %d\n", num_nurses);
-                    catch_exception(error_msg, 7);
-                }
-                
-                /* Schedule patient triage */
-                event_schedule(sim_time + fmaxf(normal(mean_triage_duration, RANDOM_STREAMS[EVENT_TRIAGE_PATIENT]), MIN_DURATION), 
-                               EVENT_TRIAGE_PATIENT);
-                break;
-            case EVENT_AMBULANCE_ARRIVAL:
-                /* Add patient to list of active patients */
-                list_file(FIRST, LIST_ACTIVE_PATIENTS);
-                
-                /* Validate number of patients in the ER */
-                if (list_size[LIST_ACTIVE_PATIENTS] > MAX_NUM_PATIENTS) 
-                {
-                    sprintf(error_msg, "PATIENT ERROR: Patients In ER Exceeded %d\n", MAX_NUM_PATIENTS);
-                    catch_exception(error_msg, 6);
-                }
-                
-                /* Schedule next ambulance patient */
-                event_schedule(sim_time + expon(mean_ambulance_interarrival, RANDOM_STREAMS[EVENT_AMBULANCE_ARRIVAL]),
-                               EVENT_AMBULANCE_ARRIVAL);
-
-
-                /* Add nurse to list of active nurses */
-                list_file(FIRST, LIST_ACTIVE_NURSES);
-
-                /* Validate number of nurses in the ER */
-                if (list_size[LIST_ACTIVE_NURSES] > num_nurses)
-                {
-                    sprintf(error_msg, "NURSE ERROR: Number Of Active Nurses Exceeded %d\n", num_nurses);
-                    catch_exception(error_msg, 7);
-                }
-                
-                /* Schedule patient triage */
-                event_schedule(sim_time + fmaxf(normal(mean_triage_duration, RANDOM_STREAMS[EVENT_TRIAGE_PATIENT]), MIN_DURATION), 
-                               EVENT_TRIAGE_PATIENT);
-                break;
-            case EVENT_TRIAGE_PATIENT:
-                /* Remove nurse from list of active nurses */
-                list_remove(FIRST, LIST_ACTIVE_NURSES);
-
-                /* Add doctor to list of active doctors */
-                list_file(FIRST, LIST_ACTIVE_DOCTORS);
-
-                /* Validate number of doctors in the ER */
-                if (list_size[LIST_ACTIVE_DOCTORS] > num_doctors) 
-                {
-                    sprintf(error_msg, "DOCTOR ERROR: Number of Active Doctors Exceeded %d\n", num_doctors);
-                    catch_exception(error_msg, 8);
-                }
-
-                /* Add exam room to list of active exam rooms */
-                list_file(FIRST, LIST_ACTIVE_EXAM_ROOMS);
-
-                /* Validate number of exam rooms in the ER */
-                if (list_size[LIST_ACTIVE_EXAM_ROOMS] > num_exam_rooms) 
-                {
-                    sprintf(error_msg, "EXAM ROOM ERROR: Number Of Active Exam Rooms Exceeded %d\n", num_exam_rooms);
-                    catch_exception(error_msg, 9);
-                }
-
-                /* Generate patient severity to determine if they will be seen immediately */
-                severity = normal(mean_severity, RANDOM_STREAMS[EVENT_TRIAGE_PATIENT]);
-                if (severity < THRESHOLD_SEVERITY)
-                {
-                    /* Schedule patient's initial assessment */
-                    event_schedule(sim_time + fmaxf(normal(mean_initial_assessment_duration, RANDOM_STREAMS[EVENT_INITIAL_ASSESMENT]), MIN_DURATION),
-                                EVENT_INITIAL_ASSESMENT);
-                    break;
-                }
-                /* Schedule patient's initial assessment immediately */
-                event_schedule(sim_time + MIN_DURATION,
-                               EVENT_INITIAL_ASSESMENT);
-                break;
-            case EVENT_INITIAL_ASSESMENT:
-                /* Remove exam room from list of active exam rooms */
-                list_remove(FIRST, LIST_ACTIVE_EXAM_ROOMS);
-
-                /* Add lab to list of active labs */
-                list_file(FIRST, LIST_ACTIVE_LABS);
-
-                /* Validate number of labs in the ER */
-                if (list_size[LIST_ACTIVE_LABS] > num_labs) 
-                {
-                    sprintf(error_msg, "LAB ERROR: Number Of Active Labs Exceeded %d\n", num_labs);
-                    catch_exception(error_msg, 10);
-                }
-
-                /* Schedule tests to be run */
-                event_schedule(sim_time + fmaxf(normal(mean_test_duration, RANDOM_STREAMS[EVENT_RUN_TESTS]), MIN_DURATION),
-                               EVENT_RUN_TESTS);
-                break;
-            case EVENT_RUN_TESTS:
-                /* Remove lab from list of active labs */
-                list_remove(FIRST, LIST_ACTIVE_LABS);
-
-                /* Add exam room to list of active exam rooms */
-                list_file(FIRST, LIST_ACTIVE_EXAM_ROOMS);
-
-                /* Validate number of exam rooms in the ER */
-                if (list_size[LIST_ACTIVE_EXAM_ROOMS] > num_exam_rooms) 
-                {
-                    sprintf(error_msg, "EXAM ROOM ERROR: Number Of Active Exam Rooms Exceeded %d\n", num_exam_rooms);
-                    catch_exception(error_msg, 9);
-                }
-                
-                /* Schedule tests to be run */
-                event_schedule(sim_time + fmaxf(normal(mean_follow_up_assessment_duration, RANDOM_STREAMS[EVENT_FOLLOW_UP_ASSESSMENT]), MIN_DURATION),
-                               EVENT_FOLLOW_UP_ASSESSMENT);
-                break;
-            case EVENT_FOLLOW_UP_ASSESSMENT:
-                /* Remove exam room from list of active exam rooms */
-                list_remove(FIRST, LIST_ACTIVE_EXAM_ROOMS);
-                
-                /* Remove doctor from list of active doctors */
-                list_remove(FIRST, LIST_ACTIVE_DOCTORS);
-                
-                /* Generate random variable for selecting patient outcome */
-                random_var = uniform(0, 1, RANDOM_STREAMS[EVENT_FOLLOW_UP_ASSESSMENT]);
-                if (random_var <= addmittance_chance)
-                {
-                    /* Add hospital room to list of active hospital rooms */
-                    list_file(FIRST, LIST_ACTIVE_HOSPITAL_ROOMS);
-
-                    /* Validate number of exam rooms in the ER */
-                    if (list_size[LIST_ACTIVE_HOSPITAL_ROOMS] > num_hospital_rooms) 
-                    {
-                        sprintf(error_msg, "HOSPITAL ROOM ERROR: Number Of Active Hospital Rooms Exceeded %d\n", num_exam_rooms);
-                        catch_exception(error_msg, 12);
-                    }
-
-                    /* Schedule patient addmittance to hospital */
-                    event_schedule(sim_time + fmaxf(normal(mean_hospital_duration, RANDOM_STREAMS[EVENT_PATIENT_DISCHARGE]), MIN_DURATION),
-                               EVENT_PATIENT_DISCHARGE);
-                    break;
-                }
-                if (random_var - addmittance_chance <= specialist_chance)
-                {
-                    /* Add doctor to list of active doctors */
-                    list_file(FIRST, LIST_ACTIVE_DOCTORS);
-
-                    /* Validate number of doctors in the ER */
-                    if (list_size[LIST_ACTIVE_DOCTORS] > num_doctors) 
-                    {
-                        sprintf(error_msg, "DOCTOR ERROR: Number of Active Doctors Exceeded %d\n", num_doctors);
-                        catch_exception(error_msg, 8);
-                    }
-
-                    /* Add exam room to list of active exam rooms */
-                    list_file(FIRST, LIST_ACTIVE_EXAM_ROOMS);
-
-                    /* Validate number of exam rooms in the ER */
-                    if (list_size[LIST_ACTIVE_EXAM_ROOMS] > num_exam_rooms) 
-                    {
-                        sprintf(error_msg, "EXAM ROOM ERROR: Number Of Active Exam Rooms Exceeded %d\n", num_exam_rooms);
-                        catch_exception(error_msg, 9);
-                    }
-
-                    /* Schedule patient's specialist initial assessment */
-                    event_schedule(sim_time + fmaxf(normal(mean_initial_assessment_duration, RANDOM_STREAMS[EVENT_INITIAL_ASSESMENT]), MIN_DURATION),
-                                EVENT_INITIAL_ASSESMENT);
-                    break;
-                }
-
-                /* Remove patient from list of active patients */
-                list_remove(FIRST, LIST_ACTIVE_PATIENTS);
-                
-                /* Increment number of patients simulated */
-                num_patients_simulated++;
-                break;
-            case EVENT_PATIENT_DISCHARGE:
-                /* Remove patient from list of active patients */
-                list_remove(FIRST, LIST_ACTIVE_PATIENTS);
-
-                /* Remove hospital room from list of hospital rooms */
-                list_remove(FIRST, LIST_ACTIVE_HOSPITAL_ROOMS);
-
-                /* Increment number of patients simulated */
-                num_patients_simulated++;
-                break;
-        }
-    }
-
-    /* Invoke the report generator and end the simulation. */
-    report();
-
-    /* Close file and verify that is is successful */
-    if (fclose(outfile) != 0) {
-        printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
-        exit(4);
-    }
-
-    return 0;
-}
-
-
-void init_model(void)  /* Initialization function. */
-{
-    /* Initialize non-simlib variables */
-    num_patients_simulated = 0;
-
-    /* Initialize random number streams */
-    seconds = time(NULL);
-    RANDOM_STREAMS[1] = 2 * seconds % 60;
-    RANDOM_STREAMS[2] = 3 * seconds % 60;
-    RANDOM_STREAMS[3] = 5 * seconds % 60;
-    RANDOM_STREAMS[4] = 7 * seconds % 60;
-    RANDOM_STREAMS[5] = 11 * seconds % 60;
-    RANDOM_STREAMS[6] = 13 * seconds % 60;
-    RANDOM_STREAMS[7] = 17 * seconds % 60;
-    
-    /* Schedule first walk-in and first ambulance patient */
-    event_schedule(sim_time + expon(mean_walkin_interarrival, RANDOM_STREAMS[EVENT_WALKIN_ARRIVAL]),
-                   EVENT_WALKIN_ARRIVAL);
-    event_schedule(sim_time + expon(mean_ambulance_interarrival, RANDOM_STREAMS[EVENT_AMBULANCE_ARRIVAL]),
-                   EVENT_AMBULANCE_ARRIVAL);
-}
-
-
-void report(void)  /* Report generator function. */
-{
-    /* Get and write out estimates of desired measures of performance. */
-    try_output(fprintf(outfile, "[PERFORMANCE METRICS]\n"));
-    try_output(fprintf(outfile, "\nAverage Number of Active Patients:%16.1f patients\n", 
-               filest(LIST_ACTIVE_PATIENTS)));
-    try_output(fprintf(outfile, "\nAverage Number of Active Doctors:%17.1f doctors\n", 
-               filest(LIST_ACTIVE_DOCTORS)));
-    try_output(fprintf(outfile, "\nAverage Number of Active Nurses:%18.1f nurses\n", 
-               filest(LIST_ACTIVE_NURSES)));
-    try_output(fprintf(outfile, "\nAverage Number of Active Exam Rooms:%14.1f rooms\n", 
-               filest(LIST_ACTIVE_EXAM_ROOMS)));
-    try_output(fprintf(outfile, "\nAverage Number of Active Labs:%20.1f labs\n", 
-               filest(LIST_ACTIVE_LABS)));
-    try_output(fprintf(outfile, "\nAverage Number of Active Hospital Rooms:%10.1f rooms\n", 
-               filest(LIST_ACTIVE_HOSPITAL_ROOMS)));
-}
-
-void try_input(float input, char* input_str) /* Validate input or exit */
-{
-    if (input == 0)
-    {
-        printf("INPUT ERROR: \"%s\" Is Not A Valid Input\n", input_str);
-        exit(2);
-    }
-}
-
-void try_output(int status) /* Validate output or exit */
-{
-    if (status < 0)
-    {
-        printf("FILE ERROR: Output File \"%s\" Cannot Be Written To\n", outfile_name);
-        if (fclose(outfile) != 0)
-        {
-            printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
-        }
-        exit(5);
-    }
-}
-
-void catch_exception(char* error_msg, int error_type) /* General exception printer */
-{
-    printf("%s", error_msg);
-    if (fclose(outfile) != 0)
-    {
-        printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
-    }
-    exit(error_type);
-}
-
+/* External definitions for emergency department using simlib. */
+
+#include "simlib.h"             /* Required for use of simlib.c. */
+#include "pathway.h"            /* Data-driven patient pathway. */
+#include "scenario.h"           /* Typed parameters and the scenario cache. */
+#include "network.h"            /* Sites of a multi-site model. */
+#include "sampler.h"            /* Occupancy time series. */
+#include "replication.h"        /* Replications and variance reduction. */
+#include "splitting.h"          /* Rare events by multilevel splitting. */
+#include "results.h"            /* Result cache of batch runs. */
+#include "screen.h"             /* Analytic pre-screen of scenarios. */
+#include "monitor.h"            /* Early termination of runs. */
+#include "sensitivity.h"        /* Derivatives by perturbation analysis. */
+#include "serve.h"              /* What-if queries from a warmed-up state. */
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#define MAX_NUM_PATIENTS            100  /* Maximum number of patients in the ER */
+#define FILENAME_LIMIT               50  /* Limit filename size */
+#define MIN_DURATION                0.1  /* Minimum duration of any process */
+#define THRESHOLD_SEVERITY            4  /* Sets the level of severity to be seen immediately */
+#define NUM_MODEL_PARAMS             18  /* Number of parameters a model file may reference */
+#define MAX_WORKERS                  64  /* Most worker processes in a batch */
+#define MAX_SITES                    64  /* Most sites in a network */
+
+/* Built-in model, used for any section a model file does not provide. */
+const char DEFAULT_MODEL[] =
+    "[resource patients]\n"
+    "capacity = $max_num_patients\n    title = Patients\n       unit = patients\n label = PATIENT\n   error_code = 6\n"
+    "[resource doctors]\n"
+    "capacity = $num_doctors\n         title = Doctors\n        unit = doctors\n  label = DOCTOR\n    error_code = 8\n"
+    "[resource nurses]\n"
+    "capacity = $num_nurses\n          title = Nurses\n         unit = nurses\n   label = NURSE\n     error_code = 7\n"
+    "[resource exam_rooms]\n"
+    "capacity = $num_exam_rooms\n      title = Exam Rooms\n     unit = rooms\n    label = EXAM ROOM\n error_code = 9\n"
+    "[resource labs]\n"
+    "capacity = $num_labs\n            title = Labs\n           unit = labs\n     label = LAB\n       error_code = 10\n"
+    "[resource hospital_rooms]\n"
+    "capacity = $num_hospital_rooms\n  title = Hospital Rooms\n unit = rooms\n label = HOSPITAL ROOM\n error_code = 12\n"
+    "[stage walkin]\n"
+    "type = arrival\n  rate = $mean_walkin_arrival\n     seize = patients\n  next = triage\n"
+    "[stage ambulance]\n"
+    "type = arrival\n  rate = $mean_ambulance_arrival\n  seize = patients\n  next = triage\n"
+    "[stage triage]\n"
+    "duration = normal $mean_triage_duration\n  seize = nurses\n  release = nurses\n"
+    "severity = $mean_severity\n  next = initial_assessment\n"
+    "[stage initial_assessment]\n"
+    "duration = normal $mean_initial_assessment_duration\n  seize = doctors exam_rooms\n  release = exam_rooms\n"
+    "fast_track = $threshold_severity\n  next = tests\n"
+    "[stage tests]\n"
+    "duration = normal $mean_test_duration\n  seize = labs\n  release = labs\n  next = follow_up\n"
+    "[stage follow_up]\n"
+    "duration = normal $mean_follow_up_assessment_duration\n  seize = exam_rooms\n  release = exam_rooms doctors\n  hold = exam_rooms\n"
+    "[route follow_up]\n"
+    "hospital = $addmittance_chance\n  initial_assessment = $specialist_chance\n  discharge = *\n"
+    "[stage hospital]\n"
+    "duration = normal $mean_hospital_duration\n  seize = hospital_rooms\n  release = hospital_rooms\n  next = discharge\n"
+    "[stage discharge]\n"
+    "type = exit\n  release = patients\n";
+
+/* Declare non-simlib global variables, one copy per site thread apart from
+   the model, which is only read once loaded. */
+SIMLIB_LOCAL int    num_doctors, num_exam_rooms, num_nurses, num_labs, num_hospital_rooms, goal_patients_simulated;
+SIMLIB_LOCAL float  mean_walkin_interarrival, mean_ambulance_interarrival, mean_triage_duration,
+                    mean_initial_assessment_duration, mean_follow_up_assessment_duration,
+                    mean_test_duration, mean_hospital_duration, mean_severity;
+SIMLIB_LOCAL float  addmittance_chance, specialist_chance;
+SIMLIB_LOCAL FILE*  outfile;
+SIMLIB_LOCAL char   outfile_name[FILENAME_LIMIT];
+SIMLIB_LOCAL char   error_msg[100];
+SIMLIB_LOCAL long   seed;
+SIMLIB_LOCAL int    replication;    /* Seed offset of the run:  its number, or its pair's. */
+struct config model;
+struct serve_result served;         /* Record of the replication a server worker runs... */
+int    served_fd = -1;              /* ...and the pipe it goes back through. */
+
+/* A scenario of a batch, in the order the batch runs them. */
+struct plan {
+    int    scenario;
+    int    skip;                    /* Unstable, reported without simulating. */
+    float  goal;                    /* Patients to simulate. */
+    double cost;                    /* Events expected, the costliest run first. */
+};
+
+/* Declare non-simlib functions. */
+void try_output(int);
+void read_scenario(char*, char*, struct scenario*);
+void load_model(void);
+void run_scenario(const struct scenario*);
+void open_report(const struct scenario*);
+void close_report(void);
+int  run_batch(char*, int);
+int  run_cached(const struct scenario*);
+void plan_batch(struct scenario_cache*, struct plan*);
+int  compare_plans(const void*, const void*);
+void skip_scenario(const struct scenario*);
+int  run_network(char*, char*, char*);
+void setup_site(struct site*);
+void finish_site(struct site*);
+int  run_server(char*, char*);
+void answer_query(const struct serve_query*, int[2], struct simlib_state*, struct pathway_state*);
+void run_query(const struct serve_query*, int, int, struct simlib_state*, struct pathway_state*);
+void report_answer(const struct serve_query*);
+void serve_error(char*, int);
+void init_pathway(const struct scenario*);
+void model_params(const float*, struct param*);
+void init_model(void);
+void init_series(void);
+void init_monitor(void);
+void init_sensitivity(void);
+void write_series(const struct scenario*);
+void record_replication(int);
+void report_replications(void);
+void run_splitting(void);
+void reseed_model(long);
+void report_splitting(void);
+void report_screen(int);
+void report_monitor(void);
+void report_sensitivity(void);
+void catch_exception(char*, int);
+void report(void);
+
+#ifndef ER_SIM_LIBRARY  /* Defined when the model is linked into a test driver. */
+int main(int argc, char** argv)  /* Main function. */
+{
+    struct scenario        scenario;
+
+    /* Compile a scenario file into a cache, or run every scenario of a cache. */
+    if (argc == 4 && strcmp(argv[1], "--compile") == 0)
+        return cache_compile(argv[2], argv[3]) == 0 ? 0 : 13;
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--batch") == 0)
+        return run_batch(argv[2], argc == 4 ? atoi(argv[3]) : 0);
+    if ((argc == 4 || (argc == 5 && (strcmp(argv[4], "--sequential") == 0 ||
+                                     strcmp(argv[4], "--optimistic") == 0))) &&
+        strcmp(argv[1], "--network") == 0)
+        return run_network(argv[2], argv[3], argc == 5 ? argv[4] : "");
+
+    if (argc == 4 && strcmp(argv[1], "--serve") == 0)
+        return run_server(argv[2], argv[3]);
+
+    scenario_defaults(&scenario);
+    if (argc == 3)
+    {
+        /* One named scenario of a scenario file, which may also hold the model. */
+        read_scenario(argv[1], argv[2], &scenario);
+    }
+    else if (argc == 18 || argc == 19)
+    {
+        /* Positional parameters, in the order of param_specs. */
+        for (int i = 0; i < NUM_PARAMS; i++)
+        {
+            if (scenario_set(&scenario, param_specs[i].name, argv[i + 1]) != 0)
+                exit(2);
+        }
+        if (strlen(argv[17]) >= SCENARIO_NAME_LIMIT)
+        {
+            printf("FILENAME ERROR: Filename Too Long\n");
+            exit(3);
+        }
+        strcpy(scenario.name, argv[17]);
+        if (argc == 19 && config_read(&model, argv[18]) != 0)
+            exit(13);
+        load_model();
+    }
+    else
+    {
+        printf("USAGE ERROR: Usage %s [scenario_file] [scenario_name]\n\
+       %s --compile [scenario_file] [cache_file]\n\
+       %s --batch [cache_file] [num_workers (optional)]\n\
+       %s --network [scenario_file] [network_name] [--sequential | --optimistic (optional)]\n\
+       %s --serve [scenario_file] [scenario_name]\n\
+       %s [mean_walkin_arrival] [mean_ambulance_arrival] [mean_triage_duration]\n\
+[mean_initial_assessment_duration] [mean_test_duration] [mean_follow_up_assessment_duration] [mean_hospital_duration]\n\
+[mean_severity] [num_doctors] [num_nurses] [num_exam_rooms] [num_labs] [num_hospital_rooms] [addmittance_chance]\n\
+[specialist_chance] [goal_patients_simulated] [output_file_name] [model_file (optional)]\n",
+               argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+        exit(1);
+    }
+
+    run_scenario(&scenario);
+    config_free(&model);
+    return 0;
+}
+#endif
+
+
+void read_scenario(char* scenario_file, char* name, struct scenario* scenario)  /* Load a named scenario and its model. */
+{
+    struct config_section *section;
+
+    if (config_read(&model, scenario_file) != 0)
+        exit(13);
+    if ((section = config_find(&model, "scenario", name)) == NULL)
+    {
+        printf("CONFIG ERROR: %s: No [scenario %s] Section\n", scenario_file, name);
+        exit(13);
+    }
+    if (strlen(name) >= SCENARIO_NAME_LIMIT)
+    {
+        printf("FILENAME ERROR: Filename Too Long\n");
+        exit(3);
+    }
+    strcpy(scenario->name, name);
+    if ((config_find(&model, "defaults", NULL) != NULL &&
+         scenario_load(scenario, &model, config_find(&model, "defaults", NULL)) != 0) ||
+        scenario_load(scenario, &model, section) != 0)
+        exit(2);
+    load_model();
+}
+
+
+void load_model(void)  /* Model loading function. */
+{
+    struct config defaults;
+
+    /* Fall back on the built-in model section by section, unless the loaded
+       config has stages of its own, which replace the built-in pathway entirely. */
+    config_parse(&defaults, DEFAULT_MODEL, "built-in model");
+    if (model.num_sections == 0)
+    {
+        model = defaults;
+        return;
+    }
+    if (config_find(&model, "stage", NULL) == NULL)
+        config_merge(&model, &defaults);
+    config_free(&defaults);
+}
+
+
+void run_scenario(const struct scenario* scenario)  /* Run one scenario to completion. */
+{
+    /* Compile and validate the patient pathway, including its routing probabilities */
+    init_pathway(scenario);
+
+    /* Open the output file and write the report heading */
+    open_report(scenario);
+
+    /* Set maxatr = max(maximum number of attributes per record, 4) */
+    maxatr = 4;  /* NEVER SET maxatr TO BE SMALLER THAN 4. */
+
+    /* Size the lists and statistics for the pathway */
+    pathway_size();
+
+    /* A rare event is estimated by splitting, in place of the usual runs */
+    if (splitting.runs > 0) {
+        run_splitting();
+        close_report();
+        return;
+    }
+
+    /* Each replication starts simlib and the model afresh;  the second run
+       of an antithetic pair repeats the first's seeds, complemented. */
+    replications_start(pathway.num_resources);
+    for (int run = 0; run < replications.runs; run++) {
+        init_simlib();
+        lcgrand_antithetic = replications.antithetic && run % 2 == 1;
+        replication = replications.antithetic ? run / 2 : run;
+
+        /* Initialize the model, with the derivatives ready for its first arrivals. */
+        init_sensitivity();
+        init_model();
+        init_series();
+        init_monitor();
+
+        /* Run the simulation while more calls are still needed, or until a
+           traced run has no arrivals left and every patient has left, or
+           the monitors find it unstable or converged. */
+        while (pathway.num_completed <= goal_patients_simulated && list_size[LIST_EVENT] > 0) {
+
+            /* Sample the levels up to the next event, then determine it. */
+            sampler_advance();
+            timing();
+            sensitivity_advance();
+
+            /* Invoke the stage handler for the event type. */
+            pathway_dispatch();
+            if (monitor_advance() != MONITOR_COMPLETED)
+                break;
+        }
+        record_replication(run);
+    }
+    lcgrand_antithetic = 0;
+
+    /* Invoke the report generator, of the last run and the estimates over
+       all of them, and end the simulation. */
+    report();
+    report_monitor();
+    report_sensitivity();
+    report_replications();
+    report_screen(1);
+    close_report();
+    write_series(scenario);
+}
+
+
+void open_report(const struct scenario* scenario)  /* Open the output file and write the heading. */
+{
+    const struct param_spec *spec;
+
+    strcpy(outfile_name, "out/");
+    strcat(outfile_name, scenario->name);
+    strcat(outfile_name, ".out");
+
+    /* Open Output file. */
+    outfile = fopen(outfile_name, "w");
+
+    /* Verify the output file has been sucessfully opened. */
+    if (outfile == NULL) {
+        printf("FILE ERROR: Output File \"%s\" Cannot Be Opened\n", outfile_name);
+        exit(4);
+    }
+
+    /* Write report heading and input parameters. */
+    try_output(fprintf(outfile, "            Emergency Room Simulation using Simlib\n"));
+    try_output(fprintf(outfile, "--------------------------------------------------------------\n\n"));
+    try_output(fprintf(outfile, "[CONSTANTS]\n\n"));
+    try_output(fprintf(outfile, "Maximum capacity of patients:%21d patients\n\n", MAX_NUM_PATIENTS));
+    try_output(fprintf(outfile, "Maximum length of filename:%23d characters\n\n", FILENAME_LIMIT));
+    try_output(fprintf(outfile, "Minimum duration of any process:%18.3f minutes\n\n", MIN_DURATION));
+    try_output(fprintf(outfile, "Severity threshold for immediate action:%10d\n\n\n", THRESHOLD_SEVERITY));
+    try_output(fprintf(outfile, "[INPUT PARAMETERS]\n\n"));
+    for (int i = 0; i < NUM_PARAMS; i++)
+    {
+        spec = &param_specs[i];
+        if (spec->type == PARAM_INT)
+            try_output(fprintf(outfile, "%s:%*d", spec->label, 49 - (int)strlen(spec->label), (int)scenario->value[i]));
+        else
+            try_output(fprintf(outfile, "%s:%*.3f", spec->label, 49 - (int)strlen(spec->label), scenario->value[i]));
+        try_output(fprintf(outfile, "%s%s\n\n", *spec->unit ? " " : "", spec->unit));
+    }
+    try_output(fprintf(outfile, "Random number seed:%31ld\n\n\n", seed));
+}
+
+
+void close_report(void)  /* Close the output file. */
+{
+    /* Close file and verify that is is successful */
+    if (fclose(outfile) != 0) {
+        printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
+        exit(4);
+    }
+}
+
+
+int run_batch(char* cache_file, int num_workers)  /* Batch runner over a scenario cache. */
+{
+    struct scenario_cache cache;
+    struct batch {
+        atomic_int next;                    /* Next unclaimed scenario. */
+        atomic_int cached;                  /* Scenarios taken from the result cache. */
+        int        current[MAX_WORKERS];    /* Scenario each worker is running. */
+        int        status[];                /* Exit status by scenario, -1 until run. */
+    } *batch;
+    struct plan    *plans;
+    struct scenario scenario;
+    pid_t  workers[MAX_WORKERS], pid;
+    int    num_scenarios, num_failed, live, code, w, i, k;
+
+    /* Map the cache and parse its model once;  workers inherit both. */
+    if (cache_open(&cache, cache_file) != 0)
+        return 13;
+    num_scenarios = cache.header->num_scenarios;
+    if (config_parse(&model, cache.model, cache_file) != 0)
+        return 13;
+    load_model();
+
+    plans = (struct plan*) malloc(num_scenarios * sizeof(struct plan));
+    plan_batch(&cache, plans);
+
+    if (num_workers < 1) num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers > MAX_WORKERS) num_workers = MAX_WORKERS;
+    if (num_workers > num_scenarios) num_workers = num_scenarios;
+
+    /* Scenarios are claimed from a counter in memory shared with the workers.
+       A worker stopped by catch_exception leaves its status with the supervisor,
+       which records it against the claimed scenario and starts a replacement. */
+    batch = mmap(NULL, sizeof(struct batch) + num_scenarios * sizeof(int),
+                 PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (batch == MAP_FAILED)
+    {
+        printf("BATCH ERROR: Shared Memory Cannot Be Mapped\n");
+        return 15;
+    }
+    atomic_init(&batch->next, 0);
+    atomic_init(&batch->cached, 0);
+    for (i = 0; i < num_scenarios; i++)
+        batch->status[i] = -1;
+
+    fflush(stdout);
+    live = 0;
+    for (w = 0; w < num_workers; w++)
+        workers[w] = 0;
+    for (w = 0; ; )
+    {
+        /* Keep every worker slot busy while scenarios remain. */
+        for (; w < num_workers && atomic_load(&batch->next) < num_scenarios; w++)
+        {
+            if (workers[w] != 0) continue;
+            batch->current[w] = -1;
+            if ((pid = fork()) == 0)
+            {
+                while ((k = atomic_fetch_add(&batch->next, 1)) < num_scenarios)
+                {
+                    batch->current[w] = i = plans[k].scenario;
+                    scenario = cache.scenarios[i];
+                    scenario.value[P_GOAL_PATIENTS_SIMULATED] = plans[k].goal;
+                    if (plans[k].skip)
+                        skip_scenario(&scenario);
+                    else if (run_cached(&scenario))
+                        atomic_fetch_add(&batch->cached, 1);
+                    batch->status[i] = 0;
+                    fflush(stdout);
+                }
+                _exit(0);
+            }
+            if (pid < 0)
+            {
+                printf("BATCH ERROR: Worker Cannot Be Started\n");
+                break;
+            }
+            workers[w] = pid;
+            live++;
+        }
+        if (live == 0) break;
+
+        /* Wait for a worker, and charge a failure to the scenario it held. */
+        pid = wait(&code);
+        for (w = 0; w < num_workers && workers[w] != pid; w++)
+            ;
+        if (w == num_workers) continue;
+        workers[w] = 0;
+        live--;
+        i = batch->current[w];
+        if (i >= 0 && batch->status[i] < 0)
+            batch->status[i] = WIFEXITED(code) ? WEXITSTATUS(code) : 128 + WTERMSIG(code);
+        w = 0;
+    }
+
+    if (atomic_load(&batch->cached) > 0)
+        printf("Batch: %d Of %d Scenarios Taken From The Result Cache \"%s\"\n",
+               atomic_load(&batch->cached), num_scenarios, RESULTS_DIR);
+    num_failed = code = 0;
+    for (i = 0; i < num_scenarios; i++)
+    {
+        if (batch->status[i] == 0) continue;
+        printf("BATCH ERROR: Scenario \"%s\" Failed With Status %d\n", cache.scenarios[i].name, batch->status[i]);
+        if (num_failed++ == 0) code = batch->status[i] > 0 ? batch->status[i] : 15;
+    }
+    munmap(batch, sizeof(struct batch) + num_scenarios * sizeof(int));
+    free(plans);
+    config_free(&model);
+    cache_close(&cache);
+    return code;
+}
+
+
+void plan_batch(struct scenario_cache* cache, struct plan* plans)  /* Screen a batch, if the model asks to, and order it. */
+{
+    const struct scenario *scenario;
+    struct resource       *resource;
+    int    num_scenarios = cache->header->num_scenarios;
+
+    for (int i = 0; i < num_scenarios; i++)
+    {
+        scenario = &cache->scenarios[i];
+        plans[i].scenario = i;
+        plans[i].skip = 0;
+        plans[i].goal = plans[i].cost = scenario->value[P_GOAL_PATIENTS_SIMULATED];
+        if (config_find(&model, "screen", NULL) == NULL)
+            continue;
+
+        /* Approximate the scenario's pathway, in microseconds. */
+        init_pathway(scenario);
+        if (!screen.screened)
+            continue;
+        plans[i].goal = screen_patients(plans[i].goal);
+        plans[i].cost = plans[i].goal * screen.events;
+        if (!screen.stable)
+        {
+            resource = &pathway.resources[screen.bottleneck];
+            plans[i].skip = screen.skip_unstable;
+            if (plans[i].skip)
+                plans[i].cost = 0;
+            printf("Batch: Scenario \"%s\" Is Unstable, %s Are Busy Beyond Capacity%s\n", scenario->name,
+                   resource->title, plans[i].skip ? ", Not Simulated" : "");
+        }
+    }
+
+    /* Workers claim the costliest scenarios first, so none is left running alone at the end. */
+    if (config_find(&model, "screen", NULL) != NULL)
+        qsort(plans, num_scenarios, sizeof(struct plan), compare_plans);
+}
+
+
+int compare_plans(const void* a, const void* b)  /* Costliest first, then in file order. */
+{
+    const struct plan *x = (const struct plan*) a, *y = (const struct plan*) b;
+
+    if (x->cost != y->cost)
+        return x->cost > y->cost ? -1 : 1;
+    return x->scenario - y->scenario;
+}
+
+
+void skip_scenario(const struct scenario* scenario)  /* Report an unstable scenario without simulating it. */
+{
+    init_pathway(scenario);
+    open_report(scenario);
+    report_screen(0);
+    close_report();
+}
+
+
+int run_cached(const struct scenario* scenario)  /* Take a seeded scenario's report from the result cache, or run it. */
+{
+    unsigned long long key;
+
+    /* Scenarios seeded from the clock differ from run to run. */
+    if (scenario->seed == 0) {
+        run_scenario(scenario);
+        return 0;
+    }
+    key = results_key(&model, scenario);
+    if (results_fetch(RESULTS_DIR, key, scenario->name) == 0)
+        return 1;
+    run_scenario(scenario);
+    results_store(RESULTS_DIR, key, scenario->name, sampler.interval > 0 && splitting.runs == 0);
+    return 0;
+}
+
+
+int run_network(char* config_file, char* name, char* mode)  /* Run the sites of a [network] section. */
+{
+    struct config_section *section, *defaults, *site_section;
+    struct scenario        scenarios[MAX_SITES];
+    struct site            sites[MAX_SITES];
+    struct network         network;
+    char   names[CONFIG_LINE_LIMIT], *site, *next;
+    float  value;
+    int    i, n, status;
+
+    if (config_read(&model, config_file) != 0)
+        return 13;
+    if ((section = config_find(&model, "network", name)) == NULL)
+    {
+        printf("CONFIG ERROR: %s: No [network %s] Section\n", config_file, name);
+        return 13;
+    }
+
+    /* Each site is a scenario of the same file, over the same model. */
+    memset(&network, 0, sizeof(network));
+    memset(sites, 0, sizeof(sites));
+    defaults = config_find(&model, "defaults", NULL);
+    strcpy(names, config_value(&model, section, "sites") != NULL ? config_value(&model, section, "sites") : "");
+    for (n = 0, site = strtok_r(names, " \t", &next); site != NULL; site = strtok_r(NULL, " \t", &next))
+    {
+        if (n == MAX_SITES || (site_section = config_find(&model, "scenario", site)) == NULL)
+        {
+            printf("CONFIG ERROR: %s:%d: [network %s] Needs At Most %d Sites, Each A [scenario]\n",
+                   config_file, section->line, name, MAX_SITES);
+            return 13;
+        }
+        for (i = 0; i < n && strcmp(scenarios[i].name, site) != 0; i++)
+            ;
+        if (i < n || strlen(site) >= SCENARIO_NAME_LIMIT)
+        {
+            printf("CONFIG ERROR: %s:%d: [network %s] Site \"%s\" Listed Twice Or Too Long\n",
+                   config_file, section->line, name, site);
+            return 13;
+        }
+        scenario_defaults(&scenarios[n]);
+        strcpy(scenarios[n].name, site);
+        if ((defaults != NULL && scenario_load(&scenarios[n], &model, defaults) != 0) ||
+            scenario_load(&scenarios[n], &model, site_section) != 0)
+            return 2;
+        sites[n].data = &scenarios[n];
+        n++;
+    }
+    if (n == 0)
+    {
+        printf("CONFIG ERROR: %s:%d: [network %s] Needs \"sites\"\n", config_file, section->line, name);
+        return 13;
+    }
+
+    /* Messages take delay minutes, the run lasts length minutes. */
+    network.num_sites  = n;
+    network.sites      = sites;
+    network.sequential = strcmp(mode, "--sequential") == 0;
+    network.optimistic = strcmp(mode, "--optimistic") == 0;
+    network.setup      = setup_site;
+    network.finish     = finish_site;
+    for (i = 0; i < 2; i++)
+    {
+        if (config_value(&model, section, i == 0 ? "delay" : "length") == NULL ||
+            sscanf(config_value(&model, section, i == 0 ? "delay" : "length"), "%f", &value) != 1 ||
+            value <= 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [network %s] Needs A Positive \"%s\"\n",
+                   config_file, section->line, name, i == 0 ? "delay" : "length");
+            return 13;
+        }
+        if (i == 0) network.delay = value;
+        else        network.end_time = value;
+    }
+
+    load_model();
+    status = network_run(&network);
+    config_free(&model);
+    return status == 0 ? 0 : 15;
+}
+
+
+void setup_site(struct site* site)  /* Start one site of a network, on its own thread. */
+{
+    init_pathway((const struct scenario*) site->data);
+    open_report((const struct scenario*) site->data);
+    maxatr = 4;
+    pathway_size();
+    init_simlib();
+    init_model();
+}
+
+
+void finish_site(struct site* site)  /* Report one site of a network, on its own thread. */
+{
+    report();
+    try_output(fprintf(outfile, "\n[NETWORK]\n"));
+    try_output(fprintf(outfile, "\nPatients Transferred Out:%25d patients\n", pathway.num_transferred));
+    try_output(fprintf(outfile, "\nPatients Transferred In:%26d patients\n", pathway.num_received));
+    try_output(fprintf(outfile, "\nEvents Committed:%33ld\n", site->events));
+    try_output(fprintf(outfile, "\n[SYNCHRONIZATION]\n"));
+    if (site->network->optimistic)
+    {
+        try_output(fprintf(outfile, "\nRollbacks:%40ld\n", site->rollbacks));
+        try_output(fprintf(outfile, "\nEvents Rolled Back:%31ld\n", site->rolled_back));
+        try_output(fprintf(outfile, "\nAnti-Messages Sent:%31ld\n", site->antimessages));
+        try_output(fprintf(outfile, "\nGVT Rounds:%39ld\n", site->rounds));
+    }
+    else
+        try_output(fprintf(outfile, "\nSynchronization Windows:%26ld\n", site->windows));
+    try_output(fprintf(outfile, "\nMessages Sent:%36ld\n", site->sent));
+    try_output(fprintf(outfile, "\nMessages Received:%32ld\n", site->received));
+    close_report();
+}
+
+
+int run_server(char* scenario_file, char* name)  /* Answer what-if queries on stdin from a warmed-up scenario. */
+{
+    struct scenario       scenario;
+    struct serve_query    query;
+    struct param          params[NUM_MODEL_PARAMS];
+    struct simlib_state  *simlib_states;
+    struct pathway_state *pathway_states;
+    struct config_section *section;
+    char   line[CONFIG_LINE_LIMIT], error[CONFIG_LINE_LIMIT + 64], level[CONFIG_LINE_LIMIT];
+    int    fds[2], number, status = 0;
+
+    scenario_defaults(&scenario);
+    read_scenario(scenario_file, name, &scenario);
+    init_pathway(&scenario);
+    model_params(scenario.value, params);
+    section = config_find(&model, "serve", NULL);
+    if (serve_load(&model, section) != 0)
+        exit(13);
+
+    /* Warm up once, copying the state after the warm-up and every spacing
+       patients after that;  the server itself never runs on from there. */
+    pathway.on_error = serve_error;
+    maxatr = 4;
+    pathway_size();
+    init_simlib();
+    replication = 0;
+    init_model();
+
+    /* Every occupancy, then every service stage's queue, once simlib and the
+       pathway have registered them. */
+    for (int i = 1; i <= pathway.num_resources && status == 0; i++)
+        status = serve_level((timest_var){maxtvar + pathway.resources[i].list}, pathway.resources[i].name, 1);
+    for (int i = 1; i <= pathway.num_stages && status == 0; i++)
+    {
+        if (pathway.stages[i].kind != STAGE_SERVICE)
+            continue;
+        snprintf(level, CONFIG_LINE_LIMIT, "%s_queue", pathway.stages[i].name);
+        status = serve_level(pathway.stages[i].queue.tvar, level, 0);
+    }
+    if (status != 0)
+    {
+        printf("CONFIG ERROR: %s: The Server Reports At Most %d Resources And Service Stages\n",
+               model.origin, SERVE_MAX_LEVELS);
+        exit(13);
+    }
+    simlib_states  = (struct simlib_state*) calloc(serve.snapshots, sizeof(struct simlib_state));
+    pathway_states = (struct pathway_state*) calloc(serve.snapshots, sizeof(struct pathway_state));
+    for (int s = 0; s < serve.snapshots; s++)
+    {
+        while (pathway.num_completed < serve.warmup + s * serve.spacing && list_size[LIST_EVENT] > 0) {
+            timing();
+            pathway_dispatch();
+        }
+        simlib_save(&simlib_states[s]);
+        pathway_save(&pathway_states[s]);
+    }
+    if (pipe(fds) != 0 || fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0)
+    {
+        printf("SERVE ERROR: Pipe Cannot Be Created\n");
+        exit(15);
+    }
+    printf("ready snapshots=%d minutes=%.1f patients=%d\n", serve.snapshots, sim_time, pathway.num_completed);
+    fflush(stdout);
+
+    /* One query per line, answered in turn, until quit or the end of input. */
+    for (number = 1; fgets(line, CONFIG_LINE_LIMIT, stdin) != NULL; )
+    {
+        if (strncmp(line, "quit", 4) == 0 && strspn(line + 4, " \t\r\n") == strlen(line + 4))
+            break;
+        if (line[0] == '#')
+            continue;
+        query.number = number++;
+        if (serve_parse(line, params, NUM_MODEL_PARAMS, &query, error, sizeof(error)) != 0)
+            printf("error %d %s\n", query.number, error);
+        else
+            answer_query(&query, fds, simlib_states, pathway_states);
+        fflush(stdout);
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+    for (int s = 0; s < serve.snapshots; s++)
+    {
+        simlib_state_free(&simlib_states[s]);
+        pathway_state_free(&pathway_states[s]);
+    }
+    free(simlib_states);
+    free(pathway_states);
+    config_free(&model);
+    return 0;
+}
+
+
+void answer_query(const struct serve_query* query, int fds[2], struct simlib_state* simlib_states,
+                  struct pathway_state* pathway_states)  /* Fork the replications of a query, streaming the estimates. */
+{
+    static const char *outcome[] = {"completed", "converged", "failed"};
+    struct serve_result result;
+    struct timespec     start, end;
+    pid_t  workers[MAX_WORKERS], pid;
+    int    runs[MAX_WORKERS], written[MAX_WORKERS];
+    int    num_workers, started, live, converged, code, w;
+
+    num_workers = serve.workers > 0 ? serve.workers : sysconf(_SC_NPROCESSORS_ONLN);
+    if (num_workers > MAX_WORKERS) num_workers = MAX_WORKERS;
+    if (num_workers > query->replications) num_workers = query->replications;
+    for (w = 0; w < num_workers; w++)
+        workers[w] = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    serve_begin();
+    started = live = converged = 0;
+    for (;;)
+    {
+        /* Keep every worker busy with the next replication while any remain. */
+        for (w = 0; w < num_workers && started < query->replications && !converged; w++)
+        {
+            if (workers[w] != 0) continue;
+            if ((pid = fork()) == 0)
+            {
+                close(fds[0]);
+                run_query(query, started, fds[1], simlib_states, pathway_states);
+                _exit(0);
+            }
+            if (pid < 0)
+            {
+                printf("error %d Replication Cannot Be Started\n", query->number);
+                break;
+            }
+            workers[w] = pid;
+            runs[w] = started++;
+            written[w] = 0;
+            live++;
+        }
+        if (live == 0) break;
+
+        /* Wait for a worker, and take up every record written so far;  a
+           worker that ended without one failed outright. */
+        pid = wait(&code);
+        while (read(fds[0], &result, sizeof(result)) == sizeof(result))
+        {
+            for (w = 0; w < num_workers && !(workers[w] != 0 && runs[w] == result.replication); w++)
+                ;
+            if (w < num_workers) written[w] = 1;
+            if (converged || result.query != query->number)
+                continue;
+            if (result.status != 0)
+            {
+                result.message[strcspn(result.message, "\n")] = '\0';
+                printf("error %d Replication %d Failed With Status %d: %s\n", query->number,
+                       result.replication + 1, result.status, result.message);
+                continue;
+            }
+            serve_record(&result);
+            report_answer(query);
+            converged = serve_converged();
+        }
+        for (w = 0; w < num_workers && workers[w] != pid; w++)
+            ;
+        if (w == num_workers) continue;
+        if (!written[w] && !converged)
+            printf("error %d Replication %d Failed With Status %d\n", query->number, runs[w] + 1,
+                   WIFEXITED(code) ? WEXITSTATUS(code) : 128 + WTERMSIG(code));
+        workers[w] = 0;
+        live--;
+        fflush(stdout);
+
+        /* A converged query needs none of the replications still running. */
+        for (w = 0; converged && w < num_workers; w++)
+        {
+            if (workers[w] != 0)
+                kill(workers[w], SIGKILL);
+        }
+    }
+    while (read(fds[0], &result, sizeof(result)) == sizeof(result))
+        ;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("done %d %s replications=%d seconds=%.2f\n", query->number,
+           outcome[serve.count == 0 ? 2 : converged], serve.count,
+           (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+}
+
+
+void run_query(const struct serve_query* query, int run, int fd, struct simlib_state* simlib_states,
+               struct pathway_state* pathway_states)  /* One replication of a query, in a forked worker. */
+{
+    double area[SERVE_MAX_LEVELS], now[SERVE_MAX_LEVELS];
+    float  since;
+    int    goal;
+
+    /* From the copies in turn, changed as the query asks, on streams of its own. */
+    memset(&served, 0, sizeof(served));
+    served.query       = query->number;
+    served.replication = run;
+    served_fd          = fd;
+    simlib_restore(&simlib_states[run % serve.snapshots]);
+    pathway_restore(&pathway_states[run % serve.snapshots]);
+    for (int k = 0; k < query->num_changes; k++)
+        pathway_adjust(query->params[k], query->values[k]);
+    for (int i = 1; i <= pathway.num_stages; i++)
+        lcgrandst(stream_seed(seed + 1 + run, i), i);
+
+    /* Average every level over the patients this replication runs. */
+    since = sim_time;
+    serve_areas(area);
+    goal = pathway.num_completed + query->patients;
+    while (pathway.num_completed < goal && list_size[LIST_EVENT] > 0) {
+        timing();
+        pathway_dispatch();
+    }
+    serve_areas(now);
+    for (int v = 0; v < serve.num_levels; v++)
+        served.averages[v] = sim_time > since ? (now[v] - area[v]) / (sim_time - since) :
+                                                timest_acc[serve.levels[v].id].preval;
+    if (write(fd, &served, sizeof(served)) != sizeof(served))
+        _exit(15);
+}
+
+
+void report_answer(const struct serve_query* query)  /* The estimates so far, one line. */
+{
+    printf("answer %d %d/%d", query->number, serve.count, query->replications);
+    for (int v = 0; v < serve.num_levels; v++)
+    {
+        if (serve.count < 2)
+            printf(" %s=%.2f", serve.names[v], serve.mean[v]);
+        else
+            printf(" %s=%.2f+/-%.2f", serve.names[v], serve.mean[v], serve_half_width(v));
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+
+void serve_error(char* error_msg, int error_type)  /* Errors of the server's runs, sent back by workers. */
+{
+    if (served_fd < 0)
+    {
+        printf("%s", error_msg);
+        exit(error_type);
+    }
+    served.status = error_type;
+    snprintf(served.message, SERVE_MESSAGE_LIMIT, "%s", error_msg);
+    if (write(served_fd, &served, sizeof(served)) != sizeof(served))
+        _exit(15);
+    _exit(error_type);
+}
+
+
+void init_pathway(const struct scenario* scenario)  /* Pathway initialization function. */
+{
+    const float *value = scenario->value;
+    struct param params[NUM_MODEL_PARAMS];
+    struct config_section *section;
+    struct resource *resource;
+    struct stage *stage;
+
+    /* Copy the scenario into the model globals */
+    mean_walkin_interarrival = 1.0 / value[P_MEAN_WALKIN_ARRIVAL];
+    mean_ambulance_interarrival = 1.0 / value[P_MEAN_AMBULANCE_ARRIVAL];
+    mean_triage_duration = value[P_MEAN_TRIAGE_DURATION];
+    mean_initial_assessment_duration = value[P_MEAN_INITIAL_ASSESSMENT_DURATION];
+    mean_test_duration = value[P_MEAN_TEST_DURATION];
+    mean_follow_up_assessment_duration = value[P_MEAN_FOLLOW_UP_ASSESSMENT_DURATION];
+    mean_hospital_duration = value[P_MEAN_HOSPITAL_DURATION];
+    mean_severity = value[P_MEAN_SEVERITY];
+    num_doctors = value[P_NUM_DOCTORS];
+    num_nurses = value[P_NUM_NURSES];
+    num_exam_rooms = value[P_NUM_EXAM_ROOMS];
+    num_labs = value[P_NUM_LABS];
+    num_hospital_rooms = value[P_NUM_HOSPITAL_ROOMS];
+    addmittance_chance = value[P_ADDMITTANCE_CHANCE];
+    specialist_chance = value[P_SPECIALIST_CHANCE];
+    goal_patients_simulated = value[P_GOAL_PATIENTS_SIMULATED];
+    seed = scenario->seed != 0 ? scenario->seed : (long)(time(NULL) % 2147483646L) + 1;
+
+    /* Compile the pathway into its dispatch tables */
+    model_params(value, params);
+    pathway.min_duration = MIN_DURATION;
+    pathway.on_error = catch_exception;
+    if (pathway_compile(&model, params, NUM_MODEL_PARAMS) != 0 ||
+        sampler_load(&model, config_find(&model, "sample", NULL)) != 0)
+        exit(13);
+
+    /* Replications, whose controls are the durations sampled by stages */
+    section = config_find(&model, "replications", NULL);
+    if (replications_load(&model, section) != 0)
+        exit(13);
+    for (int k = 0; k < replications.num_controls; k++)
+    {
+        stage = pathway_stage(replications.control_names[k]);
+        if (stage == NULL || stage->kind == STAGE_EXIT || stage->trace.path != NULL ||
+            stage->duration.dist == DIST_CONSTANT)
+        {
+            printf("CONFIG ERROR: %s:%d: [replications] \"%s\" Is Not A Stage With Random Durations\n",
+                   model.origin, section->line, replications.control_names[k]);
+            exit(13);
+        }
+        stage->observed = 1;
+    }
+
+    /* Splitting, on the occupancy of a resource up to at most its capacity */
+    section = config_find(&model, "splitting", NULL);
+    if (splitting_load(&model, section) != 0)
+        exit(13);
+    if (splitting.runs > 0)
+    {
+        resource = pathway_resource(splitting.resource);
+        if (resource == NULL || splitting.levels[splitting.num_levels - 1] > resource->capacity)
+        {
+            printf("CONFIG ERROR: %s:%d: [splitting] \"%s\" Is Not A Resource With Capacity For Every Level\n",
+                   model.origin, section->line, splitting.resource);
+            exit(13);
+        }
+        if (replications.runs > 1)
+        {
+            printf("CONFIG ERROR: %s:%d: [splitting] Cannot Be Combined With [replications]\n",
+                   model.origin, section->line);
+            exit(13);
+        }
+        splitting.list = resource->list;
+    }
+
+    /* Monitors of each run, when a [monitor] section asks for them */
+    if (monitor_load(&model, config_find(&model, "monitor", NULL)) != 0)
+        exit(13);
+
+    /* Derivatives by the durations' means and arrival rates, when a
+       [sensitivity] section asks for them */
+    if (sensitivity_load(&model, config_find(&model, "sensitivity", NULL), params, NUM_MODEL_PARAMS) != 0)
+        exit(13);
+
+    /* The analytic approximation, when a [screen] section asks for it */
+    if (screen_load(&model, config_find(&model, "screen", NULL)) != 0)
+        exit(13);
+    if (screen.enabled)
+        screen_approximate();
+}
+
+
+void model_params(const float* value, struct param* params)  /* Parameters the model may reference. */
+{
+    /* Every scenario parameter may be referenced from the model as $name */
+    for (int i = 0; i < NUM_PARAMS; i++)
+    {
+        strcpy(params[i].name, param_specs[i].name);
+        params[i].value = value[i];
+    }
+    strcpy(params[NUM_PARAMS].name, "max_num_patients");
+    params[NUM_PARAMS].value = MAX_NUM_PATIENTS;
+    strcpy(params[NUM_PARAMS + 1].name, "threshold_severity");
+    params[NUM_PARAMS + 1].value = THRESHOLD_SEVERITY;
+}
+
+
+void init_model(void)  /* Initialization function. */
+{
+    /* Initialize random number streams, one per stage, from the run seed */
+    for (int i = 1; i <= pathway.num_stages; i++)
+    {
+        pathway.stages[i].stream = i;
+        lcgrandst(stream_seed(seed + replication, i), i);
+    }
+
+    /* Schedule the first patient from each arrival stage */
+    pathway_start();
+}
+
+
+void init_series(void)  /* Sample every resource and stage queue, if the model asks to. */
+{
+    char name[CONFIG_LINE_LIMIT];
+
+    if (sampler.interval <= 0)
+        return;
+    if (sampler.num_columns == 0)
+    {
+        /* Once per scenario:  the variables stay the same across its runs. */
+        for (int i = 1; i <= pathway.num_resources; i++)
+            sampler_column(pathway.resources[i].name, (timest_var){maxtvar + pathway.resources[i].list});
+        for (int i = 1; i <= pathway.num_stages; i++)
+        {
+            if (pathway.stages[i].kind != STAGE_SERVICE)
+                continue;
+            snprintf(name, CONFIG_LINE_LIMIT, "%s_queue", pathway.stages[i].name);
+            sampler_column(name, pathway.stages[i].queue.tvar);
+        }
+    }
+    sampler_start();
+}
+
+
+void init_monitor(void)  /* Monitor every resource and stage queue, if the model asks to. */
+{
+    if (monitor.batch == 0)
+        return;
+    if (monitor.num_metrics == 0)
+    {
+        /* Once per scenario:  the variables stay the same across its runs. */
+        for (int i = 1; i <= pathway.num_resources; i++)
+            monitor_metric((timest_var){maxtvar + pathway.resources[i].list});
+        for (int i = 1; i <= pathway.num_stages; i++)
+        {
+            if (pathway.stages[i].kind == STAGE_SERVICE)
+                monitor_queue(pathway.stages[i].queue.tvar);
+        }
+    }
+    monitor_start();
+}
+
+
+void init_sensitivity(void)  /* Differentiate every occupancy and stage queue, if the model asks to. */
+{
+    if (sensitivity.num_params == 0)
+        return;
+    if (sensitivity.num_levels == 0)
+    {
+        for (int i = 1; i <= pathway.num_resources; i++)
+            sensitivity_level((timest_var){maxtvar + pathway.resources[i].list});
+        for (int i = 1; i <= pathway.num_stages; i++)
+            sensitivity_level(timest_register(i));
+    }
+    sensitivity_start();
+}
+
+
+void write_series(const struct scenario* scenario)  /* Write the sampled series to out/<name>.csv. */
+{
+    char series_name[FILENAME_LIMIT];
+
+    if (sampler.interval <= 0)
+        return;
+    snprintf(series_name, FILENAME_LIMIT, "out/%s.csv", scenario->name);
+    if (sampler_write(series_name) != 0)
+        exit(4);
+}
+
+
+void record_replication(int run)  /* Keep the outputs and controls of one replication. */
+{
+    double outputs[pathway.num_resources + 1], controls[MAX_CONTROLS];
+    struct stage *stage;
+
+    if (replications.runs < 2)
+        return;
+    for (int i = 1; i <= pathway.num_resources; i++)
+        outputs[i - 1] = filest(pathway.resources[i].list);
+    for (int k = 0; k < replications.num_controls; k++)
+    {
+        stage = pathway_stage(replications.control_names[k]);
+        controls[k] = sampst(0.0, -stage->durations.id) - pathway_mean_duration(stage);
+    }
+    replications_record(run, outputs, controls);
+}
+
+
+void run_splitting(void)  /* Estimate the rare event by splitting, once per independent run. */
+{
+    for (int run = 0; run < splitting.runs; run++) {
+        init_simlib();
+        replication = run;
+        init_model();
+        splitting_run(run, reseed_model);
+    }
+    report_splitting();
+}
+
+
+void reseed_model(long trajectory)  /* Fresh streams for a trajectory, past the seeds of the runs. */
+{
+    for (int i = 1; i <= pathway.num_stages; i++)
+        lcgrandst(stream_seed(seed + splitting.runs + trajectory, i), i);
+}
+
+
+void report(void)  /* Report generator function. */
+{
+    struct resource *resource;
+    struct stage    *stage;
+    int    width, level;
+
+    /* Get and write out estimates of desired measures of performance. */
+    try_output(fprintf(outfile, "[PERFORMANCE METRICS]\n"));
+    for (int i = 1; i <= pathway.num_resources; i++)
+    {
+        resource = &pathway.resources[i];
+        width = strlen(resource->title) < 23 ? 24 - strlen(resource->title) : 1;
+        try_output(fprintf(outfile, "\nAverage Number of Active %s:%*.1f %s\n", resource->title,
+                   width, filest(resource->list), resource->unit));
+    }
+
+    /* Queues, for the stages where anyone had to wait. */
+    for (int i = 1; i <= pathway.num_stages; i++)
+    {
+        stage = &pathway.stages[i];
+        if (timest(0.0, -stage->queue.tvar.id) > 0 || transfer[2] > 0)
+        {
+            width = strlen(stage->name) < 21 ? 22 - strlen(stage->name) : 1;
+            try_output(fprintf(outfile, "\nAverage Number Waiting for %s:%*.1f patients\n", stage->name,
+                       width, timest(0.0, -stage->queue.tvar.id)));
+        }
+    }
+
+    /* Time on diversion, up to the end of the run, and arrivals sent elsewhere. */
+    if (pathway.num_diversions > 0)
+    {
+        try_output(fprintf(outfile, "\nHours On Diversion:%31.1f hours\n",
+                   (pathway.diverting_time + (pathway.diverting ? sim_time - pathway.diverting_since : 0)) / 60));
+        try_output(fprintf(outfile, "\nDiversion Episodes:%31d\n", pathway.num_episodes));
+        try_output(fprintf(outfile, "\nPatients Diverted:%32d patients\n", pathway.num_diverted));
+    }
+
+    /* Admitted patients who waited for the next stage in a room they kept. */
+    if (pathway.has_boarding)
+    {
+        sampst(0.0, -SVAR_BOARDING);
+        try_output(fprintf(outfile, "\nPatients Boarded:%33d patients\n", (int) transfer[2]));
+        try_output(fprintf(outfile, "\nAverage Boarding Time:%28.1f minutes\n", transfer[1]));
+        try_output(fprintf(outfile, "\nMaximum Boarding Time:%28.1f minutes\n", transfer[2] > 0 ? transfer[3] : 0.0));
+    }
+
+    /* Patients who left without being seen, overall and by acuity. */
+    if (pathway.has_patience)
+    {
+        try_output(fprintf(outfile, "\nPatients Left Without Being Seen:%17d patients\n", pathway.num_abandoned));
+        try_output(fprintf(outfile, "\nLeft Without Being Seen Rate:%21.3f\n",
+                   pathway.num_completed > 0 ? (float)pathway.num_abandoned / pathway.num_completed : 0.0));
+        for (level = 1; level <= MAX_ACUITY; level++)
+        {
+            if (pathway.arrivals[level] == 0) continue;
+            try_output(fprintf(outfile, "\nLeft Without Being Seen Rate, Acuity %d:%11.3f (%d of %d arrivals)\n", level,
+                       (float)pathway.abandoned[level] / pathway.arrivals[level],
+                       pathway.abandoned[level], pathway.arrivals[level]));
+        }
+    }
+}
+
+void report_monitor(void)  /* How the run ended, and the monitors' last tests. */
+{
+    static const char *status[] = {"completed", "converged", "unstable"};
+
+    if (monitor.batch == 0)
+        return;
+    try_output(fprintf(outfile, "\n\n[MONITOR]\n"));
+    try_output(fprintf(outfile, "\nRun Status:%39s\n", status[monitor.status]));
+    try_output(fprintf(outfile, "\nPatients Simulated:%31d patients\n", pathway.num_completed));
+    try_output(fprintf(outfile, "\nBatches Kept:%37d of %d patients\n", monitor.kept, monitor.size * monitor.batch));
+    if (monitor.kept < MONITOR_MIN_BATCHES)
+        return;
+    try_output(fprintf(outfile, "\nWaiting Trend:%36.2f z\n", monitor.z));
+    if (monitor.widest >= 0)
+        try_output(fprintf(outfile, "\nWidest Confidence Interval:%23.3f of the mean (%s)\n", monitor.width,
+                   pathway.resources[monitor.widest + 1].title));
+}
+
+void report_sensitivity(void)  /* Derivatives of the averages, with their elasticities. */
+{
+    struct resource *resource;
+    struct stage    *stage;
+    double average, derivative;
+    int    width;
+
+    if (sensitivity.num_params == 0)
+        return;
+    try_output(fprintf(outfile, "\n\n[SENSITIVITY]\n"));
+    for (int j = 0; j < sensitivity.num_params; j++)
+    {
+        if (sensitivity.rates[j])
+        {
+            try_output(fprintf(outfile, "\nWindow Of Arrival Rates:%26.1f minutes\n", sensitivity.window));
+            break;
+        }
+    }
+    for (int j = 0; j < sensitivity.num_params; j++)
+    {
+        width = strlen(sensitivity.names[j]) < 36 ? 37 - strlen(sensitivity.names[j]) : 1;
+        try_output(fprintf(outfile, "\nPer Unit Of %s:%*.3f\n", sensitivity.names[j], width, sensitivity.values[j]));
+
+        /* Occupancies, then the queues of the stages where anyone had to wait. */
+        for (int i = 1; i <= pathway.num_resources + pathway.num_stages; i++)
+        {
+            if (i <= pathway.num_resources)
+            {
+                resource = &pathway.resources[i];
+                average = filest(resource->list);
+                width = strlen(resource->title) < 34 ? 35 - strlen(resource->title) : 1;
+                try_output(fprintf(outfile, "  Active %s:%*.4f %s", resource->title, width,
+                           sensitivity_derivative(i - 1, j), resource->unit));
+            }
+            else
+            {
+                stage = &pathway.stages[i - pathway.num_resources];
+                if ((average = timest(0.0, -stage->queue.tvar.id)) <= 0)
+                    continue;
+                width = strlen(stage->name) < 31 ? 32 - strlen(stage->name) : 1;
+                try_output(fprintf(outfile, "  Waiting for %s:%*.4f patients", stage->name, width,
+                           sensitivity_derivative(i - 1, j)));
+            }
+            derivative = sensitivity_derivative(i - 1, j);
+            if (average > 0)
+                try_output(fprintf(outfile, " (elasticity %.2f)", derivative * sensitivity.values[j] / average));
+            try_output(fprintf(outfile, "\n"));
+        }
+    }
+}
+
+void report_replications(void)  /* Estimates over the replications, with their variance reduction. */
+{
+    struct resource *resource;
+    double mean, half_width, factor;
+    int    width;
+
+    if (replications.runs < 2)
+        return;
+    try_output(fprintf(outfile, "\n\n[REPLICATIONS]\n"));
+    if (replications.antithetic)
+        try_output(fprintf(outfile, "\nReplications:%36d runs (%d antithetic pairs)\n",
+                   replications.runs, replications.runs / 2));
+    else
+        try_output(fprintf(outfile, "\nReplications:%36d runs\n", replications.runs));
+    if (replications.num_controls > 0)
+        try_output(fprintf(outfile, "\nControl Variates:%33d stages\n", replications.num_controls));
+    for (int i = 1; i <= pathway.num_resources; i++)
+    {
+        resource = &pathway.resources[i];
+        if (replications_estimate(i - 1, &mean, &half_width, &factor) != 0)
+            try_output(fprintf(outfile, "\nControls Are Collinear, Ignored For %s\n", resource->title));
+        width = strlen(resource->title) < 23 ? 24 - strlen(resource->title) : 1;
+        try_output(fprintf(outfile, "\nAverage Number of Active %s:%*.1f %s +/- %.2f (95%%)\n", resource->title,
+                   width, mean, resource->unit, half_width));
+        try_output(fprintf(outfile, "Variance Reduction Factor:%24.2f\n", factor));
+    }
+}
+
+void report_splitting(void)  /* The probability of the rare event, with the cost of estimating it. */
+{
+    struct resource *resource = pathway_resource(splitting.resource);
+    double mean, half_width, crude_runs, speed_up;
+    int    top = splitting.levels[splitting.num_levels - 1];
+
+    splitting_estimate(&mean, &half_width, &crude_runs, &speed_up);
+    try_output(fprintf(outfile, "[RARE EVENT]\n"));
+    try_output(fprintf(outfile, "\nEvent: %d Active %s Within %.1f Minutes\n", top, resource->title, splitting.horizon));
+    try_output(fprintf(outfile, "\nSplitting Runs:%34d runs of %d trajectories per level\n",
+               splitting.runs, splitting.effort));
+    for (int k = 0; k < splitting.num_levels; k++)
+    {
+        if (splitting.started[k] == 0) break;
+        try_output(fprintf(outfile, "\nReached %4d %s:%*.4f (%ld of %ld trajectories)\n", splitting.levels[k],
+                   resource->unit, 36 - (int)strlen(resource->unit), (double)splitting.crossed[k] / splitting.started[k],
+                   splitting.crossed[k], splitting.started[k]));
+    }
+    try_output(fprintf(outfile, "\nProbability Of The Event:%24.3e +/- %.3e (95%%)\n", mean, half_width));
+    try_output(fprintf(outfile, "\nEvents Simulated:%33ld\n", splitting.events));
+    if (crude_runs > 0)
+    {
+        try_output(fprintf(outfile, "\nCrude Runs For The Same Variance:%17.0f runs\n", crude_runs));
+        try_output(fprintf(outfile, "\nSpeed-Up Over Crude Runs:%25.1f\n", speed_up));
+    }
+}
+
+void report_screen(int simulated)  /* The analytic approximation, against the simulation if there was one. */
+{
+    struct resource *resource;
+    struct stage    *stage;
+    float  value;
+    int    width;
+
+    if (!screen.enabled)
+        return;
+    try_output(fprintf(outfile, simulated ? "\n\n[APPROXIMATION]\n" : "[APPROXIMATION]\n"));
+    if (!screen.screened)
+    {
+        try_output(fprintf(outfile, "\nTraced Arrivals Or Closed Routes Cannot Be Approximated\n"));
+        return;
+    }
+    resource = &pathway.resources[screen.bottleneck];
+    if (!screen.stable)
+    {
+        try_output(fprintf(outfile, "\nUnstable: %s Are Busy Beyond Capacity%s\n", resource->title,
+                   simulated ? "" : ", Not Simulated"));
+        return;
+    }
+    width = strlen(resource->title) < 26 ? 27 - strlen(resource->title) : 1;
+    try_output(fprintf(outfile, "\nUtilization of %s:%*.3f (busiest)\n", resource->title, width, screen.utilization));
+
+    /* Each level approximated, with the simulated one and the error. */
+    for (int i = 1; i <= pathway.num_resources; i++)
+    {
+        resource = &pathway.resources[i];
+        width = strlen(resource->title) < 23 ? 24 - strlen(resource->title) : 1;
+        try_output(fprintf(outfile, "\nAverage Number of Active %s:%*.1f %s", resource->title,
+                   width, screen.load[i], resource->unit));
+        value = simulated ? filest(resource->list) : 0;
+        if (value > 0)
+            try_output(fprintf(outfile, " (simulated %.1f, error %+.1f%%)", value,
+                       100 * (screen.load[i] - value) / value));
+        try_output(fprintf(outfile, "\n"));
+    }
+    for (int i = 1; i <= pathway.num_stages; i++)
+    {
+        stage = &pathway.stages[i];
+        value = simulated ? timest(0.0, -stage->queue.tvar.id) : 0;
+        if (stage->kind != STAGE_SERVICE || (screen.waiting[i] < 0.05 && value < 0.05))
+            continue;
+        width = strlen(stage->name) < 21 ? 22 - strlen(stage->name) : 1;
+        try_output(fprintf(outfile, "\nAverage Number Waiting for %s:%*.1f patients", stage->name,
+                   width, screen.waiting[i]));
+        if (value > 0)
+            try_output(fprintf(outfile, " (simulated %.1f, error %+.1f%%)", value,
+                       100 * (screen.waiting[i] - value) / value));
+        try_output(fprintf(outfile, "\n"));
+    }
+}
+
+void try_output(int status) /* Validate output or exit */
+{
+    if (status < 0)
+    {
+        printf("FILE ERROR: Output File \"%s\" Cannot Be Written To\n", outfile_name);
+        if (fclose(outfile) != 0)
+        {
+            printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
+        }
+        exit(5);
+    }
+}
+
+void catch_exception(char* error_msg, int error_type) /* General exception printer */
+{
+    printf("%s", error_msg);
+    if (fclose(outfile) != 0)
+    {
+        printf("FILE ERROR: Output File \"%s\" Cannot Be Closed\n", outfile_name);
+    }
+    exit(error_type);
+}
+
@@ -0,0 +1,193 @@
+/* This is monitor.c.  Early termination of runs, described in monitor.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "monitor.h"
+#include "replication.h"
+
+SIMLIB_LOCAL struct monitor monitor;
+
+int monitor_load(struct config *cfg, struct config_section *section) /* The [monitor] section, or none */
+{
+    char *text, *end;
+
+    monitor_free();
+    if (section == NULL)
+        return 0;
+
+    monitor.batch = 200;
+    if ((text = config_value(cfg, section, "batch")) != NULL &&
+        ((monitor.batch = strtol(text, &end, 10), end == text || *end != '\0') || monitor.batch < 1))
+    {
+        printf("CONFIG ERROR: %s:%d: [monitor] \"batch\" Must Be At Least 1\n", cfg->origin, section->line);
+        monitor.batch = 0;
+        return -1;
+    }
+    monitor.warmup = 5;
+    if ((text = config_value(cfg, section, "warmup")) != NULL &&
+        ((monitor.warmup = strtol(text, &end, 10), end == text || *end != '\0') || monitor.warmup < 0))
+    {
+        printf("CONFIG ERROR: %s:%d: [monitor] \"warmup\" Must Be At Least 0\n", cfg->origin, section->line);
+        monitor.batch = 0;
+        return -1;
+    }
+    if ((text = config_value(cfg, section, "precision")) != NULL &&
+        ((monitor.precision = strtod(text, &end), end == text || *end != '\0') || !(monitor.precision > 0)))
+    {
+        printf("CONFIG ERROR: %s:%d: [monitor] \"precision\" Must Be Positive\n", cfg->origin, section->line);
+        monitor.batch = 0;
+        return -1;
+    }
+    monitor.trend = 4;
+    if ((text = config_value(cfg, section, "trend")) != NULL &&
+        ((monitor.trend = strtod(text, &end), end == text || *end != '\0') || !(monitor.trend >= 0)))
+    {
+        printf("CONFIG ERROR: %s:%d: [monitor] \"trend\" Must Be A z Of At Least 0\n", cfg->origin, section->line);
+        monitor.batch = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void monitor_metric(timest_var variable) /* Watch one more occupancy */
+{
+    monitor.metrics = (timest_var *) realloc(monitor.metrics, (monitor.num_metrics + 1) * sizeof(timest_var));
+    monitor.metrics[monitor.num_metrics++] = variable;
+}
+
+void monitor_queue(timest_var variable) /* Watch one more queue */
+{
+    monitor.queues = (timest_var *) realloc(monitor.queues, (monitor.num_queues + 1) * sizeof(timest_var));
+    monitor.queues[monitor.num_queues++] = variable;
+}
+
+static double area(timest_var variable) /* Area under the variable up to now */
+{
+    struct timest_acc *acc = &timest_acc[variable.id];
+
+    return acc->area + (double) (sim_time - acc->tlvc) * acc->preval;
+}
+
+void monitor_start(void) /* Begin the first batch now, once simlib is initialized */
+{
+    int n = monitor.num_metrics + monitor.num_queues, i;
+
+    if (monitor.batch == 0)
+        return;
+    monitor.area  = (double *) realloc(monitor.area, n * sizeof(double));
+    monitor.means = (double *) realloc(monitor.means,
+                                       MONITOR_MAX_BATCHES * (monitor.num_metrics + 1) * sizeof(double));
+    memset(monitor.means, 0, MONITOR_MAX_BATCHES * (monitor.num_metrics + 1) * sizeof(double));
+    for (i = 0; i < monitor.num_metrics; i++)
+        monitor.area[i] = area(monitor.metrics[i]);
+    for (i = 0; i < monitor.num_queues; i++)
+        monitor.area[monitor.num_metrics + i] = area(monitor.queues[i]);
+    monitor.next    = pathway.num_completed + monitor.batch;
+    monitor.start   = sim_time;
+    monitor.batches = 0;
+    monitor.size    = 1;
+    monitor.filled  = 0;
+    monitor.kept    = 0;
+    monitor.status  = MONITOR_COMPLETED;
+    monitor.z = monitor.width = 0;
+    monitor.widest  = -1;
+}
+
+static void merge(void) /* Halve the kept batches by merging neighbours */
+{
+    int m = monitor.num_metrics + 1, k, i;
+
+    for (k = 0; k < monitor.kept / 2; k++)
+    {
+        for (i = 0; i < m; i++)
+            monitor.means[k * m + i] = monitor.means[2 * k * m + i] + monitor.means[(2 * k + 1) * m + i];
+    }
+    memset(&monitor.means[k * m], 0, (MONITOR_MAX_BATCHES - k) * m * sizeof(double));
+    monitor.kept  = k;
+    monitor.size *= 2;
+}
+
+int monitor_check(void)
+{
+
+/* End the batch:  take its means, add them to the last kept batch, and when
+   that is complete test the waiting for a trend and the occupancies for
+   precision.  Returns the run's status. */
+
+    int    m = monitor.num_metrics + 1, n, i, j, k;
+    double now, span = sim_time - monitor.start, *last, mean, half_width, width, sum, sum_squares;
+    long   kendall;
+
+    monitor.next += monitor.batch;
+    if (span <= 0)
+        return monitor.status;
+    last = &monitor.means[monitor.kept * m];
+    for (i = 0; i < monitor.num_metrics; i++)
+    {
+        now = area(monitor.metrics[i]);
+        if (monitor.batches >= monitor.warmup)
+            last[i] += (now - monitor.area[i]) / span;
+        monitor.area[i] = now;
+    }
+    for (i = 0; i < monitor.num_queues; i++)
+    {
+        now = area(monitor.queues[i]);
+        if (monitor.batches >= monitor.warmup)
+            last[monitor.num_metrics] += (now - monitor.area[monitor.num_metrics + i]) / span;
+        monitor.area[monitor.num_metrics + i] = now;
+    }
+    monitor.start = sim_time;
+    if (monitor.batches++ < monitor.warmup || ++monitor.filled < monitor.size)
+        return monitor.status;
+    monitor.filled = 0;
+    if (++monitor.kept == MONITOR_MAX_BATCHES)
+        merge();
+    if ((n = monitor.kept) < MONITOR_MIN_BATCHES)
+        return monitor.status;
+
+    /* Mann-Kendall statistic of the waiting over the later half. */
+    for (kendall = 0, j = n / 2; j < n; j++)
+    {
+        for (k = j + 1; k < n; k++)
+            kendall += (monitor.means[k * m + m - 1] > monitor.means[j * m + m - 1]) -
+                       (monitor.means[k * m + m - 1] < monitor.means[j * m + m - 1]);
+    }
+    k = n - n / 2;
+    monitor.z = (kendall - (kendall > 0) + (kendall < 0)) / sqrt(k * (k - 1.0) * (2 * k + 5) / 18);
+    if (monitor.trend > 0 && monitor.z > monitor.trend)
+        return monitor.status = MONITOR_UNSTABLE;
+
+    /* Batch means of every occupancy in use, within precision of their mean. */
+    monitor.width  = 0;
+    monitor.widest = -1;
+    for (i = 0; i < monitor.num_metrics; i++)
+    {
+        for (sum = sum_squares = 0, k = 0; k < n; k++)
+        {
+            mean = monitor.means[k * m + i] / monitor.size;
+            sum += mean;
+            sum_squares += mean * mean;
+        }
+        if ((mean = sum / n) <= 0)
+            continue;
+        half_width = t_quantile(n - 1) * sqrt(fmax(sum_squares - n * mean * mean, 0) / (n - 1) / n);
+        width = half_width / mean;
+        if (width >= monitor.width)
+        {
+            monitor.width  = width;
+            monitor.widest = i;
+        }
+    }
+    if (monitor.precision > 0 && monitor.width <= monitor.precision)
+        return monitor.status = MONITOR_CONVERGED;
+    return monitor.status;
+}
+
+void monitor_free(void) /* Stop monitoring and release the batches */
+{
+    free(monitor.metrics);
+    free(monitor.queues);
+    free(monitor.area);
+    free(monitor.means);
+    memset(&monitor, 0, sizeof(monitor));
+}
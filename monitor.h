@@ -0,0 +1,70 @@
+/* This is monitor.h.  Online monitors that stop a run early.
+
+   A run is cut into batches of a fixed number of patients completed.  At
+   the end of each batch, and only then, the monitor takes the time-averages
+   of the batch from the growth of timest areas, as the sampler does:  the
+   occupancy of every watched resource, and the total number of patients
+   waiting in the watched queues.  The first warm-up batches are discarded.
+   The others are kept, and when MONITOR_MAX_BATCHES are, neighbours are
+   merged in pairs, as the sampler merges rows:  memory stays bounded, and
+   the kept batches grow longer and their means less correlated as the run
+   goes on.
+
+   The run is unstable when the waiting rises steadily over the later half
+   of the kept batches, past the warm-up transient:  a Mann-Kendall trend
+   test rejects no trend at the given z.  The run has converged when the 95%
+   batch-means confidence interval of every occupancy is within the given
+   fraction of its mean.  Either stops the run, and its status is reported;
+   otherwise it completes as usual. */
+
+#ifndef MONITOR_H
+#define MONITOR_H
+
+#include "simlib.h"
+#include "config.h"
+#include "pathway.h"
+
+#define MONITOR_COMPLETED  0    /* Runs to its goal, or did. */
+#define MONITOR_CONVERGED  1    /* Stopped:  every occupancy is known well enough. */
+#define MONITOR_UNSTABLE   2    /* Stopped:  the queues grow without bound. */
+#define MONITOR_MIN_BATCHES 20  /* Kept batches before either test... */
+#define MONITOR_MAX_BATCHES 64  /* ...and before they are merged in pairs. */
+
+struct monitor {
+    int    batch;               /* Patients per batch, 0 when not monitoring. */
+    int    warmup;              /* Batches discarded. */
+    float  precision;           /* Relative half-width that converges, 0 for none. */
+    float  trend;               /* Trend z that is unstable, 0 for none. */
+    int    num_metrics, num_queues;
+    timest_var *metrics;        /* Occupancies, tested for convergence... */
+    timest_var *queues;         /* ...and queue lengths, summed and tested for a trend. */
+
+    long   next;                /* Completions that end the current batch... */
+    float  start;               /* ...which began at this time... */
+    double *area;               /* ...with these areas, metrics then queues. */
+    int    batches;             /* Batches ended, counting the warm-up. */
+    int    size, filled;        /* Batches merged into each kept one, and into the last so far. */
+    int    kept;                /* Kept batches complete... */
+    double *means;              /* ...and the sums of their metrics' means, then the waiting's. */
+    int    status;
+    double z, width;            /* Last trend z and widest relative half-width... */
+    int    widest;              /* ...of this metric. */
+};
+
+extern SIMLIB_LOCAL struct monitor monitor;
+
+extern int   monitor_load(struct config *cfg, struct config_section *section);
+extern void  monitor_metric(timest_var variable);
+extern void  monitor_queue(timest_var variable);
+extern void  monitor_start(void);
+extern int   monitor_check(void);
+extern void  monitor_free(void);
+
+static inline int monitor_advance(void) /* Test the batch just ended, if one has */
+{
+    if (monitor.batch > 0 && pathway.num_completed >= monitor.next)
+        return monitor_check();
+    return MONITOR_COMPLETED;
+}
+
+#endif
@@ -0,0 +1,567 @@
+/* This is network.c.  Conservative and optimistic parallel simulation of the
+   sites of a network, as described in network.h. */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "network.h"
+
+#define EVENT_TRANSFER (pathway.num_stages + 2)  /* A transferred patient arrives. */
+#define EVENT_STATUS   (pathway.num_stages + 3)  /* Another site's status changes. */
+
+/* Messages arriving at the same time are taken by sender, then in the order
+   sent, ahead of the site's own events at that time;  so the order of events
+   never depends on when a message was delivered. */
+#define MESSAGE_ORDER(from, id) (LONG_MIN / 2 + ((long) (from) << 40) + (id))
+
+static SIMLIB_LOCAL struct site *current;        /* Site run by this thread. */
+
+struct checkpoint {             /* Copy of a site's state. */
+    float  time;                /* sim_time when copied. */
+    long   events;              /* site->events then... */
+    long   stamp;               /* ...anti-messages taken... */
+    long   received;            /* ...messages received... */
+    long   next_id;             /* ...and sent. */
+    int    last;
+    unsigned char       *diverting;
+    struct simlib_state  simlib;
+    struct pathway_state pathway;
+};
+
+struct sent_message {
+    float  time;                /* sim_time when sent. */
+    int    to;
+    long   id;
+};
+
+struct received_message {
+    struct message message;     /* held stays allocated for rescheduling. */
+    int    from;
+    long   number;              /* The receiver's count of messages before it. */
+    event_handle handle;        /* Its pending event... */
+    int    patient;             /* ...and a transfer's record, from pathway_receive. */
+    long   annihilated;         /* Stamp of its anti-message, 0 if none. */
+};
+
+/* Message queues.  Each queue is a chain of blocks:  the producer fills the
+   last block and links a new one when it is full, the consumer frees blocks
+   it has read to the end.  Message counts and links are published with
+   release stores, so neither side ever waits for the other. */
+
+static void queue_init(struct message_queue *queue) /* Empty queue of one block */
+{
+    queue->head = queue->tail = (struct message_block *) calloc(1, sizeof(struct message_block));
+    queue->read = 0;
+}
+
+static void queue_push(struct message_queue *queue, const struct message *message) /* Producer side */
+{
+    struct message_block *block = queue->tail, *next;
+    int    n = atomic_load_explicit(&block->count, memory_order_relaxed);
+
+    if (n == NETWORK_BLOCK)
+    {
+        next = (struct message_block *) calloc(1, sizeof(struct message_block));
+        atomic_store_explicit(&block->next, next, memory_order_release);
+        queue->tail = block = next;
+        n = 0;
+    }
+    block->messages[n] = *message;
+    atomic_store_explicit(&block->count, n + 1, memory_order_release);
+}
+
+static int queue_pop(struct message_queue *queue, struct message *message) /* Consumer side, 0 if empty */
+{
+    struct message_block *block = queue->head, *next;
+
+    for (;;)
+    {
+        if (queue->read < atomic_load_explicit(&block->count, memory_order_acquire))
+        {
+            *message = block->messages[queue->read++];
+            return 1;
+        }
+        if (queue->read < NETWORK_BLOCK ||
+            (next = atomic_load_explicit(&block->next, memory_order_acquire)) == NULL)
+            return 0;
+        free(block);
+        queue->head = block = next;
+        queue->read = 0;
+    }
+}
+
+static void queue_free(struct message_queue *queue) /* Drop unread messages and the blocks */
+{
+    struct message message;
+
+    while (queue_pop(queue, &message))
+        free(message.held);
+    free(queue->head);
+}
+
+/* Pathway hooks, run on the sending site's thread. */
+
+static void send(int to, struct message *message) /* Queue a message for another site */
+{
+    struct network *network = current->network;
+
+    message->time = sim_time + network->delay;
+    message->id   = ++current->next_id;
+    if (network->optimistic)
+    {
+        /* Re-running events only repeats messages already sent. */
+        if (current->coasting)
+        {
+            free(message->held);
+            return;
+        }
+        if (current->num_sent == current->max_sent)
+        {
+            current->max_sent = current->max_sent > 0 ? 2 * current->max_sent : 256;
+            current->sent_log = (struct sent_message *)
+                realloc(current->sent_log, current->max_sent * sizeof(struct sent_message));
+        }
+        current->sent_log[current->num_sent].time = sim_time;
+        current->sent_log[current->num_sent].to   = to;
+        current->sent_log[current->num_sent].id   = message->id;
+        current->num_sent++;
+    }
+    queue_push(&network->queues[current->index * network->num_sites + to], message);
+    current->sent++;
+}
+
+static int transfer_patient(int stage, const struct patient *patient, const unsigned char *held) /* on_transfer */
+{
+    struct message message;
+    int    n = current->network->num_sites, to, i;
+
+    /* Sites take turns, skipping those last known to be diverting. */
+    for (i = 1; i <= n; i++)
+    {
+        to = (current->last + i) % n;
+        if (to != current->index && !current->diverting[to]) break;
+    }
+    if (i > n)
+        return 0;
+    current->last = to;
+
+    memset(&message, 0, sizeof(message));
+    message.kind    = MESSAGE_TRANSFER;
+    message.stage   = stage;
+    message.patient = *patient;
+    message.held    = (unsigned char *) malloc(pathway.num_resources + 1);
+    memcpy(message.held, held, pathway.num_resources + 1);
+    send(to, &message);
+    return 1;
+}
+
+static void announce(int diverting) /* on_divert:  tell every other site */
+{
+    struct message message;
+    int    to;
+
+    memset(&message, 0, sizeof(message));
+    message.kind      = MESSAGE_STATUS;
+    message.diverting = diverting;
+    for (to = 0; to < current->network->num_sites; to++)
+    {
+        if (to != current->index)
+            send(to, &message);
+    }
+}
+
+/* Site threads. */
+
+static event_handle schedule_message(int from, const struct message *message, int *patient) /* Event of a received message */
+{
+    if (message->kind == MESSAGE_TRANSFER)
+    {
+        *patient = pathway_receive(&message->patient, message->held);
+        transfer[ATTR_PATIENT] = *patient;
+        transfer[ATTR_STAGE]   = message->stage;
+        return event_schedule_seq(message->time, EVENT_TRANSFER, MESSAGE_ORDER(from, message->id));
+    }
+    transfer[ATTR_SITE]      = from;
+    transfer[ATTR_DIVERTING] = message->diverting;
+    return event_schedule_seq(message->time, EVENT_STATUS, MESSAGE_ORDER(from, message->id));
+}
+
+static void run_event(struct site *site) /* Take and run the next event */
+{
+    timing();
+    site->events++;
+    if (next_event_type == EVENT_TRANSFER)
+        pathway_admit((int) transfer[ATTR_PATIENT], (int) transfer[ATTR_STAGE]);
+    else if (next_event_type == EVENT_STATUS)
+        site->diverting[(int) transfer[ATTR_SITE]] = (unsigned char) transfer[ATTR_DIVERTING];
+    else
+        pathway_dispatch();
+}
+
+static void deliver(struct site *site) /* Schedule the messages sent to the site in the last window */
+{
+    struct network *network = site->network;
+    struct message  message;
+    int    from, patient;
+
+    /* Senders in a fixed order, each in the order it sent. */
+    for (from = 0; from < network->num_sites; from++)
+    {
+        while (queue_pop(&network->queues[from * network->num_sites + site->index], &message))
+        {
+            site->received++;
+            schedule_message(from, &message, &patient);
+            free(message.held);
+        }
+    }
+}
+
+static void run_window(struct site *site, float limit) /* Run the site's events before limit */
+{
+    while (event_next_time() < limit)
+        run_event(site);
+}
+
+static void run_conservative(struct site *site) /* Windows of one lookahead */
+{
+    struct network *network = site->network;
+    float  start, limit;
+    int    i;
+
+    for (;;)
+    {
+        /* Agree on the earliest pending event;  nothing sent before start +
+           delay can arrive before it, so the window runs without waiting. */
+        deliver(site);
+        site->next_time = event_next_time();
+        pthread_barrier_wait(&network->barrier);
+        for (i = 0, start = INFINITY; i < network->num_sites; i++)
+        {
+            if (network->sites[i].next_time < start)
+                start = network->sites[i].next_time;
+        }
+        if (start >= network->end_time)
+            break;
+        limit = fminf(start + network->delay, network->end_time);
+        site->windows++;
+
+        /* The barrier after the window also orders every send before the
+           deliveries of the next. */
+        if (network->sequential)
+        {
+            for (i = 0; i < network->num_sites; i++)
+            {
+                if (i == site->index)
+                    run_window(site, limit);
+                pthread_barrier_wait(&network->barrier);
+            }
+        }
+        else
+        {
+            run_window(site, limit);
+            pthread_barrier_wait(&network->barrier);
+        }
+    }
+}
+
+/* Optimistic runs. */
+
+static void checkpoint(struct site *site) /* Copy the site's state */
+{
+    struct checkpoint *copy;
+    int    n = site->network->num_sites;
+
+    /* Copies past num_checkpoints keep their buffers for reuse. */
+    if (site->num_checkpoints == site->max_checkpoints)
+    {
+        site->max_checkpoints = site->max_checkpoints > 0 ? 2 * site->max_checkpoints : 16;
+        site->checkpoints = (struct checkpoint *)
+            realloc(site->checkpoints, site->max_checkpoints * sizeof(struct checkpoint));
+        memset(&site->checkpoints[site->num_checkpoints], 0,
+               (site->max_checkpoints - site->num_checkpoints) * sizeof(struct checkpoint));
+    }
+    copy = &site->checkpoints[site->num_checkpoints++];
+    copy->time     = sim_time;
+    copy->events   = site->events;
+    copy->stamp    = site->stamp;
+    copy->received = site->received;
+    copy->next_id  = site->next_id;
+    copy->last     = site->last;
+    if (copy->diverting == NULL)
+        copy->diverting = (unsigned char *) malloc(n);
+    memcpy(copy->diverting, site->diverting, n);
+    simlib_save(&copy->simlib);
+    pathway_save(&copy->pathway);
+}
+
+static void cancel(struct received_message *entry) /* Remove a received message's pending event */
+{
+    if (event_cancel_handle(entry->handle) && entry->message.kind == MESSAGE_TRANSFER)
+        pathway_discard(entry->patient);
+}
+
+static void rollback(struct site *site, float time) /* Undo every event at or after time */
+{
+    struct network *network = site->network;
+    struct checkpoint *copy;
+    struct received_message *entry;
+    struct sent_message *sent;
+    struct message anti;
+    int    k, i;
+
+    /* The last copy made before time;  fossil collection keeps one. */
+    for (k = site->num_checkpoints - 1; k > 0 && site->checkpoints[k].time >= time; k--)
+        ;
+    copy = &site->checkpoints[k];
+    site->num_checkpoints = k + 1;
+    site->rollbacks++;
+    site->rolled_back += site->events - copy->events;
+    simlib_restore(&copy->simlib);
+    pathway_restore(&copy->pathway);
+    site->events  = copy->events;
+    site->next_id = copy->next_id;
+    site->last    = copy->last;
+    memcpy(site->diverting, copy->diverting, network->num_sites);
+
+    /* Cancel what was sent from time on;  what was sent before is sent
+       again, identically and with the same ids, by the events re-run below,
+       and the ids of what is cancelled are given to what replaces it. */
+    while (site->num_sent > 0 && site->sent_log[site->num_sent - 1].time >= time)
+    {
+        sent = &site->sent_log[--site->num_sent];
+        memset(&anti, 0, sizeof(anti));
+        anti.kind = MESSAGE_ANTI;
+        anti.id   = sent->id;
+        queue_push(&network->queues[site->index * network->num_sites + sent->to], &anti);
+        site->antimessages++;
+    }
+
+    /* The copy lacks the messages received since, and still has those
+       cancelled since. */
+    for (i = 0; i < site->num_received; i++)
+    {
+        entry = &site->received_log[i];
+        if (entry->number < copy->received)
+        {
+            if (entry->annihilated > copy->stamp)
+                cancel(entry);
+        }
+        else if (!entry->annihilated)
+            entry->handle = schedule_message(entry->from, &entry->message, &entry->patient);
+    }
+
+    site->coasting = 1;
+    while (event_next_time() < time)
+        run_event(site);
+    site->coasting = 0;
+}
+
+static void receive(struct site *site) /* Take every message sent to the site so far */
+{
+    struct network *network = site->network;
+    struct received_message *entry;
+    struct message message;
+    int    from, i;
+
+    for (from = 0; from < network->num_sites; from++)
+    {
+        while (queue_pop(&network->queues[from * network->num_sites + site->index], &message))
+        {
+            if (message.kind == MESSAGE_ANTI)
+            {
+                /* A queue keeps its order, so the message came first;  an
+                   earlier one of the same id has been annihilated. */
+                for (i = site->num_received - 1; i >= 0; i--)
+                {
+                    entry = &site->received_log[i];
+                    if (entry->from == from && entry->message.id == message.id && !entry->annihilated)
+                        break;
+                }
+                if (i < 0)
+                {
+                    printf("NETWORK ERROR: Anti-Message %ld From Site %d Matches No Message\n", message.id, from);
+                    exit(15);
+                }
+                entry->annihilated = ++site->stamp;
+                if (entry->message.time <= sim_time)
+                    rollback(site, entry->message.time);
+                else
+                    cancel(entry);
+                continue;
+            }
+
+            if (site->num_received == site->max_received)
+            {
+                site->max_received = site->max_received > 0 ? 2 * site->max_received : 256;
+                site->received_log = (struct received_message *)
+                    realloc(site->received_log, site->max_received * sizeof(struct received_message));
+            }
+            entry = &site->received_log[site->num_received++];
+            entry->message     = message;
+            entry->from        = from;
+            entry->number      = site->received++;
+            entry->annihilated = 0;
+            entry->handle      = 0;
+
+            /* A straggler is scheduled with the other messages since the copy. */
+            if (message.time <= sim_time)
+                rollback(site, message.time);
+            else
+                entry->handle = schedule_message(from, &entry->message, &entry->patient);
+        }
+    }
+}
+
+static void fossil_collect(struct site *site, float gvt) /* Drop what no rollback can need */
+{
+    struct checkpoint copy;
+    int    k, n;
+
+    /* Keep the last copy made before GVT, cycling the older ones' buffers. */
+    while (site->num_checkpoints > 1 && site->checkpoints[1].time < gvt)
+    {
+        copy = site->checkpoints[0];
+        memmove(&site->checkpoints[0], &site->checkpoints[1],
+                (site->max_checkpoints - 1) * sizeof(struct checkpoint));
+        site->checkpoints[site->max_checkpoints - 1] = copy;
+        site->num_checkpoints--;
+    }
+
+    /* Messages sent before GVT are never cancelled. */
+    for (n = 0; n < site->num_sent && site->sent_log[n].time < gvt; n++)
+        ;
+    if (n > 0)
+    {
+        memmove(site->sent_log, &site->sent_log[n], (site->num_sent - n) * sizeof(struct sent_message));
+        site->num_sent -= n;
+    }
+
+    /* Messages received before the oldest copy are never scheduled again,
+       and those before GVT never cancelled;  but one cancelled since the copy
+       is still pending in it, and must be cancelled again by a rollback. */
+    for (k = n = 0; k < site->num_received; k++)
+    {
+        if (site->received_log[k].number < site->checkpoints[0].received &&
+            site->received_log[k].message.time < gvt &&
+            site->received_log[k].annihilated <= site->checkpoints[0].stamp)
+            free(site->received_log[k].message.held);
+        else
+            site->received_log[n++] = site->received_log[k];
+    }
+    site->num_received = n;
+}
+
+static void run_optimistic(struct site *site) /* Time Warp */
+{
+    struct network *network = site->network;
+    float  gvt;
+    long   antimessages;
+    int    i, k, settled;
+
+    checkpoint(site);
+    for (;;)
+    {
+        for (k = 0; k < NETWORK_GVT; k++)
+        {
+            receive(site);
+            if (event_next_time() >= network->end_time)
+                break;
+            if (k % NETWORK_CHECKPOINT == NETWORK_CHECKPOINT - 1)
+                checkpoint(site);
+            run_event(site);
+        }
+
+        /* Exchange messages until a round sends none, taking anti-messages
+           and the rollbacks they cause;  then nothing is in transit. */
+        do
+        {
+            pthread_barrier_wait(&network->barrier);
+            antimessages = site->antimessages;
+            receive(site);
+            site->unsettled = site->antimessages != antimessages;
+            pthread_barrier_wait(&network->barrier);
+            for (i = 0, settled = 1; i < network->num_sites; i++)
+                settled &= !network->sites[i].unsettled;
+        } while (!settled);
+
+        /* Every message still to be sent comes from an event at or after GVT. */
+        site->next_time = event_next_time();
+        pthread_barrier_wait(&network->barrier);
+        for (i = 0, gvt = INFINITY; i < network->num_sites; i++)
+        {
+            if (network->sites[i].next_time < gvt)
+                gvt = network->sites[i].next_time;
+        }
+        site->rounds++;
+        if (gvt >= network->end_time)
+            break;
+        fossil_collect(site, gvt);
+    }
+
+    for (k = 0; k < site->num_received; k++)
+        free(site->received_log[k].message.held);
+    for (k = 0; k < site->max_checkpoints; k++)
+    {
+        free(site->checkpoints[k].diverting);
+        simlib_state_free(&site->checkpoints[k].simlib);
+        pathway_state_free(&site->checkpoints[k].pathway);
+    }
+    free(site->checkpoints);
+    free(site->sent_log);
+    free(site->received_log);
+}
+
+static void *site_main(void *arg) /* Thread of one site */
+{
+    struct site    *site = (struct site *) arg;
+    struct network *network = site->network;
+
+    current = site;
+    site->diverting = (unsigned char *) calloc(network->num_sites, 1);
+    network->setup(site);
+    pathway.on_transfer = transfer_patient;
+    pathway.on_divert   = announce;
+
+    if (network->optimistic)
+        run_optimistic(site);
+    else
+        run_conservative(site);
+
+    network->finish(site);
+    pathway.on_transfer = NULL;
+    pathway.on_divert   = NULL;
+    free(site->diverting);
+    return NULL;
+}
+
+int network_run(struct network *network) /* Run every site to end_time, 0 on success */
+{
+    int i, n = network->num_sites;
+
+    network->queues = (struct message_queue *) calloc(n * n, sizeof(struct message_queue));
+    for (i = 0; i < n * n; i++)
+        queue_init(&network->queues[i]);
+    pthread_barrier_init(&network->barrier, NULL, n);
+
+    for (i = 0; i < n; i++)
+    {
+        network->sites[i].index   = i;
+        network->sites[i].last    = i;
+        network->sites[i].network = network;
+        if (pthread_create(&network->sites[i].thread, NULL, site_main, &network->sites[i]) != 0)
+        {
+            printf("NETWORK ERROR: Site Thread Cannot Be Started\n");
+            return -1;
+        }
+    }
+    for (i = 0; i < n; i++)
+        pthread_join(network->sites[i].thread, NULL);
+
+    pthread_barrier_destroy(&network->barrier);
+    for (i = 0; i < n * n; i++)
+        queue_free(&network->queues[i]);
+    free(network->queues);
+    network->queues = NULL;
+    return 0;
+}
@@ -0,0 +1,104 @@
+/* This is network.h.  Runs several pathways as the sites of a network, each
+   site on its own thread with its own simlib state.
+
+   Sites exchange messages:  patients transferred or diverted to another site,
+   and each site's diverting status.  Every message arrives delay minutes
+   after it is sent, which is the lookahead of a conservative (YAWNS)
+   synchronization:  the sites repeatedly agree on the earliest pending event
+   time t, then each runs its events before t + delay independently, since no
+   message sent in that window can arrive inside it.  Messages travel through
+   lock-free single-producer single-consumer queues, one per pair of sites,
+   and are delivered between windows in a fixed order, so a run is the same
+   whether its sites run in parallel or one after another.
+
+   An optimistic run (Time Warp) does not wait:  each site runs its events as
+   they come, copying its simlib and pathway state every NETWORK_CHECKPOINT
+   events.  A message arriving in a site's past (a straggler) rolls the site
+   back to the last copy before it, cancels what the site sent from the
+   straggler's time on with anti-messages, and re-runs the events in between
+   without sending.  Every NETWORK_GVT events the sites exchange messages until
+   none is in transit and agree on the global virtual time (GVT), the earliest
+   pending event, which no rollback can reach;  copies and logs older than GVT
+   are discarded, and the run ends when GVT reaches end_time.  Reports then
+   match a conservative run, apart from the synchronization counts. */
+
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "pathway.h"
+
+#define NETWORK_BLOCK      256  /* Messages per queue block. */
+#define NETWORK_CHECKPOINT  32  /* Optimistic runs:  events between state copies... */
+#define NETWORK_GVT        128  /* ...and events of each site between GVT rounds. */
+#define ATTR_STAGE           4  /* Event attribute of a transfer's stage. */
+#define ATTR_SITE            3  /* Event attribute of a status message's sender. */
+#define ATTR_DIVERTING       4  /* ...and of the status it reports. */
+
+#define MESSAGE_TRANSFER     1  /* A patient arriving at a stage. */
+#define MESSAGE_STATUS       2  /* The sender started or stopped diverting. */
+#define MESSAGE_ANTI         3  /* Cancels the sender's message of the same id. */
+
+struct message {
+    float  time;                /* Arrival time at the receiving site. */
+    int    kind;
+    int    stage;               /* MESSAGE_TRANSFER:  stage entered... */
+    struct patient patient;     /* ...by this patient... */
+    unsigned char *held;        /* ...holding these units, freed by the receiver. */
+    int    diverting;           /* MESSAGE_STATUS. */
+    long   id;                  /* Sender's count of messages sent, with this. */
+};
+
+struct message_block {
+    struct message messages[NETWORK_BLOCK];
+    atomic_int     count;       /* Messages written to this block. */
+    struct message_block *_Atomic next;
+};
+
+struct message_queue {          /* Written by one site, read by another. */
+    _Alignas(64) struct message_block *tail;   /* Producer's block. */
+    _Alignas(64) struct message_block *head;   /* Consumer's block... */
+    int    read;                               /* ...and position in it. */
+};
+
+struct site {
+    int    index;
+    void  *data;                /* Caller's description of the site. */
+    pthread_t thread;
+    float  next_time;           /* Earliest pending event, published each window. */
+    unsigned char *diverting;   /* Last status received from each other site. */
+    int    last;                /* Site of the last transfer. */
+    long   windows, events, sent, received;
+    long   next_id;             /* Messages sent and not rolled back. */
+    struct network *network;
+
+    /* Optimistic runs.  events counts the events not rolled back. */
+    struct checkpoint       *checkpoints;   /* Oldest first. */
+    int    num_checkpoints, max_checkpoints;
+    struct sent_message     *sent_log;      /* Messages that may be cancelled. */
+    int    num_sent, max_sent;
+    struct received_message *received_log;  /* Messages that may be scheduled again. */
+    int    num_received, max_received;
+    long   stamp;                           /* Anti-messages taken. */
+    int    coasting;                        /* Re-running events, not sending. */
+    int    unsettled;                       /* Sent during this GVT exchange. */
+    long   rollbacks, rolled_back, antimessages, rounds;
+};
+
+struct network {
+    int    num_sites;
+    float  delay;               /* Transit time of every message, the lookahead. */
+    float  end_time;            /* Events from this time on are not run. */
+    int    sequential;          /* Run one site at a time, for comparison... */
+    int    optimistic;          /* ...or every site without waiting (Time Warp). */
+    struct site          *sites;
+    struct message_queue *queues;   /* queues[from * num_sites + to] */
+    pthread_barrier_t     barrier;
+    void (*setup)(struct site *site);   /* Compile the pathway and start simlib. */
+    void (*finish)(struct site *site);  /* Report, on the site's thread. */
+};
+
+extern int  network_run(struct network *network);
+
+#endif
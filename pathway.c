@@ -0,0 +1,1444 @@
+/* This is pathway.c.  Compiles the pathway sections of a config file into the
+   stage and resource tables of pathway.h and runs them. */
+
+#include <ctype.h>
+#include <string.h>
+#include "pathway.h"
+
+SIMLIB_LOCAL struct pathway pathway;
+
+static SIMLIB_LOCAL struct config *compile_cfg;        /* Config being compiled. */
+static SIMLIB_LOCAL struct param  *compile_params;     /* Parameters it may reference. */
+static SIMLIB_LOCAL int            compile_num_params;
+static SIMLIB_LOCAL const char   **stage_names;        /* stage_names[1..num_stages] */
+static const char    *acuity_names[MAX_ACUITY + 1] = {"", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+
+/* Duration samplers, selected once per stage at compile time. */
+
+static float sample_constant(struct duration *d, int stream) { (void) stream; return d->a; }
+static float sample_expon(struct duration *d, int stream)    { return expon(d->a, stream); }
+static float sample_normal(struct duration *d, int stream)   { return normal(d->a, stream); }
+static float sample_uniform(struct duration *d, int stream)  { return uniform(d->a, d->b, stream); }
+static float sample_erlang(struct duration *d, int stream)   { return erlang((int)d->b, d->a, stream); }
+
+static float sample_duration(struct duration *d, int stream) /* Draw from a duration distribution */
+{
+    static float (*samplers[])(struct duration *d, int stream) =
+        {NULL, sample_constant, sample_expon, sample_normal, sample_uniform, sample_erlang};
+
+    return samplers[d->dist](d, stream);
+}
+
+/* Patient records. */
+
+static inline unsigned char *held(int p) /* Units each resource list has filed for patient p */
+{
+    return &pathway.held[p * (pathway.num_resources + 1)];
+}
+
+static int new_patient(void) /* Take a patient record from the pool */
+{
+    struct patient *patient;
+    int    i, size;
+
+    if (pathway.free_patient == 0)
+    {
+        size = pathway.max_patients > 0 ? 2 * pathway.max_patients : 256;
+        pathway.patients = (struct patient *)
+            realloc(pathway.patients, (size + 1) * sizeof(struct patient));
+        pathway.held = (unsigned char *)
+            realloc(pathway.held, (size + 1) * (pathway.num_resources + 1));
+        for (i = size; i > pathway.max_patients; i--)
+        {
+            pathway.patients[i].next = pathway.free_patient;
+            pathway.free_patient = i;
+        }
+        pathway.max_patients = size;
+    }
+    i = pathway.free_patient;
+    patient = &pathway.patients[i];
+    pathway.free_patient = patient->next;
+    memset(patient, 0, sizeof(struct patient));
+    memset(held(i), 0, pathway.num_resources + 1);
+    patient->arrival_time = sim_time;
+    patient->severity = -INFINITY;
+    return i;
+}
+
+static void free_patient(int p) /* Return a patient record to the pool */
+{
+    pathway.patients[p].next = pathway.free_patient;
+    pathway.free_patient = p;
+}
+
+/* Diversion. */
+
+static float diversion_level(const struct diversion *diversion) /* What the policy watches, now */
+{
+    struct queue *queue;
+
+    if (diversion->measure == DIVERT_OCCUPANCY)
+        return list_size[diversion->target];
+    queue = &pathway.stages[diversion->target].queue;
+    if (diversion->measure == DIVERT_QUEUE)
+        return queue->length;
+    return queue->length > 0 ? sim_time - pathway.patients[queue->head].queued : 0;
+}
+
+static void update_diverting(unsigned int watching) /* Re-evaluate the policies watching a change */
+{
+    struct diversion *diversion;
+    unsigned int active = pathway.active;
+    float  level;
+    int    i, diverting;
+
+    for (i = 0; watching != 0; i++, watching >>= 1)
+    {
+        if (!(watching & 1))
+            continue;
+        diversion = &pathway.diversions[i];
+        level = diversion_level(diversion);
+        if (level >= diversion->start)
+            active |= 1u << i;
+        else if (level < diversion->stop)
+            active &= ~(1u << i);
+    }
+    pathway.active = active;
+    diverting = (active != 0);
+    if (diverting == pathway.diverting)
+        return;
+
+    /* Count the time on diversion, and tell the network. */
+    if (diverting)
+    {
+        pathway.diverting_since = sim_time;
+        pathway.num_episodes++;
+    }
+    else
+        pathway.diverting_time += sim_time - pathway.diverting_since;
+    pathway.diverting = diverting;
+    if (pathway.on_divert != NULL)
+        pathway.on_divert(diverting);
+}
+
+/* Stage queues, doubly linked through the patient records. */
+
+static void enqueue(struct stage *stage, int p) /* Join the back of a stage queue */
+{
+    struct patient *patient = &pathway.patients[p];
+    struct queue   *queue = &stage->queue;
+
+    patient->waiting = stage->type;
+    patient->queued = sim_time;
+    patient->prev = queue->tail;
+    patient->next = 0;
+    if (queue->tail != 0)
+        pathway.patients[queue->tail].next = p;
+    else
+        queue->head = p;
+    queue->tail = p;
+    timest_update((float)++queue->length, queue->tvar);
+    if (stage->watched != 0)
+        update_diverting(stage->watched);
+}
+
+static void dequeue(struct stage *stage, int p) /* Leave a stage queue from any position */
+{
+    struct patient *patient = &pathway.patients[p];
+    struct queue   *queue = &stage->queue;
+
+    if (patient->prev != 0)
+        pathway.patients[patient->prev].next = patient->next;
+    else
+        queue->head = patient->next;
+    if (patient->next != 0)
+        pathway.patients[patient->next].prev = patient->prev;
+    else
+        queue->tail = patient->prev;
+    patient->waiting = 0;
+    timest_update((float)--queue->length, queue->tvar);
+    if (stage->watched != 0)
+        update_diverting(stage->watched);
+}
+
+/* Resource handling. */
+
+static void capacity_error(struct resource *resource) /* Report an exceeded resource */
+{
+    char error_msg[128];
+
+    sprintf(error_msg, "%s ERROR: Number Of Active %s Exceeded %d\n",
+            resource->label, resource->title, resource->capacity);
+    pathway.on_error(error_msg, resource->error_code);
+}
+
+static int available(struct stage *stage) /* Can the stage's resources be seized now? */
+{
+    struct resource *resource;
+    int    i;
+
+    for (i = 0; i < stage->num_seize; i++)
+    {
+        resource = &pathway.resources[stage->seize[i]];
+        if (list_size[resource->list] >= resource->capacity && !resource->abort_when_full)
+            return 0;
+    }
+    return 1;
+}
+
+static void seize(struct stage *stage, int p) /* File a unit of each resource the stage needs */
+{
+    unsigned int watching = 0;
+    int    i, list;
+
+    for (i = 0; i < stage->num_seize; i++)
+    {
+        list = stage->seize[i];
+        list_file_id(FIRST, pathway.resources[list].id);
+        held(p)[list]++;
+        if (list_size[list] > pathway.resources[list].capacity)
+            capacity_error(&pathway.resources[list]);
+        watching |= pathway.resources[list].watched;
+    }
+    if (watching != 0)
+        update_diverting(watching);
+}
+
+static void start(struct stage *stage, int p);
+
+static void wake(int list) /* Start waiting patients the freed resource now admits */
+{
+    struct resource *resource = &pathway.resources[list];
+    struct stage    *stage;
+    int    i, p;
+
+    for (i = 0; i < resource->num_waiters; i++)
+    {
+        stage = &pathway.stages[resource->waiters[i]];
+        while (stage->queue.length > 0 && available(stage))
+        {
+            p = stage->queue.head;
+            dequeue(stage, p);
+            start(stage, p);
+        }
+    }
+}
+
+static int holds(struct stage *stage, int list) /* Is the resource kept until the next stage starts? */
+{
+    int i;
+
+    for (i = 0; i < stage->num_hold; i++)
+    {
+        if (stage->hold[i] == list)
+            return 1;
+    }
+    return 0;
+}
+
+static void release(struct stage *stage, int p) /* Return a unit of each resource the stage frees */
+{
+    unsigned int watching = 0;
+    int    i;
+
+    for (i = 0; i < stage->num_release; i++)
+    {
+        if (holds(stage, stage->release[i]))
+            continue;
+        list_remove_id(FIRST, pathway.resources[stage->release[i]].id);
+        held(p)[stage->release[i]]--;
+        watching |= pathway.resources[stage->release[i]].watched;
+    }
+    if (watching != 0)
+        update_diverting(watching);
+    for (i = 0; i < stage->num_release; i++)
+    {
+        if (!holds(stage, stage->release[i]))
+            wake(stage->release[i]);
+    }
+}
+
+static void unhold(struct stage *stage, int p) /* Return the units kept after the stage */
+{
+    unsigned int watching = 0;
+    int    i;
+
+    for (i = 0; i < stage->num_hold; i++)
+    {
+        list_remove_id(FIRST, pathway.resources[stage->hold[i]].id);
+        held(p)[stage->hold[i]]--;
+        watching |= pathway.resources[stage->hold[i]].watched;
+    }
+    if (watching != 0)
+        update_diverting(watching);
+}
+
+/* Leaving. */
+
+static void leave(int p) /* Patient leaves from the middle of the pathway */
+{
+    unsigned char *units = held(p);
+    unsigned int   watching = 0;
+    int    list;
+
+    /* Give back everything held, then let waiting patients have it */
+    for (list = 1; list <= pathway.num_resources; list++)
+    {
+        if (units[list] > 0)
+            watching |= pathway.resources[list].watched;
+        while (units[list] > 0)
+        {
+            list_remove_id(FIRST, pathway.resources[list].id);
+            units[list]--;
+        }
+    }
+    free_patient(p);
+    if (watching != 0)
+        update_diverting(watching);
+    for (list = 1; list <= pathway.num_resources; list++)
+        wake(list);
+}
+
+static void abandon(int p) /* Patient leaves without being seen */
+{
+    struct patient *patient = &pathway.patients[p];
+
+    if (patient->waiting != 0)
+        dequeue(&pathway.stages[patient->waiting], p);
+    pathway.abandoned[patient->acuity]++;
+    pathway.num_abandoned++;
+    pathway.num_completed++;
+    leave(p);
+}
+
+static int transfer_full(struct stage *stage) /* Is a transfer resource of the stage full? */
+{
+    struct resource *resource;
+    int    i;
+
+    for (i = 0; i < stage->num_seize; i++)
+    {
+        resource = &pathway.resources[stage->seize[i]];
+        if (resource->transfer_when_full && list_size[resource->list] >= resource->capacity)
+            return 1;
+    }
+    return 0;
+}
+
+static int transfer_out(struct stage *stage, int p) /* Send the patient to the stage at another site */
+{
+    struct patient *patient = &pathway.patients[p];
+
+    if (patient->transferred || !pathway.on_transfer(stage->type, patient, held(p)))
+        return 0;
+    if (patient->patience != 0)
+        event_cancel_handle(patient->patience);
+    leave(p);
+    return 1;
+}
+
+static void start(struct stage *stage, int p) /* Start the stage, ending any boarding */
+{
+    struct patient *patient = &pathway.patients[p];
+    struct stage   *boarded;
+    int    i;
+
+    if (patient->boarding == 0)
+    {
+        stage->start(stage, p);
+        return;
+    }
+
+    /* Patients waiting for the kept units are woken only once the stage has
+       taken its own, which an exit does after freeing the record. */
+    boarded = &pathway.stages[patient->boarding];
+    patient->boarding = 0;
+    if (sim_time > patient->boarded)
+        sampst_update(sim_time - patient->boarded, pathway.boarding_time);
+    unhold(boarded, p);
+    stage->start(stage, p);
+    for (i = 0; i < boarded->num_hold; i++)
+        wake(boarded->hold[i]);
+}
+
+static void enter(struct stage *stage, int p) /* Start the stage now or wait for it */
+{
+    if (stage->queue.length == 0 && available(stage))
+        start(stage, p);
+    else if (pathway.patients[p].impatient)
+        abandon(p);
+    else if (stage->transfers && pathway.on_transfer != NULL && transfer_full(stage) && transfer_out(stage, p))
+        pathway.num_transferred++;
+    else
+        enqueue(stage, p);
+}
+
+/* Stage starts, selected once per stage at compile time. */
+
+static void schedule_completion(struct stage *stage, int p, float duration) /* Event for the end of service */
+{
+    struct patient *patient = &pathway.patients[p];
+
+    if (stage->ends_patience && patient->patience != 0)
+    {
+        event_cancel_handle(patient->patience);
+        patient->patience = 0;
+    }
+    patient->severity = -INFINITY;
+    transfer[ATTR_PATIENT] = p;
+    event_schedule(sim_time + duration, stage->type);
+    if (pathway.on_schedule != NULL)
+        pathway.on_schedule(stage, p, duration);
+}
+
+static void start_service(struct stage *stage, int p) /* Start a service stage */
+{
+    float duration = sample_duration(&stage->duration, stage->stream);
+
+    if (stage->observed)
+        sampst_update(duration, stage->durations);
+    seize(stage, p);
+    schedule_completion(stage, p, fmaxf(duration, pathway.min_duration));
+}
+
+static void start_fast_track(struct stage *stage, int p) /* Start a stage severe patients skip */
+{
+    if (pathway.patients[p].severity < stage->threshold_severity)
+    {
+        start_service(stage, p);
+        return;
+    }
+    seize(stage, p);
+    schedule_completion(stage, p, pathway.min_duration);
+}
+
+static void start_admission(struct stage *stage, int p) /* Admit an arrival and move it on */
+{
+    seize(stage, p);
+    enter(&pathway.stages[stage->next], p);
+}
+
+static void start_exit(struct stage *stage, int p) /* Patient leaves the pathway */
+{
+    release(stage, p);
+    if (pathway.patients[p].patience != 0)
+        event_cancel_handle(pathway.patients[p].patience);
+    pathway.num_completed++;
+    free_patient(p);
+}
+
+/* Event handlers, selected once per stage at compile time. */
+
+static void schedule_arrival(struct stage *stage) /* Schedule the next arrival from the source */
+{
+    char  error_msg[CONFIG_LINE_LIMIT + 100];
+    float interarrival;
+
+    if (stage->trace.path == NULL)
+    {
+        interarrival = sample_duration(&stage->duration, stage->stream);
+        if (stage->observed)
+            sampst_update(interarrival, stage->durations);
+        event_schedule(sim_time + interarrival, stage->type);
+        if (pathway.on_schedule != NULL)
+            pathway.on_schedule(stage, 0, interarrival);
+        return;
+    }
+    switch (trace_next(&stage->trace, stage->name, MAX_ACUITY, error_msg, sizeof(error_msg)))
+    {
+    case 1:
+        event_schedule(stage->trace.at.time, stage->type);
+        if (pathway.on_schedule != NULL)
+            pathway.on_schedule(stage, 0, stage->trace.at.time - sim_time);
+        break;
+    case -1:
+        pathway.on_error(error_msg, 13);
+        break;
+    }
+}
+
+static void complete_arrival(struct stage *stage) /* Arrival event */
+{
+    struct patient *patient;
+    int    p, acuity;
+    float  patience;
+
+    /* Schedule the next arrival from this source */
+    acuity = stage->trace.at.acuity;
+    schedule_arrival(stage);
+
+    /* Create the patient, with an acuity and a patience timer if configured */
+    p = new_patient();
+    patient = &pathway.patients[p];
+    if (acuity > 0)
+        patient->acuity = acuity;
+    else if (stage->acuity.num_outcomes > 0)
+        patient->acuity = route_sample(&stage->acuity, stage->stream);
+    pathway.arrivals[patient->acuity]++;
+
+    /* While diverting, the arrival goes elsewhere;  a longest wait has grown
+       since it was last looked at. */
+    if (stage->diverts)
+    {
+        if (pathway.waits != 0)
+            update_diverting(pathway.waits);
+        if (pathway.diverting && stage->diverts == DIVERT_AWAY)
+        {
+            free_patient(p);
+            pathway.num_diverted++;
+            return;
+        }
+        if (pathway.diverting && pathway.on_transfer != NULL && transfer_out(stage, p))
+        {
+            pathway.num_diverted++;
+            return;
+        }
+    }
+    if (pathway.patience[patient->acuity].dist != 0)
+    {
+        transfer[ATTR_PATIENT] = p;
+        patience = sample_duration(&pathway.patience[patient->acuity], stage->stream);
+        patient->patience = event_schedule(sim_time + patience, pathway.num_stages + 1);
+        if (pathway.on_schedule != NULL)
+            pathway.on_schedule(&pathway.stages[pathway.num_stages + 1], p, patience);
+    }
+
+    enter(stage, p);
+}
+
+static void board(struct stage *stage, int p, struct stage *next) /* Enter the next stage, keeping the held units */
+{
+    int i, j;
+
+    /* A next stage seizing a kept resource would wait on itself */
+    for (i = 0; i < stage->num_hold; i++)
+    {
+        for (j = 0; j < next->num_seize; j++)
+        {
+            if (next->seize[j] == stage->hold[i])
+            {
+                unhold(stage, p);
+                enter(next, p);
+                for (i = 0; i < stage->num_hold; i++)
+                    wake(stage->hold[i]);
+                return;
+            }
+        }
+    }
+    pathway.patients[p].boarding = stage->type;
+    pathway.patients[p].boarded  = sim_time;
+    enter(next, p);
+}
+
+static void complete_fixed(struct stage *stage) /* Completion of a stage with one successor */
+{
+    int p = (int) transfer[ATTR_PATIENT];
+
+    release(stage, p);
+    if (stage->samples_severity)
+        pathway.patients[p].severity = normal(stage->mean_severity, stage->stream);
+    if (stage->num_hold > 0)
+        board(stage, p, &pathway.stages[stage->next]);
+    else
+        enter(&pathway.stages[stage->next], p);
+}
+
+static void complete_routed(struct stage *stage) /* Completion of a stage with routed successors */
+{
+    int p = (int) transfer[ATTR_PATIENT];
+    struct stage *next;
+
+    release(stage, p);
+    if (stage->samples_severity)
+        pathway.patients[p].severity = normal(stage->mean_severity, stage->stream);
+    next = &pathway.stages[route_sample(&stage->route, stage->stream)];
+    if (stage->num_hold > 0)
+        board(stage, p, next);
+    else
+        enter(next, p);
+}
+
+static void expire_patience(struct stage *stage) /* Patience timer event */
+{
+    int p = (int) transfer[ATTR_PATIENT];
+
+    (void) stage;
+    pathway.patients[p].patience = 0;
+    if (pathway.patients[p].waiting != 0)
+        abandon(p);
+    else
+        pathway.patients[p].impatient = 1;
+}
+
+/* Compilation. */
+
+static int parse_number(const char *text, float *value) /* Literal or $parameter */
+{
+    char *end;
+    int   i;
+
+    if (*text == '$')
+    {
+        for (i = 0; i < compile_num_params; i++)
+        {
+            if (strcmp(compile_params[i].name, text + 1) == 0)
+            {
+                *value = compile_params[i].value;
+                return 0;
+            }
+        }
+        return -1;
+    }
+    *value = strtod(text, &end);
+    return (end == text || *end != '\0') ? -1 : 0;
+}
+
+static int param_index(const char *text) /* Parameter a number refers to, 1-based, or 0 */
+{
+    int i;
+
+    for (i = 0; *text == '$' && i < compile_num_params; i++)
+    {
+        if (strcmp(compile_params[i].name, text + 1) == 0)
+            return i + 1;
+    }
+    return 0;
+}
+
+static int get_number(struct config_section *section, const char *key, float *value, int required) /* Numeric key */
+{
+    char *text = config_value(compile_cfg, section, key);
+
+    if (text == NULL)
+    {
+        if (!required) return 1;
+        printf("CONFIG ERROR: %s:%d: [%s %s] Needs \"%s\"\n",
+               compile_cfg->origin, section->line, section->type, section->name, key);
+        return -1;
+    }
+    if (parse_number(text, value) != 0)
+    {
+        printf("CONFIG ERROR: %s:%d: \"%s\" Is Not A Number Or Known Parameter\n",
+               compile_cfg->origin, section->line, text);
+        return -1;
+    }
+    return 0;
+}
+
+static char *get_string(struct config_section *section, const char *key, char *fallback) /* String key */
+{
+    char *text = config_value(compile_cfg, section, key);
+
+    return strdup(text != NULL ? text : fallback);
+}
+
+static int find_stage(const char *name) /* Stage index by name, 0 if unknown */
+{
+    int i;
+
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        if (strcmp(stage_names[i], name) == 0)
+            return i;
+    }
+    return 0;
+}
+
+static int parse_duration(struct config_section *section, const char *text, struct duration *d) /* "dist arg [arg]" */
+{
+    static const char *dists[] = {"", "constant", "expon", "normal", "uniform", "erlang"};
+    static const int   num_args[] = {0, 1, 1, 1, 2, 2};
+    char  copy[CONFIG_LINE_LIMIT], *word, *args[3];
+    int   n;
+    float value[2];
+
+    strncpy(copy, text, CONFIG_LINE_LIMIT - 1);
+    copy[CONFIG_LINE_LIMIT - 1] = '\0';
+    for (n = 0, word = strtok(copy, " \t"); word != NULL && n < 3; word = strtok(NULL, " \t"))
+        args[n++] = word;
+
+    for (d->dist = DIST_ERLANG; d->dist > 0; d->dist--)
+    {
+        if (n > 0 && strcmp(args[0], dists[d->dist]) == 0) break;
+    }
+    if (d->dist == 0 || n - 1 != num_args[d->dist] ||
+        parse_number(args[1], &value[0]) != 0 ||
+        (n == 3 && parse_number(args[2], &value[1]) != 0))
+    {
+        printf("CONFIG ERROR: %s:%d: [%s %s] Bad Duration \"%s\"\n",
+               compile_cfg->origin, section->line, section->type, section->name, text);
+        return -1;
+    }
+
+    /* Erlang is written "erlang phases mean" to match simlib's erlang() */
+    d->a = (d->dist == DIST_ERLANG) ? value[1] : value[0];
+    d->b = (d->dist == DIST_ERLANG) ? value[0] : (n == 3 ? value[1] : 0);
+    d->param = (d->dist == DIST_UNIFORM) ? 0 : param_index(args[n - 1]);
+    if ((d->dist == DIST_ERLANG && d->b < 1) || (d->dist == DIST_EXPON && d->a <= 0))
+    {
+        printf("CONFIG ERROR: %s:%d: [%s %s] Bad Duration \"%s\"\n",
+               compile_cfg->origin, section->line, section->type, section->name, text);
+        return -1;
+    }
+    return 0;
+}
+
+static int parse_resources(struct config_section *section, const char *key, int *num, int **lists) /* Resource name list */
+{
+    char   copy[CONFIG_LINE_LIMIT], *word, *text;
+    struct resource *resource;
+
+    *num = 0;
+    *lists = (int *) calloc(pathway.num_resources + 1, sizeof(int));
+    if ((text = config_value(compile_cfg, section, key)) == NULL)
+        return 0;
+
+    strncpy(copy, text, CONFIG_LINE_LIMIT - 1);
+    copy[CONFIG_LINE_LIMIT - 1] = '\0';
+    for (word = strtok(copy, " \t,"); word != NULL; word = strtok(NULL, " \t,"))
+    {
+        if ((resource = pathway_resource(word)) == NULL)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Unknown Resource \"%s\"\n",
+                   compile_cfg->origin, section->line, section->name, word);
+            return -1;
+        }
+        if (*num == pathway.num_resources)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Too Many Resources In \"%s\"\n",
+                   compile_cfg->origin, section->line, section->name, key);
+            return -1;
+        }
+        (*lists)[(*num)++] = resource->list;
+    }
+    return 0;
+}
+
+static int compile_resource(struct config_section *section, struct resource *resource) /* One [resource] */
+{
+    char  label[CONFIG_LINE_LIMIT], *text;
+    float value;
+    int   i;
+
+    for (i = 0; section->name[i] != '\0' && i < CONFIG_LINE_LIMIT - 1; i++)
+        label[i] = (section->name[i] == '_') ? ' ' : toupper((unsigned char)section->name[i]);
+    label[i] = '\0';
+
+    resource->name  = strdup(section->name);
+    resource->title = get_string(section, "title", section->name);
+    resource->unit  = get_string(section, "unit", "units");
+    resource->label = get_string(section, "label", label);
+
+    if (get_number(section, "capacity", &value, 1) != 0)
+        return -1;
+    resource->capacity = (int) value;
+    resource->param    = param_index(config_value(compile_cfg, section, "capacity"));
+    resource->abort_when_full = 0;
+    if ((text = config_value(compile_cfg, section, "on_full")) != NULL)
+    {
+        if (strcmp(text, "abort") == 0)
+            resource->abort_when_full = 1;
+        else if (strcmp(text, "transfer") == 0)
+            resource->transfer_when_full = 1;
+        else if (strcmp(text, "wait") != 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [resource %s] \"on_full\" Must Be wait, abort Or transfer\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+    }
+    resource->error_code = 14;
+    if ((i = get_number(section, "error_code", &value, 0)) < 0)
+        return -1;
+    if (i == 0)
+        resource->error_code = (int) value;
+    return 0;
+}
+
+static int compile_stage(struct config_section *section, struct stage *stage) /* One [stage] */
+{
+    struct config_section *route, *acuity;
+    char  *text;
+    float  value;
+    int    status, i, j;
+
+    stage->name = strdup(section->name);
+    stage->kind = STAGE_SERVICE;
+    if ((text = config_value(compile_cfg, section, "type")) != NULL)
+    {
+        if (strcmp(text, "arrival") == 0)      stage->kind = STAGE_ARRIVAL;
+        else if (strcmp(text, "service") == 0) stage->kind = STAGE_SERVICE;
+        else if (strcmp(text, "exit") == 0)    stage->kind = STAGE_EXIT;
+        else
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Unknown Type \"%s\"\n",
+                   compile_cfg->origin, section->line, section->name, text);
+            return -1;
+        }
+    }
+
+    if (parse_resources(section, "seize", &stage->num_seize, &stage->seize) != 0 ||
+        parse_resources(section, "release", &stage->num_release, &stage->release) != 0)
+        return -1;
+
+    /* Starting a stage marked "seen" cancels the patient's patience timer. */
+    text = config_value(compile_cfg, section, "seen");
+    stage->ends_patience = (text != NULL && strcmp(text, "yes") == 0);
+    stage->diverts = 0;
+    if ((text = config_value(compile_cfg, section, "divert")) != NULL)
+    {
+        if (strcmp(text, "site") == 0)      stage->diverts = DIVERT_SITE;
+        else if (strcmp(text, "away") == 0) stage->diverts = DIVERT_AWAY;
+        else if (strcmp(text, "no") != 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] \"divert\" Must Be no, site Or away\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+    }
+    if (stage->diverts && stage->kind != STAGE_ARRIVAL)
+    {
+        printf("CONFIG ERROR: %s:%d: [stage %s] Only Arrivals Divert\n",
+               compile_cfg->origin, section->line, section->name);
+        return -1;
+    }
+
+    /* A service may keep some of what it releases until the next stage starts. */
+    if (parse_resources(section, "hold", &stage->num_hold, &stage->hold) != 0)
+        return -1;
+    if (stage->num_hold > 0 && stage->kind != STAGE_SERVICE)
+    {
+        printf("CONFIG ERROR: %s:%d: [stage %s] Only Services Hold\n",
+               compile_cfg->origin, section->line, section->name);
+        return -1;
+    }
+    for (i = 0; i < stage->num_hold; i++)
+    {
+        for (j = 0; j < stage->num_release && stage->release[j] != stage->hold[i]; j++)
+            ;
+        if (j == stage->num_release)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Held Resource \"%s\" Is Not Released\n",
+                   compile_cfg->origin, section->line, section->name,
+                   pathway.resources[stage->hold[i]].name);
+            return -1;
+        }
+    }
+    if (stage->num_hold > 0)
+        pathway.has_boarding = 1;
+
+    /* Exits have no duration and no successor. */
+    if (stage->kind == STAGE_EXIT)
+    {
+        stage->start = start_exit;
+        pathway.dispatch[stage->type] = NULL;
+        return 0;
+    }
+
+    /* Arrivals take a rate or a trace, services a duration distribution. */
+    if (stage->kind == STAGE_ARRIVAL && (text = config_value(compile_cfg, section, "trace")) != NULL)
+    {
+        if (config_value(compile_cfg, section, "rate") != NULL)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Needs Exactly One Of \"rate\" Or \"trace\"\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+        if (trace_open(&stage->trace, text) != 0)
+            return -1;
+    }
+    else if (stage->kind == STAGE_ARRIVAL)
+    {
+        if (get_number(section, "rate", &value, 1) != 0)
+            return -1;
+        if (value <= 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Rate Must Be Positive\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+        stage->duration.dist  = DIST_EXPON;
+        stage->duration.a     = 1.0 / value;
+        stage->duration.param = param_index(config_value(compile_cfg, section, "rate"));
+
+        /* Arrivals may draw an acuity level from an [acuity stage] section. */
+        if ((acuity = config_find(compile_cfg, "acuity", section->name)) != NULL &&
+            route_load(&stage->acuity, compile_cfg, acuity, acuity_names, MAX_ACUITY, parse_number) != 0)
+            return -1;
+    }
+    else
+    {
+        if ((text = config_value(compile_cfg, section, "duration")) == NULL)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Needs \"duration\"\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+        if (parse_duration(section, text, &stage->duration) != 0)
+            return -1;
+    }
+
+    /* Optional severity draw on completion and fast track on entry. */
+    if ((status = get_number(section, "severity", &stage->mean_severity, 0)) < 0)
+        return -1;
+    stage->samples_severity = (status == 0);
+    if ((status = get_number(section, "fast_track", &stage->threshold_severity, 0)) < 0)
+        return -1;
+    stage->fast_track = (status == 0);
+    stage->start = (stage->kind == STAGE_ARRIVAL) ? start_admission :
+                   stage->fast_track ? start_fast_track : start_service;
+
+    /* Successor:  a fixed next stage or a [route] section over stage names. */
+    text  = config_value(compile_cfg, section, "next");
+    route = config_find(compile_cfg, "route", section->name);
+    if (text != NULL && route == NULL)
+    {
+        if ((stage->next = find_stage(text)) == 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [stage %s] Unknown Next Stage \"%s\"\n",
+                   compile_cfg->origin, section->line, section->name, text);
+            return -1;
+        }
+        pathway.dispatch[stage->type] = (stage->kind == STAGE_ARRIVAL) ? complete_arrival : complete_fixed;
+    }
+    else if (text == NULL && stage->kind == STAGE_SERVICE && route != NULL)
+    {
+        if (route_load(&stage->route, compile_cfg, route,
+                       stage_names, pathway.num_stages, parse_number) != 0)
+            return -1;
+        pathway.dispatch[stage->type] = complete_routed;
+    }
+    else
+    {
+        printf("CONFIG ERROR: %s:%d: [stage %s] Needs Exactly One Of \"next\" Or [route %s]%s\n",
+               compile_cfg->origin, section->line, section->name, section->name,
+               stage->kind == STAGE_ARRIVAL ? " (Arrivals Need \"next\")" : "");
+        return -1;
+    }
+    return 0;
+}
+
+static int compile_patience(struct config_section *section) /* The [patience] section */
+{
+    struct config_entry *entry;
+    struct duration      patience;
+    int    i, level;
+
+    for (i = section->first_entry; i < section->first_entry + section->num_entries; i++)
+    {
+        entry = &compile_cfg->entries[i];
+        patience.dist = 0;
+        if (strcmp(entry->value, "none") != 0 && parse_duration(section, entry->value, &patience) != 0)
+            return -1;
+
+        /* "default" covers every level without a key of its own */
+        if (strcmp(entry->key, "default") == 0)
+        {
+            for (level = 0; level <= MAX_ACUITY; level++)
+            {
+                if (config_value(compile_cfg, section, acuity_names[level]) == NULL || level == 0)
+                    pathway.patience[level] = patience;
+            }
+            continue;
+        }
+        for (level = 1; level <= MAX_ACUITY; level++)
+        {
+            if (strcmp(entry->key, acuity_names[level]) == 0) break;
+        }
+        if (level > MAX_ACUITY)
+        {
+            printf("CONFIG ERROR: %s:%d: [patience] Keys Are Acuity Levels 1-%d Or \"default\"\n",
+                   compile_cfg->origin, entry->line, MAX_ACUITY);
+            return -1;
+        }
+        pathway.patience[level] = patience;
+    }
+    pathway.has_patience = 1;
+    return 0;
+}
+
+static void compile_waiters(void) /* Precompute which stage queues each resource can unblock */
+{
+    struct resource *resource;
+    struct stage    *stage;
+    int    i, j, k, seen;
+
+    /* Without any stage marked "seen", starting any service ends patience */
+    for (i = 1, seen = 0; i <= pathway.num_stages; i++)
+        seen |= pathway.stages[i].ends_patience;
+    for (i = 1; i <= pathway.num_stages && !seen; i++)
+        pathway.stages[i].ends_patience = (pathway.stages[i].kind == STAGE_SERVICE);
+
+    for (i = 1; i <= pathway.num_resources; i++)
+    {
+        resource = &pathway.resources[i];
+        resource->waiters = (int *) calloc(pathway.num_stages, sizeof(int));
+        for (j = 1; j <= pathway.num_stages; j++)
+        {
+            stage = &pathway.stages[j];
+            for (k = 0; k < stage->num_seize && stage->seize[k] != resource->list; k++)
+                ;
+            if (k < stage->num_seize)
+            {
+                resource->waiters[resource->num_waiters++] = j;
+                stage->transfers |= resource->transfer_when_full;
+            }
+        }
+    }
+}
+
+static int compile_diversions(void) /* The [diversion] sections, or the default policy */
+{
+    struct config_section *section;
+    struct diversion *diversion;
+    struct resource  *resource;
+    char   copy[CONFIG_LINE_LIMIT], *text, *measure, *target;
+    int    i, status;
+
+    pathway.diversions = (struct diversion *) calloc(MAX_DIVERSIONS, sizeof(struct diversion));
+    pathway.num_diversions = 0;
+    for (i = 0; i < compile_cfg->num_sections; i++)
+    {
+        section = &compile_cfg->sections[i];
+        if (strcmp(section->type, "diversion") != 0)
+            continue;
+        if (pathway.num_diversions == MAX_DIVERSIONS)
+        {
+            printf("CONFIG ERROR: %s:%d: At Most %d [diversion] Sections\n",
+                   compile_cfg->origin, section->line, MAX_DIVERSIONS);
+            return -1;
+        }
+        diversion = &pathway.diversions[pathway.num_diversions++];
+        diversion->name = strdup(section->name);
+
+        /* "when" names what is watched:  occupancy of a resource, or the
+           queue or the longest wait of a stage. */
+        text = config_value(compile_cfg, section, "when");
+        strncpy(copy, text != NULL ? text : "", CONFIG_LINE_LIMIT - 1);
+        copy[CONFIG_LINE_LIMIT - 1] = '\0';
+        measure = strtok(copy, " \t");
+        target  = measure != NULL ? strtok(NULL, " \t") : NULL;
+        if (measure != NULL && target != NULL && strtok(NULL, " \t") == NULL)
+        {
+            if (strcmp(measure, "occupancy") == 0 && (resource = pathway_resource(target)) != NULL)
+            {
+                diversion->measure = DIVERT_OCCUPANCY;
+                diversion->target  = resource->list;
+            }
+            else if ((strcmp(measure, "queue") == 0 || strcmp(measure, "wait") == 0) &&
+                     (diversion->target = find_stage(target)) != 0)
+                diversion->measure = (measure[0] == 'q') ? DIVERT_QUEUE : DIVERT_WAIT;
+        }
+        if (diversion->measure == 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [diversion %s] \"when\" Must Be occupancy resource, queue stage Or wait stage\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+
+        /* Divert from start up, until below stop:  hysteresis when stop < start. */
+        if (get_number(section, "start", &diversion->start, 1) != 0 ||
+            (status = get_number(section, "stop", &diversion->stop, 0)) < 0)
+            return -1;
+        if (status == 1)
+            diversion->stop = diversion->start;
+        if (diversion->stop > diversion->start || diversion->stop <= 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [diversion %s] Needs 0 < stop <= start\n",
+                   compile_cfg->origin, section->line, section->name);
+            return -1;
+        }
+    }
+
+    /* By default a transfer resource that fills puts the department on diversion. */
+    if (pathway.num_diversions > 0)
+        return 0;
+    for (i = 1; i <= pathway.num_resources && pathway.num_diversions < MAX_DIVERSIONS; i++)
+    {
+        resource = &pathway.resources[i];
+        if (!resource->transfer_when_full)
+            continue;
+        diversion = &pathway.diversions[pathway.num_diversions++];
+        diversion->name    = strdup(resource->name);
+        diversion->measure = DIVERT_OCCUPANCY;
+        diversion->target  = resource->list;
+        diversion->start   = diversion->stop = resource->capacity;
+    }
+    return 0;
+}
+
+static void compile_watches(void) /* Index the diversion policies by what they watch */
+{
+    struct diversion *diversion;
+    int    i;
+
+    pathway.waits = 0;
+    for (i = 0; i < pathway.num_diversions; i++)
+    {
+        diversion = &pathway.diversions[i];
+        if (diversion->measure == DIVERT_OCCUPANCY)
+            pathway.resources[diversion->target].watched |= 1u << i;
+        else
+            pathway.stages[diversion->target].watched |= 1u << i;
+        if (diversion->measure == DIVERT_WAIT)
+            pathway.waits |= 1u << i;
+    }
+}
+
+int pathway_compile(struct config *cfg, struct param params[], int num_params) /* Build the pathway tables */
+{
+    struct config_section *patience;
+    int i, num_resources, num_stages, status;
+
+    pathway_free();
+    compile_cfg        = cfg;
+    compile_params     = params;
+    compile_num_params = num_params;
+
+    /* Size the tables. */
+    num_resources = num_stages = 0;
+    for (i = 0; i < cfg->num_sections; i++)
+    {
+        if (strcmp(cfg->sections[i].type, "resource") == 0) num_resources++;
+        if (strcmp(cfg->sections[i].type, "stage") == 0)    num_stages++;
+    }
+    if (num_stages == 0)
+    {
+        printf("CONFIG ERROR: %s: Need At Least 1 [stage] Section\n", cfg->origin);
+        return -1;
+    }
+
+    pathway.num_resources = num_resources;
+    pathway.num_stages    = num_stages;
+    pathway.resources     = (struct resource *) calloc(num_resources + 1, sizeof(struct resource));
+    pathway.stages        = (struct stage *)    calloc(num_stages + 2, sizeof(struct stage));
+    pathway.dispatch      = calloc(num_stages + 2, sizeof(*pathway.dispatch));
+    stage_names           = (const char **)     calloc(num_stages + 1, sizeof(char *));
+
+    /* Number resources and stages in file order, so names resolve forwards. */
+    num_resources = num_stages = 0;
+    for (i = 0; i < cfg->num_sections; i++)
+    {
+        if (strcmp(cfg->sections[i].type, "resource") == 0)
+        {
+            pathway.resources[++num_resources].name = cfg->sections[i].name;
+            pathway.resources[num_resources].list   = num_resources;
+        }
+        if (strcmp(cfg->sections[i].type, "stage") == 0)
+        {
+            stage_names[++num_stages]          = cfg->sections[i].name;
+            pathway.stages[num_stages].type    = num_stages;
+        }
+    }
+
+    /* Compile each section. */
+    status = 0;
+    pathway.has_boarding = 0;
+    num_resources = num_stages = 0;
+    for (i = 0; i < cfg->num_sections && status == 0; i++)
+    {
+        if (strcmp(cfg->sections[i].type, "resource") == 0)
+            status = compile_resource(&cfg->sections[i], &pathway.resources[++num_resources]);
+        if (strcmp(cfg->sections[i].type, "stage") == 0)
+            status = compile_stage(&cfg->sections[i], &pathway.stages[++num_stages]);
+    }
+
+    /* Patience timers are events of one more type, after the stages. */
+    memset(pathway.patience, 0, sizeof(pathway.patience));
+    pathway.has_patience = 0;
+    if (status == 0 && (patience = config_find(cfg, "patience", NULL)) != NULL)
+        status = compile_patience(patience);
+    pathway.stages[num_stages + 1].kind = STAGE_PATIENCE;
+    pathway.stages[num_stages + 1].type = num_stages + 1;
+    pathway.dispatch[num_stages + 1] = expire_patience;
+    if (status == 0)
+        compile_waiters();
+    if (status == 0)
+        status = compile_diversions();
+    if (status == 0)
+        compile_watches();
+
+    free(stage_names);
+    stage_names = NULL;
+    return status;
+}
+
+void pathway_size(void) /* Fit simlib's limits to the pathway, before init_simlib */
+{
+    /* A list per resource with the event list after them, a timest
+       variable per stage queue and a sampst variable per stage's durations. */
+    maxlist = pathway.num_resources + 1;
+    maxtvar = pathway.num_stages;
+    maxsvar = SVAR_DURATION(pathway.num_stages);
+    if (maxatr < 4) maxatr = 4;
+}
+
+void pathway_start(void) /* Schedule the first arrival from each source */
+{
+    int i;
+
+    pathway.num_completed = pathway.num_abandoned = 0;
+    pathway.num_transferred = pathway.num_diverted = pathway.num_received = 0;
+    pathway.active = 0;
+    pathway.diverting = pathway.num_episodes = 0;
+    pathway.diverting_since = pathway.diverting_time = 0;
+    memset(pathway.arrivals, 0, sizeof(pathway.arrivals));
+    memset(pathway.abandoned, 0, sizeof(pathway.abandoned));
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        memset(&pathway.stages[i].queue, 0, sizeof(struct queue));
+        pathway.stages[i].queue.tvar = timest_register(i);
+    }
+    for (i = 1; i <= pathway.num_resources; i++)
+        pathway.resources[i].id = list_register(pathway.resources[i].list);
+    pathway.boarding_time = sampst_register(SVAR_BOARDING);
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        if (pathway.stages[i].observed)
+            pathway.stages[i].durations = sampst_register(SVAR_DURATION(i));
+    }
+    free(pathway.patients);
+    free(pathway.held);
+    pathway.patients = NULL;
+    pathway.held = NULL;
+    pathway.max_patients = pathway.free_patient = 0;
+
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        if (pathway.stages[i].kind != STAGE_ARRIVAL)
+            continue;
+        if (pathway.stages[i].trace.path != NULL)
+            trace_rewind(&pathway.stages[i].trace);
+        schedule_arrival(&pathway.stages[i]);
+    }
+}
+
+struct resource *pathway_resource(const char *name) /* Resource by name, NULL if unknown */
+{
+    int i;
+
+    for (i = 1; i <= pathway.num_resources; i++)
+    {
+        if (strcmp(pathway.resources[i].name, name) == 0)
+            return &pathway.resources[i];
+    }
+    return NULL;
+}
+
+struct stage *pathway_stage(const char *name) /* Stage by name, NULL if unknown */
+{
+    int i;
+
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        if (strcmp(pathway.stages[i].name, name) == 0)
+            return &pathway.stages[i];
+    }
+    return NULL;
+}
+
+float pathway_mean_duration(const struct stage *stage) /* Expected duration, or interarrival time */
+{
+    switch (stage->duration.dist)
+    {
+        case DIST_UNIFORM:
+            return (stage->duration.a + stage->duration.b) / 2;
+        default:
+            return stage->duration.a;
+    }
+}
+
+int pathway_uses(int param) /* Capacities, means and rates the parameter sets */
+{
+    int i, n = 0;
+
+    for (i = 1; i <= pathway.num_resources; i++)
+        n += pathway.resources[i].param == param;
+    for (i = 1; i <= pathway.num_stages; i++)
+        n += pathway.stages[i].duration.param == param && pathway.stages[i].trace.path == NULL;
+    return n;
+}
+
+void pathway_adjust(int param, float value) /* Give the parameter a new value from now on */
+{
+    struct stage *stage;
+    int    i;
+
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        stage = &pathway.stages[i];
+        if (stage->duration.param == param && stage->trace.path == NULL)
+            stage->duration.a = (stage->kind == STAGE_ARRIVAL) ? 1.0 / value : value;
+    }
+    for (i = 1; i <= pathway.num_resources; i++)
+    {
+        if (pathway.resources[i].param != param)
+            continue;
+        pathway.resources[i].capacity = (int) value;
+        wake(i);
+    }
+}
+
+int pathway_receive(const struct patient *from, const unsigned char *units) /* Record for a patient from another site */
+{
+    struct patient *patient;
+    int    p;
+
+    /* The record waits, holding nothing yet, until pathway_admit */
+    p = new_patient();
+    patient = &pathway.patients[p];
+    patient->arrival_time = from->arrival_time;
+    patient->severity     = from->severity;
+    patient->acuity       = from->acuity;
+    patient->transferred  = 1;
+    patient->boarding     = from->boarding;
+    patient->boarded      = from->boarded;
+    memcpy(held(p), units, pathway.num_resources + 1);
+    return p;
+}
+
+void pathway_admit(int p, int stage) /* A transferred patient arrives at the stage */
+{
+    unsigned int watching = 0;
+    int    list, n;
+
+    /* Take up again the units held at the sending site, even over capacity;
+       patience timers do not carry over. */
+    for (list = 1; list <= pathway.num_resources; list++)
+    {
+        for (n = 0; n < held(p)[list]; n++)
+            list_file_id(FIRST, pathway.resources[list].id);
+        if (held(p)[list] > 0)
+            watching |= pathway.resources[list].watched;
+    }
+    pathway.num_received++;
+    if (watching != 0)
+        update_diverting(watching);
+    enter(&pathway.stages[stage], p);
+}
+
+void pathway_discard(int p) /* Drop a received patient who will not be admitted */
+{
+    free_patient(p);
+}
+
+void pathway_save(struct pathway_state *state) /* Copy the patients, queues and counts */
+{
+    int i, n = pathway.max_patients + 1;
+
+    state->patients = (struct patient *) realloc(state->patients, n * sizeof(struct patient));
+    state->held     = (unsigned char *) realloc(state->held, n * (pathway.num_resources + 1));
+    state->queues   = (struct queue *) realloc(state->queues, (pathway.num_stages + 2) * sizeof(struct queue));
+    if (pathway.max_patients > 0)
+    {
+        memcpy(state->patients, pathway.patients, n * sizeof(struct patient));
+        memcpy(state->held, pathway.held, n * (pathway.num_resources + 1));
+    }
+    state->traces   = (struct trace_position *) realloc(state->traces, (pathway.num_stages + 1) * sizeof(struct trace_position));
+    for (i = 1; i <= pathway.num_stages + 1; i++)
+        state->queues[i] = pathway.stages[i].queue;
+    for (i = 1; i <= pathway.num_stages; i++)
+        state->traces[i] = pathway.stages[i].trace.at;
+
+    state->max_patients    = pathway.max_patients;
+    state->free_patient    = pathway.free_patient;
+    state->num_completed   = pathway.num_completed;
+    state->num_abandoned   = pathway.num_abandoned;
+    memcpy(state->arrivals, pathway.arrivals, sizeof(pathway.arrivals));
+    memcpy(state->abandoned, pathway.abandoned, sizeof(pathway.abandoned));
+    state->active          = pathway.active;
+    state->diverting       = pathway.diverting;
+    state->num_episodes    = pathway.num_episodes;
+    state->diverting_since = pathway.diverting_since;
+    state->diverting_time  = pathway.diverting_time;
+    state->num_transferred = pathway.num_transferred;
+    state->num_diverted    = pathway.num_diverted;
+    state->num_received    = pathway.num_received;
+}
+
+void pathway_restore(const struct pathway_state *state) /* Return to a copy made by pathway_save */
+{
+    int i, n = state->max_patients + 1;
+
+    /* The pool shrinks back to its saved size, whose free list is complete. */
+    pathway.patients = (struct patient *) realloc(pathway.patients, n * sizeof(struct patient));
+    pathway.held     = (unsigned char *) realloc(pathway.held, n * (pathway.num_resources + 1));
+    if (state->max_patients > 0)
+    {
+        memcpy(pathway.patients, state->patients, n * sizeof(struct patient));
+        memcpy(pathway.held, state->held, n * (pathway.num_resources + 1));
+    }
+    for (i = 1; i <= pathway.num_stages + 1; i++)
+        pathway.stages[i].queue = state->queues[i];
+    for (i = 1; i <= pathway.num_stages; i++)
+        pathway.stages[i].trace.at = state->traces[i];
+
+    pathway.max_patients    = state->max_patients;
+    pathway.free_patient    = state->free_patient;
+    pathway.num_completed   = state->num_completed;
+    pathway.num_abandoned   = state->num_abandoned;
+    memcpy(pathway.arrivals, state->arrivals, sizeof(pathway.arrivals));
+    memcpy(pathway.abandoned, state->abandoned, sizeof(pathway.abandoned));
+    pathway.active          = state->active;
+    pathway.diverting       = state->diverting;
+    pathway.num_episodes    = state->num_episodes;
+    pathway.diverting_since = state->diverting_since;
+    pathway.diverting_time  = state->diverting_time;
+    pathway.num_transferred = state->num_transferred;
+    pathway.num_diverted    = state->num_diverted;
+    pathway.num_received    = state->num_received;
+}
+
+void pathway_state_free(struct pathway_state *state) /* Release a copy */
+{
+    free(state->patients);
+    free(state->held);
+    free(state->queues);
+    free(state->traces);
+    memset(state, 0, sizeof(*state));
+}
+
+void pathway_free(void) /* Release the pathway tables */
+{
+    int i;
+
+    for (i = 1; i <= pathway.num_resources && pathway.resources != NULL; i++)
+    {
+        if (pathway.resources[i].title == NULL) continue;
+        free(pathway.resources[i].name);
+        free(pathway.resources[i].title);
+        free(pathway.resources[i].unit);
+        free(pathway.resources[i].label);
+        free(pathway.resources[i].waiters);
+    }
+    for (i = 1; i <= pathway.num_stages && pathway.stages != NULL; i++)
+    {
+        if (pathway.stages[i].name == NULL) continue;
+        free(pathway.stages[i].name);
+        free(pathway.stages[i].seize);
+        free(pathway.stages[i].release);
+        free(pathway.stages[i].hold);
+        if (pathway.stages[i].route.num_outcomes > 0)
+            route_free(&pathway.stages[i].route);
+        if (pathway.stages[i].acuity.num_outcomes > 0)
+            route_free(&pathway.stages[i].acuity);
+        trace_close(&pathway.stages[i].trace);
+    }
+    for (i = 0; i < pathway.num_diversions; i++)
+        free(pathway.diversions[i].name);
+    free(pathway.diversions);
+    pathway.diversions = NULL;
+    pathway.num_diversions = 0;
+    free(pathway.resources);
+    free(pathway.stages);
+    free(pathway.dispatch);
+    free(pathway.patients);
+    free(pathway.held);
+    pathway.patients = NULL;
+    pathway.held = NULL;
+    pathway.max_patients = pathway.free_patient = 0;
+    pathway.resources = NULL;
+    pathway.stages = NULL;
+    pathway.dispatch = NULL;
+    pathway.num_resources = pathway.num_stages = 0;
+}
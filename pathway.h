@@ -0,0 +1,226 @@
+/* This is pathway.h.  Data-driven patient pathways.
+
+   A pathway is read from [resource name], [stage name] and [route name]
+   sections of a config file and compiled once into flat tables:  stage k is
+   described by stages[k], its completion events have event type k, and
+   dispatch[k] is the handler run when such an event reaches the head of the
+   event list.  Resource r is tracked by simlib list r and the queue of stage
+   k by timest variable k;  pathway_size sets simlib's limits to fit them.
+
+   Patients are records in a pooled array; events carry the patient index in
+   attribute ATTR_PATIENT.  A patient entering a stage whose resources are
+   busy waits in that stage's queue.  Patients may be given a patience timer
+   on arrival, which is cancelled once they are seen;  if it fires first they
+   leave without being seen (LWBS).
+
+   [diversion name] sections are policies that put the department on
+   diversion while a resource's occupancy, a stage's queue or its longest
+   wait is at or above a threshold, until it falls below another.  Each is
+   re-evaluated in O(1) when what it watches changes;  without any, the
+   department diverts while a resource with on_full = transfer is full.
+   Arrival stages with divert = away then send their patients out of the
+   model, and those with divert = site to another site of a network.
+
+   An arrival stage with a trace instead of a rate replays the arrival times
+   and acuities of a log (trace.h), keeping only its next arrival scheduled;
+   the stage stops arriving at the end of the log.
+
+   A stage may hold some of the resources it releases:  a patient who must
+   then wait for the next stage keeps them, boarding in the stage's queue,
+   until the next stage starts.  Boarding times go to sampst variable
+   SVAR_BOARDING.
+
+   When pathways run as sites of a network (network.h), a patient who finds a
+   resource with on_full = transfer full is also sent to another site.  The
+   network sets the on_transfer and on_divert hooks;  without them these
+   resources simply wait and divert = site arrivals are admitted.  The
+   on_schedule hook, when set, sees every arrival, completion and patience
+   event as it is scheduled, with the duration until it.  pathway_save and pathway_restore copy
+   the state of the patients alongside simlib_save, for a site that rolls
+   back.
+
+   pathway_adjust gives a parameter a new value in the middle of a run, for
+   the capacities, mean durations and arrival rates it sets:  draws after it
+   use the new means, a larger capacity starts waiting patients at once and
+   a smaller one lets the units in use above it finish. */
+
+#ifndef PATHWAY_H
+#define PATHWAY_H
+
+#include "simlib.h"
+#include "config.h"
+#include "routing.h"
+#include "trace.h"
+
+#define STAGE_ARRIVAL   1       /* Source of patients, reschedules itself. */
+#define STAGE_SERVICE   2       /* Seizes resources for a sampled duration. */
+#define STAGE_EXIT      3       /* Releases resources and counts the patient. */
+#define STAGE_PATIENCE  4       /* Pseudo-stage of patience timer events. */
+
+#define DIST_CONSTANT   1       /* a */
+#define DIST_EXPON      2       /* mean a */
+#define DIST_NORMAL     3       /* mean a, standard deviation 1 */
+#define DIST_UNIFORM    4       /* a to b */
+#define DIST_ERLANG     5       /* b phases, mean a */
+
+#define PATHWAY_NAME_LIMIT 48   /* Longest parameter name. */
+#define MAX_ACUITY      9       /* Acuity levels 1..MAX_ACUITY, 0 = unassigned. */
+#define ATTR_PATIENT    3       /* Event attribute holding the patient index. */
+#define SVAR_BOARDING   1       /* sampst variable of boarding times... */
+#define SVAR_DURATION(k) (SVAR_BOARDING + (k))  /* ...and of durations sampled by stage k. */
+
+#define DIVERT_OCCUPANCY 1      /* Units of a resource in use. */
+#define DIVERT_QUEUE     2      /* Patients waiting for a stage, e.g. boarders. */
+#define DIVERT_WAIT      3      /* Minutes its longest waiting patient has waited. */
+#define DIVERT_SITE      1      /* Arrival stages:  divert to another site... */
+#define DIVERT_AWAY      2      /* ...or out of the model. */
+#define MAX_DIVERSIONS  32      /* Diversion policies, one bit each. */
+
+struct duration {
+    int   dist;
+    float a, b;
+    int   param;                /* Parameter giving the mean (the rate, of arrivals), 1-based, or 0. */
+};
+
+struct resource {
+    char *name;
+    char *title;                /* Report wording, e.g. "Exam Rooms". */
+    char *unit;                 /* Report unit, e.g. "rooms". */
+    char *label;                /* Error wording, e.g. "EXAM ROOM". */
+    int   list;                 /* simlib list counting units in use... */
+    list_id id;                 /* ...registered by pathway_start. */
+    int   capacity;
+    int   param;                /* Parameter giving the capacity, 1-based, or 0. */
+    int   abort_when_full;      /* Stop the run instead of queueing. */
+    int   transfer_when_full;   /* Send patients to another site instead. */
+    int   error_code;           /* Exit status when capacity is exceeded. */
+    int   num_waiters, *waiters; /* Stages that seize this resource. */
+    unsigned int watched;       /* Bit i:  diversions[i] watches its occupancy. */
+};
+
+struct queue {
+    int   head, tail;           /* Patient indices, 0 when empty. */
+    int   length;
+    timest_var tvar;            /* timest variable tracking the length. */
+};
+
+struct patient {
+    float arrival_time;
+    float severity;             /* Drawn by the last stage, -INFINITY if none. */
+    event_handle patience;      /* Handle of the pending patience event, or 0. */
+    int   acuity;
+    int   waiting;              /* Stage whose queue holds the patient, or 0... */
+    float queued;               /* ...since this time. */
+    int   prev, next;           /* Queue links, next doubles as free list. */
+    int   impatient;            /* Patience ran out outside a queue. */
+    int   transferred;          /* Came from another site, is not sent on again. */
+    int   boarding;             /* Stage whose held resources the patient keeps... */
+    float boarded;              /* ...since this time. */
+};
+
+struct stage {
+    char  *name;
+    int    kind;
+    int    type;                /* Event type of this stage's completions. */
+    int    stream;              /* Random-number stream for this stage. */
+    struct duration duration;   /* Service time, or interarrival time. */
+    int    num_seize, *seize;   /* Lists filed into on entering the stage. */
+    int    num_release, *release; /* Lists removed from on completing it... */
+    int    num_hold, *hold;     /* ...but kept until the next stage starts. */
+    int    next;                /* Successor stage when there is no route. */
+    struct route route;         /* Successor distribution, codes are stages. */
+    int    samples_severity;    /* Draw a severity on completion... */
+    float  mean_severity;
+    int    fast_track;          /* ...which skips this stage's duration. */
+    float  threshold_severity;
+    int    ends_patience;       /* Starting the stage counts as being seen. */
+    int    transfers;           /* Seizes a resource with on_full = transfer. */
+    int    diverts;             /* Arrivals:  DIVERT_SITE or DIVERT_AWAY while diverting. */
+    struct route acuity;        /* Arrivals:  acuity level distribution... */
+    struct trace trace;         /* ...and times replayed from a log, if any. */
+    int    observed;            /* Record sampled durations in SVAR_DURATION(type). */
+    sampst_var durations;
+    struct queue queue;         /* Patients waiting for the resources. */
+    unsigned int watched;       /* Bit i:  diversions[i] watches its queue or wait. */
+    void (*start)(struct stage *stage, int patient);
+};
+
+struct diversion {
+    char  *name;
+    int    measure;             /* DIVERT_OCCUPANCY, DIVERT_QUEUE or DIVERT_WAIT... */
+    int    target;              /* ...of this resource list or stage. */
+    float  start, stop;         /* Divert from start up, until below stop. */
+};
+
+struct param {
+    char  name[PATHWAY_NAME_LIMIT];
+    float value;
+};
+
+struct pathway {
+    int              num_stages, num_resources;
+    struct stage    *stages;    /* stages[1..num_stages + 1], the last for patience */
+    struct resource *resources; /* resources[1..num_resources] */
+    void           (**dispatch)(struct stage *stage);
+    struct duration  patience[MAX_ACUITY + 1]; /* By acuity, dist 0 = none. */
+    int              has_patience;
+    int              has_boarding;  /* A stage holds resources. */
+    sampst_var       boarding_time;
+    struct patient  *patients;  /* patients[1..max_patients], 0 is unused. */
+    unsigned char   *held;      /* Units of resources 1..num_resources held by
+                                   each patient, num_resources + 1 per patient. */
+    int              max_patients, free_patient;
+    float            min_duration;
+    int              num_completed, num_abandoned;
+    int              arrivals[MAX_ACUITY + 1], abandoned[MAX_ACUITY + 1];
+    struct diversion *diversions;
+    int              num_diversions;
+    unsigned int     active;     /* Bit i:  diversions[i] holds. */
+    unsigned int     waits;      /* Bit i:  diversions[i] watches a longest wait. */
+    int              diverting;  /* Any does. */
+    float            diverting_since, diverting_time;   /* Minutes on diversion. */
+    int              num_episodes;
+    int              num_transferred, num_diverted, num_received;
+    void           (*on_error)(char *msg, int code);
+    int            (*on_transfer)(int stage, const struct patient *patient, const unsigned char *held);
+    void           (*on_divert)(int diverting);
+    void           (*on_schedule)(struct stage *stage, int patient, float duration);
+};
+
+extern SIMLIB_LOCAL struct pathway pathway;
+
+struct pathway_state {          /* Copy of the patients, queues and counts. */
+    struct patient *patients;
+    unsigned char  *held;
+    struct queue   *queues;     /* Of stages 1..num_stages + 1. */
+    struct trace_position *traces;  /* Of stages 1..num_stages. */
+    int    max_patients, free_patient;
+    int    num_completed, num_abandoned;
+    int    arrivals[MAX_ACUITY + 1], abandoned[MAX_ACUITY + 1];
+    unsigned int active;
+    int    diverting, num_episodes, num_transferred, num_diverted, num_received;
+    float  diverting_since, diverting_time;
+};
+
+extern int   pathway_compile(struct config *cfg, struct param params[], int num_params);
+extern void  pathway_size(void);
+extern void  pathway_start(void);
+extern void  pathway_free(void);
+extern struct resource *pathway_resource(const char *name);
+extern struct stage    *pathway_stage(const char *name);
+extern float pathway_mean_duration(const struct stage *stage);
+extern int   pathway_uses(int param);
+extern void  pathway_adjust(int param, float value);
+extern int   pathway_receive(const struct patient *from, const unsigned char *held);
+extern void  pathway_admit(int patient, int stage);
+extern void  pathway_discard(int patient);
+extern void  pathway_save(struct pathway_state *state);
+extern void  pathway_restore(const struct pathway_state *state);
+extern void  pathway_state_free(struct pathway_state *state);
+
+static inline void pathway_dispatch(void) /* Run the handler for the current event */
+{
+    pathway.dispatch[next_event_type](&pathway.stages[next_event_type]);
+}
+
+#endif
@@ -0,0 +1,121 @@
+/* This is process.c.  Stackless coroutines on simlib, described in process.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "process.h"
+
+SIMLIB_LOCAL struct processes processes;
+
+void process_init(size_t frame_size, int event_type) /* Frames of this size, resumed by events of this type */
+{
+    process_free();
+    processes.frame_size = frame_size < sizeof(struct process) ? sizeof(struct process) :
+                           (frame_size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    processes.event_type = event_type;
+}
+
+static void grow(void) /* Add a chunk of free frames to the pool */
+{
+    int first = processes.num_chunks * PROCESS_CHUNK, i;
+
+    processes.chunks = (char **) realloc(processes.chunks, (processes.num_chunks + 1) * sizeof(char *));
+    processes.chunks[processes.num_chunks++] = (char *) malloc(PROCESS_CHUNK * processes.frame_size);
+    for (i = first + PROCESS_CHUNK - 1; i >= first; i--)
+    {
+        process_frame(i)->next = processes.free;
+        processes.free = i + 1;
+    }
+}
+
+static void schedule(struct process *self, float time) /* Resume the process at this time */
+{
+    transfer[ATTR_PROCESS] = self->id;
+    event_schedule(time, processes.event_type);
+}
+
+struct process *process_start(void (*body)(struct process *self), float delay)
+{
+
+/* Take a zeroed frame from the pool for a new process running body, which
+   starts after delay.  The caller may fill in the rest of the frame before
+   then. */
+
+    struct process *self;
+    int    id;
+
+    if (processes.free == 0)
+        grow();
+    id = processes.free - 1;
+    self = process_frame(id);
+    processes.free = self->next;
+    memset(self, 0, processes.frame_size);
+    self->id   = id;
+    self->body = body;
+    processes.alive++;
+    schedule(self, sim_time + delay);
+    return self;
+}
+
+void process_delay(struct process *self, float delay) /* Resume after delay */
+{
+    schedule(self, sim_time + delay);
+}
+
+int process_seize(struct process *self, struct process_resource *resource)
+{
+
+/* Take a unit of the resource.  Returns 1 when one was free;  otherwise the
+   process joins the queue and returns 0, to be resumed holding a unit. */
+
+    if (resource->in_use < resource->capacity && resource->length == 0)
+    {
+        resource->in_use++;
+        if (resource->busy.id != 0)
+            timest_update(resource->in_use, resource->busy);
+        return 1;
+    }
+    self->next = 0;
+    if (resource->tail != 0)
+        process_frame(resource->tail - 1)->next = self->id + 1;
+    else
+        resource->head = self->id + 1;
+    resource->tail = self->id + 1;
+    resource->length++;
+    return 0;
+}
+
+void process_release(struct process_resource *resource) /* Return a unit, to the first waiter if any */
+{
+    struct process *waiter;
+
+    if (resource->length == 0)
+    {
+        resource->in_use--;
+        if (resource->busy.id != 0)
+            timest_update(resource->in_use, resource->busy);
+        return;
+    }
+    waiter = process_frame(resource->head - 1);
+    resource->head = waiter->next;
+    if (resource->head == 0)
+        resource->tail = 0;
+    resource->length--;
+    schedule(waiter, sim_time);
+}
+
+void process_end(struct process *self) /* Return the frame to the pool */
+{
+    self->next = processes.free;
+    processes.free = self->id + 1;
+    processes.alive--;
+}
+
+void process_free(void) /* Release the pool;  no process may be pending */
+{
+    int i;
+
+    for (i = 0; i < processes.num_chunks; i++)
+        free(processes.chunks[i]);
+    free(processes.chunks);
+    memset(&processes, 0, sizeof(processes));
+}
@@ -0,0 +1,116 @@
+/* This is process.h.  Process interaction on simlib:  stackless coroutines.
+
+   A process is a function that runs as a coroutine, seizing, delaying and
+   releasing, with everything it must remember across these kept in its
+   frame:  a struct beginning with struct process, followed by the model's
+   own fields.  Between PROCESS_BEGIN and PROCESS_END, PROCESS_DELAY and
+   PROCESS_SEIZE save the place reached in the frame and return;  the next
+   call jumps back to it through a switch.  Local variables therefore do not
+   survive them, the frame's fields do, and no two of them may share a line.
+
+       struct visit { struct process process; float severity; };
+
+       static void patient(struct process *self)
+       {
+           struct visit *visit = (struct visit *) self;
+
+           PROCESS_BEGIN(self);
+           PROCESS_SEIZE(self, &nurses);
+           visit->severity = normal(3, 1);
+           PROCESS_DELAY(self, expon(10, 1));
+           process_release(&nurses);
+           PROCESS_END(self);
+       }
+
+   Processes are resumed by simlib's event list, through events of a single
+   type carrying the frame's index in attribute ATTR_PROCESS, so the event
+   loop takes the process events with process_resume and may handle others
+   of its own.  Frames all have the size given to process_init, come from a
+   pool of chunks that is only ever grown, and are linked into its free list
+   on exit, so starting a process costs no allocation once the pool has
+   grown to the most processes alive at once, and a frame never moves.
+
+   A resource is a count of units with a FIFO queue of processes waiting for
+   one.  Releasing a unit hands it to the first waiter, which resumes at the
+   same time through an event of its own rather than inside the releasing
+   process. */
+
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <stddef.h>
+#include "simlib.h"
+
+#define ATTR_PROCESS    3       /* Event attribute holding the frame index;  maxatr >= 4. */
+#define PROCESS_CHUNK   1024    /* Frames per chunk of the pool. */
+
+struct process {
+    int   state;                /* Place to resume at, 0 before the first run. */
+    int   id;                   /* Index of the frame in the pool. */
+    int   next;                 /* Next waiter for a resource, or next free frame. */
+    void (*body)(struct process *self);
+};
+
+struct process_resource {
+    int   capacity, in_use;
+    int   head, tail;           /* Waiting processes, frame index + 1, 0 when none. */
+    int   length;
+    timest_var busy;            /* timest variable of the units in use, id 0 for none. */
+};
+
+struct processes {
+    size_t frame_size;          /* Bytes per frame, 0 before process_init. */
+    int    event_type;          /* Event type resuming processes. */
+    int    num_chunks;
+    char **chunks;              /* PROCESS_CHUNK frames each. */
+    int    free;                /* First free frame index + 1, 0 when none. */
+    int    alive;               /* Processes started and not yet ended. */
+};
+
+extern SIMLIB_LOCAL struct processes processes;
+
+extern void  process_init(size_t frame_size, int event_type);
+extern struct process *process_start(void (*body)(struct process *self), float delay);
+extern void  process_delay(struct process *self, float delay);
+extern int   process_seize(struct process *self, struct process_resource *resource);
+extern void  process_release(struct process_resource *resource);
+extern void  process_end(struct process *self);
+extern void  process_free(void);
+
+static inline struct process *process_frame(int id) /* Frame by index */
+{
+    return (struct process *) (processes.chunks[id / PROCESS_CHUNK] +
+                               (size_t) (id % PROCESS_CHUNK) * processes.frame_size);
+}
+
+static inline void process_resume(void) /* Run the process of the current event up to its next wait */
+{
+    struct process *self = process_frame((int) transfer[ATTR_PROCESS]);
+
+    self->body(self);
+}
+
+/* Coroutine bodies.  Each wait records the line it is on as the place to
+   resume at, and returns from the body.  A seize that gets its unit at once
+   falls through to that place, which compilers warning of implicit
+   fallthrough are told is intended. */
+
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define PROCESS_FALLTHROUGH         __attribute__((fallthrough))
+#endif
+#endif
+#ifndef PROCESS_FALLTHROUGH
+#define PROCESS_FALLTHROUGH         ((void) 0)
+#endif
+
+#define PROCESS_BEGIN(self)         switch ((self)->state) { case 0:
+#define PROCESS_END(self)           } process_end(self)
+#define PROCESS_DELAY(self, delay)  do { (self)->state = __LINE__; process_delay((self), (delay)); \
+                                         return; case __LINE__:; } while (0)
+#define PROCESS_SEIZE(self, resource) \
+                                    do { (self)->state = __LINE__; \
+                                         if (!process_seize((self), (resource))) return; \
+                                         PROCESS_FALLTHROUGH; case __LINE__:; } while (0)
+
+#endif
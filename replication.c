@@ -0,0 +1,246 @@
+/* This is replication.c.  Replicated runs and their estimates, described in
+   replication.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "replication.h"
+
+SIMLIB_LOCAL struct replications replications;
+
+int replications_load(struct config *cfg, struct config_section *section) /* The [replications] section, or none */
+{
+    char   copy[CONFIG_LINE_LIMIT], *text, *end, *word;
+    int    units;
+
+    replications_free();
+    if (section == NULL)
+        return 0;
+
+    if ((text = config_value(cfg, section, "runs")) == NULL ||
+        (replications.runs = strtol(text, &end, 10), end == text || *end != '\0') || replications.runs < 2)
+    {
+        printf("CONFIG ERROR: %s:%d: [replications] Needs \"runs\" Of At Least 2\n", cfg->origin, section->line);
+        replications.runs = 1;
+        return -1;
+    }
+    text = config_value(cfg, section, "antithetic");
+    replications.antithetic = (text != NULL && strcmp(text, "yes") == 0);
+    if (replications.antithetic && replications.runs % 2 != 0)
+    {
+        printf("CONFIG ERROR: %s:%d: [replications] Antithetic \"runs\" Must Be Even\n", cfg->origin, section->line);
+        replications.runs = 1;
+        return -1;
+    }
+
+    if ((text = config_value(cfg, section, "controls")) != NULL)
+    {
+        strncpy(copy, text, CONFIG_LINE_LIMIT - 1);
+        copy[CONFIG_LINE_LIMIT - 1] = '\0';
+        for (word = strtok(copy, " \t,"); word != NULL; word = strtok(NULL, " \t,"))
+        {
+            if (replications.num_controls == MAX_CONTROLS)
+            {
+                printf("CONFIG ERROR: %s:%d: [replications] Too Many Controls\n", cfg->origin, section->line);
+                replications.runs = 1;
+                return -1;
+            }
+            replications.control_names[replications.num_controls++] = strdup(word);
+        }
+    }
+
+    /* The regression needs a degree of freedom left over. */
+    units = replications.antithetic ? replications.runs / 2 : replications.runs;
+    if (units < replications.num_controls + 2)
+    {
+        printf("CONFIG ERROR: %s:%d: [replications] %d Controls Need At Least %d %s\n", cfg->origin, section->line,
+               replications.num_controls, replications.num_controls + 2,
+               replications.antithetic ? "Antithetic Pairs" : "Runs");
+        replications.runs = 1;
+        return -1;
+    }
+    return 0;
+}
+
+void replications_start(int num_outputs) /* Make room for the outputs of every run */
+{
+    replications.num_outputs = num_outputs;
+    replications.outputs  = (double *) realloc(replications.outputs,
+                                               replications.runs * num_outputs * sizeof(double));
+    replications.controls = (double *) realloc(replications.controls,
+                                               replications.runs * (replications.num_controls + 1) * sizeof(double));
+}
+
+void replications_record(int run, const double outputs[], const double controls[]) /* Outputs and controls of one run */
+{
+    memcpy(&replications.outputs[run * replications.num_outputs], outputs,
+           replications.num_outputs * sizeof(double));
+    memcpy(&replications.controls[run * replications.num_controls], controls,
+           replications.num_controls * sizeof(double));
+}
+
+double t_quantile(int dof)
+{
+
+/* Upper 2.5% point of Student's t:  from a table up to T_TABLE_DOF degrees
+   of freedom, where the Cornish-Fisher expansion is too small (9.71 for
+   12.71 at one), and by the expansion above. */
+
+    static const double table[T_TABLE_DOF + 1] = {
+        0,        12.706205, 4.302653, 3.182446, 2.776445, 2.570582,
+        2.446912, 2.364624,  2.306004, 2.262157, 2.228139, 2.200985,
+        2.178813, 2.160369,  2.144787, 2.131450, 2.119905, 2.109816,
+        2.100922, 2.093024,  2.085963, 2.079614, 2.073873, 2.068658,
+        2.063899, 2.059539,  2.055529, 2.051831, 2.048407, 2.045230,
+        2.042272};
+    double z = 1.959963985, z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z, v = dof;
+
+    if (dof >= 1 && dof <= T_TABLE_DOF)
+        return table[dof];
+    return z + (z3 + z) / (4 * v) + (5 * z5 + 16 * z3 + 3 * z) / (96 * v * v) +
+           (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * v * v * v);
+}
+
+static int solve(double a[MAX_CONTROLS][MAX_CONTROLS + 1], int n) /* Gaussian elimination, answer in a[i][n] */
+{
+    double factor, swap;
+    int    i, j, k, pivot;
+
+    for (k = 0; k < n; k++)
+    {
+        for (pivot = k, i = k + 1; i < n; i++)
+        {
+            if (fabs(a[i][k]) > fabs(a[pivot][k]))
+                pivot = i;
+        }
+        if (fabs(a[pivot][k]) < 1e-12)
+            return -1;
+        for (j = k; j <= n; j++)
+        {
+            swap = a[k][j];  a[k][j] = a[pivot][j];  a[pivot][j] = swap;
+        }
+        for (i = 0; i < n; i++)
+        {
+            if (i == k) continue;
+            factor = a[i][k] / a[k][k];
+            for (j = k; j <= n; j++)
+                a[i][j] -= factor * a[k][j];
+        }
+    }
+    for (i = 0; i < n; i++)
+        a[i][n] /= a[i][i];
+    return 0;
+}
+
+int replications_estimate(int output, double *mean, double *half_width, double *factor)
+{
+
+/* Estimate output over the runs:  its mean, the half-width of a 95%
+   confidence interval and the variance reduction factor.  Returns -1 if the
+   controls are collinear, in which case the estimate ignores them. */
+
+    double *y, (*c)[MAX_CONTROLS];
+    double a[MAX_CONTROLS][MAX_CONTROLS + 1], x, sum, crude, syy, sse, variance, cbar[MAX_CONTROLS];
+    int    q = replications.num_controls, n = replications.runs, m, i, j, k, per, status;
+
+    /* The crude variance of a mean of n independent runs, from the runs. */
+    for (sum = 0, i = 0; i < n; i++)
+        sum += replications.outputs[i * replications.num_outputs + output];
+    for (crude = 0, i = 0; i < n; i++)
+    {
+        x = replications.outputs[i * replications.num_outputs + output] - sum / n;
+        crude += x * x;
+    }
+    crude /= (double) (n - 1) * n;
+
+    /* Units:  antithetic pairs averaged, or single runs. */
+    per = replications.antithetic ? 2 : 1;
+    m   = n / per;
+    y   = (double *) malloc(m * sizeof(double));
+    c   = (double (*)[MAX_CONTROLS]) malloc(m * sizeof(*c));
+    for (j = 0; j < m; j++)
+    {
+        y[j] = 0;
+        for (k = 0; k < q; k++)
+            c[j][k] = 0;
+        for (i = j * per; i < (j + 1) * per; i++)
+        {
+            y[j] += replications.outputs[i * replications.num_outputs + output] / per;
+            for (k = 0; k < q; k++)
+                c[j][k] += replications.controls[i * q + k] / per;
+        }
+    }
+    for (*mean = 0, j = 0; j < m; j++)
+        *mean += y[j] / m;
+    for (syy = 0, j = 0; j < m; j++)
+        syy += (y[j] - *mean) * (y[j] - *mean);
+
+    /* Regress on the controls, whose expectations are zero:  the estimate is
+       the mean less beta times the controls' means. */
+    status = 0;
+    variance = syy / (m - 1) / m;
+    if (q > 0)
+    {
+        for (k = 0; k < q; k++)
+        {
+            for (cbar[k] = 0, j = 0; j < m; j++)
+                cbar[k] += c[j][k] / m;
+        }
+        for (k = 0; k < q; k++)
+        {
+            for (i = 0; i <= q; i++)
+            {
+                for (a[k][i] = 0, j = 0; j < m; j++)
+                    a[k][i] += (c[j][k] - cbar[k]) * (i < q ? c[j][i] - cbar[i] : y[j] - *mean);
+            }
+        }
+        if (solve(a, q) == 0)
+        {
+            for (sse = syy, k = 0; k < q; k++)
+            {
+                for (j = 0, sum = 0; j < m; j++)
+                    sum += (c[j][k] - cbar[k]) * (y[j] - *mean);
+                sse -= a[k][q] * sum;
+            }
+            for (k = 0; k < q; k++)
+                *mean -= a[k][q] * cbar[k];
+
+            /* Var = s_e^2 (1/m + cbar' S^-1 cbar), with S the centred cross products. */
+            for (k = 0; k < q; k++)
+            {
+                for (i = 0; i < q; i++)
+                {
+                    for (a[k][i] = 0, j = 0; j < m; j++)
+                        a[k][i] += (c[j][k] - cbar[k]) * (c[j][i] - cbar[i]);
+                }
+                a[k][q] = cbar[k];
+            }
+            solve(a, q);
+            for (x = 1.0 / m, k = 0; k < q; k++)
+                x += cbar[k] * a[k][q];
+            variance = (sse > 0 ? sse : 0) / (m - q - 1) * x;
+            *half_width = t_quantile(m - q - 1) * sqrt(variance);
+            *factor = variance > 0 ? crude / variance : INFINITY;
+            free(y);
+            free(c);
+            return 0;
+        }
+        status = -1;
+    }
+    *half_width = t_quantile(m - 1) * sqrt(variance);
+    *factor = variance > 0 ? crude / variance : INFINITY;
+    free(y);
+    free(c);
+    return status;
+}
+
+void replications_free(void) /* Forget the section and the outputs */
+{
+    int k;
+
+    for (k = 0; k < replications.num_controls; k++)
+        free(replications.control_names[k]);
+    free(replications.outputs);
+    free(replications.controls);
+    memset(&replications, 0, sizeof(replications));
+    replications.runs = 1;
+}
@@ -0,0 +1,49 @@
+/* This is replication.h.  Replicated runs of a scenario and variance
+   reduction of their estimates.
+
+   A [replications] section runs a scenario several times from successive
+   seeds and estimates each output, such as the average occupancy of a
+   resource, with a 95% confidence interval.  Two techniques narrow the
+   interval for the same number of runs:
+
+   antithetic = yes pairs the runs, the second of each pair re-running the
+   first's seed with every uniform U replaced by 1 - U, and estimates from the
+   pair averages.
+
+   controls = stage ... adjusts the estimate by regression on control
+   variates:  for each named stage, the mean of the durations (or
+   interarrival times) it sampled in a run, less the configured mean, whose
+   expectation is known to be zero.
+
+   The variance reduction factor reported is the variance of the mean of
+   that many independent runs over the variance of the estimate. */
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "simlib.h"
+#include "config.h"
+
+#define MAX_CONTROLS    16      /* Control variates per scenario. */
+#define T_TABLE_DOF     30      /* Exact t quantiles up to this many degrees of freedom. */
+
+struct replications {
+    int    runs;                /* 1 when the scenario is run once. */
+    int    antithetic;          /* Runs 2j and 2j + 1 are a pair. */
+    int    num_controls;
+    char  *control_names[MAX_CONTROLS];
+    int    num_outputs;
+    double *outputs;            /* outputs[run * num_outputs + k]... */
+    double *controls;           /* ...and controls[run * num_controls + k]. */
+};
+
+extern SIMLIB_LOCAL struct replications replications;
+
+extern int   replications_load(struct config *cfg, struct config_section *section);
+extern void  replications_start(int num_outputs);
+extern void  replications_record(int run, const double outputs[], const double controls[]);
+extern int   replications_estimate(int output, double *mean, double *half_width, double *factor);
+extern void  replications_free(void);
+extern double t_quantile(int dof);
+
+#endif
@@ -0,0 +1,171 @@
+/* This is results.c.  The result cache of batch runs, described in
+   results.h. */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "results.h"
+
+/* The build's identity:  a hash of its sources, generated by CMake, or when
+   built without it, the time this file was compiled. */
+#ifdef ER_SIM_BUILD_ID_H
+#include "build_id.h"
+#endif
+#ifndef ER_SIM_BUILD_ID
+#define ER_SIM_BUILD_ID __DATE__ " " __TIME__
+#endif
+
+#define RESULTS_PATH_LIMIT  (CONFIG_LINE_LIMIT + 64)
+
+const char results_build_id[] = ER_SIM_BUILD_ID;
+
+static unsigned long long fnv(unsigned long long hash, const void *data, size_t size) /* FNV-1a over more bytes */
+{
+    const unsigned char *byte = (const unsigned char *) data;
+
+    while (size-- > 0)
+    {
+        hash ^= *byte++;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+static unsigned long long fnv_file(unsigned long long hash, const char *path) /* FNV-1a over a file's bytes */
+{
+    unsigned char buffer[65536];
+    FILE  *in;
+    size_t size;
+
+    /* A file that cannot be read fails the run, which stores nothing. */
+    if ((in = fopen(path, "rb")) == NULL)
+        return hash;
+    while ((size = fread(buffer, 1, sizeof(buffer), in)) > 0)
+        hash = fnv(hash, buffer, size);
+    fclose(in);
+    return hash;
+}
+
+unsigned long long results_key(struct config *model, const struct scenario *scenario)
+{
+
+/* The key of a scenario's results:  the build, the seed, the parameters and
+   the model sections the report depends on, with the contents of the trace
+   files they name, but not the scenario's name. */
+
+    struct config_section *section;
+    struct config_entry   *entry;
+    unsigned long long     hash = 0xCBF29CE484222325ULL;
+    float  value;
+    int    i, k;
+
+    hash = fnv(hash, results_build_id, sizeof(results_build_id));
+    hash = fnv(hash, &scenario->seed, sizeof(scenario->seed));
+    for (i = 0; i < NUM_PARAMS; i++)
+    {
+        value = scenario->value[i] == 0 ? 0 : scenario->value[i];   /* -0 is 0. */
+        hash  = fnv(hash, &value, sizeof(value));
+    }
+    for (i = 0; i < model->num_sections; i++)
+    {
+        section = &model->sections[i];
+        if (strcmp(section->type, "defaults") == 0 || strcmp(section->type, "scenario") == 0 ||
+            strcmp(section->type, "network") == 0)
+            continue;
+        hash = fnv(hash, section->type, strlen(section->type) + 1);
+        hash = fnv(hash, section->name, strlen(section->name) + 1);
+        hash = fnv(hash, &section->num_entries, sizeof(section->num_entries));
+        for (k = 0; k < section->num_entries; k++)
+        {
+            entry = &model->entries[section->first_entry + k];
+            hash  = fnv(hash, entry->key, strlen(entry->key) + 1);
+            hash  = fnv(hash, entry->value, strlen(entry->value) + 1);
+            if (strcmp(entry->key, "trace") == 0)
+                hash = fnv_file(hash, entry->value);
+        }
+    }
+    return hash;
+}
+
+static int copy(const char *from, const char *to) /* Copy a file into place under a temporary name */
+{
+    char   temporary[RESULTS_PATH_LIMIT], buffer[65536];
+    FILE  *in, *out;
+    size_t size;
+    int    status = 0;
+
+    if ((in = fopen(from, "rb")) == NULL)
+        return -1;
+    snprintf(temporary, RESULTS_PATH_LIMIT, "%s.%ld", to, (long) getpid());
+    if ((out = fopen(temporary, "wb")) == NULL)
+    {
+        fclose(in);
+        return -1;
+    }
+    while ((size = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    {
+        if (fwrite(buffer, 1, size, out) != size)
+        {
+            status = -1;
+            break;
+        }
+    }
+    status |= ferror(in) ? -1 : 0;
+    fclose(in);
+    if ((fclose(out) != 0) | status || rename(temporary, to) != 0)
+    {
+        unlink(temporary);
+        return -1;
+    }
+    return 0;
+}
+
+int results_fetch(const char *dir, unsigned long long key, const char *name)
+{
+
+/* Copy the entry of key to out/<name>.out, and its series to out/<name>.csv
+   if it has one.  Returns 0 on a hit, -1 when there is no entry. */
+
+    char entry[RESULTS_PATH_LIMIT], path[RESULTS_PATH_LIMIT];
+
+    snprintf(entry, RESULTS_PATH_LIMIT, "%s/%016llx.csv", dir, key);
+    snprintf(path, RESULTS_PATH_LIMIT, "out/%s.csv", name);
+    if (access(entry, R_OK) == 0 && copy(entry, path) != 0)
+        return -1;
+    snprintf(entry, RESULTS_PATH_LIMIT, "%s/%016llx.out", dir, key);
+    snprintf(path, RESULTS_PATH_LIMIT, "out/%s.out", name);
+    return copy(entry, path);
+}
+
+int results_store(const char *dir, unsigned long long key, const char *name, int series)
+{
+
+/* Keep out/<name>.out, and out/<name>.csv when the run wrote a series, as the
+   entry of key.  A cache that cannot be written to is reported, and the
+   batch carries on without it. */
+
+    char entry[RESULTS_PATH_LIMIT], path[RESULTS_PATH_LIMIT];
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST)
+    {
+        printf("FILE ERROR: Result Cache \"%s\" Cannot Be Created\n", dir);
+        return -1;
+    }
+    snprintf(entry, RESULTS_PATH_LIMIT, "%s/%016llx.csv", dir, key);
+    snprintf(path, RESULTS_PATH_LIMIT, "out/%s.csv", name);
+    if (series && copy(path, entry) != 0)
+    {
+        printf("FILE ERROR: Result Cache \"%s\" Cannot Be Written To\n", dir);
+        return -1;
+    }
+    snprintf(entry, RESULTS_PATH_LIMIT, "%s/%016llx.out", dir, key);
+    snprintf(path, RESULTS_PATH_LIMIT, "out/%s.out", name);
+    if (copy(path, entry) != 0)
+    {
+        printf("FILE ERROR: Result Cache \"%s\" Cannot Be Written To\n", dir);
+        return -1;
+    }
+    return 0;
+}
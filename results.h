@@ -0,0 +1,32 @@
+/* This is results.h.  The result cache of batch runs.
+
+   A seeded scenario always writes the same report, so a batch keeps each
+   report (and series) it writes under a key, and a later batch copies it back
+   instead of running a scenario with the same key again.  The key is a 64-bit
+   FNV-1a hash of the build, the scenario's seed and parameters and every
+   model section apart from [defaults], [scenario] and [network], in file
+   order, with the bytes of every trace file a stage replays;  the scenario's
+   name is not part of it, so identical scenarios share one entry and editing
+   a sweep (or a trace) re-runs only the scenarios that changed.
+   Scenarios seeded from the clock are never cached.
+
+   Entries are the files <dir>/<key>.out and <dir>/<key>.csv.  Each is written
+   under a name of its own and renamed into place, the report last, so
+   workers running at once never see a partial entry, and one racing another
+   for the same key only replaces it with the same content. */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "config.h"
+#include "scenario.h"
+
+#define RESULTS_DIR  "out/results"  /* Default place of the cache. */
+
+extern const char results_build_id[];
+
+extern unsigned long long results_key(struct config *model, const struct scenario *scenario);
+extern int   results_fetch(const char *dir, unsigned long long key, const char *name);
+extern int   results_store(const char *dir, unsigned long long key, const char *name, int series);
+
+#endif
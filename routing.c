@@ -0,0 +1,109 @@
+/* This is routing.c.  Routing distributions are validated once, when they are
+   defined or loaded, so that route_sample is a single alias-table draw. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "routing.h"
+
+int route_define(struct route *route, const char *stage, int num_outcomes, int outcome[], float prob[]) /* Validate and build a route */
+{
+    int i;
+
+    switch (alias_setup(&route->table, prob, num_outcomes))
+    {
+        case 1:
+            printf("PROBABILITY ERROR: Route \"%s\" Has No Outcomes\n", stage);
+            return -1;
+        case 2:
+            printf("PROBABILITY ERROR: Route \"%s\" Has A Negative Probability\n", stage);
+            return -1;
+        case 3:
+            printf("PROBABILITY ERROR: Route \"%s\" Probabilities Do Not Sum To 1\n", stage);
+            return -1;
+    }
+
+    route->num_outcomes = num_outcomes;
+    route->outcome = (int *)   calloc(num_outcomes + 1, sizeof(int));
+    route->prob    = (float *) calloc(num_outcomes + 1, sizeof(float));
+    for (i = 1; i <= num_outcomes; i++)
+    {
+        route->outcome[i] = outcome[i];
+        route->prob[i]    = prob[i];
+    }
+    return 0;
+}
+
+static int parse_probability(const char *text, float *value) /* Default value parser */
+{
+    char *end;
+
+    *value = strtod(text, &end);
+    return (end == text || *end != '\0') ? -1 : 0;
+}
+
+int route_load(struct route *route, struct config *cfg, struct config_section *section,
+               const char *outcome_names[], int num_names,
+               int (*parse_value)(const char *text, float *value)) /* Build a route from an "outcome = probability" section */
+{
+    struct config_entry *entry;
+    int    i, j, status, remainder, *outcome;
+    float  sum, *prob;
+
+    if (parse_value == NULL)
+        parse_value = parse_probability;
+
+    outcome   = (int *)   calloc(section->num_entries + 1, sizeof(int));
+    prob      = (float *) calloc(section->num_entries + 1, sizeof(float));
+    status    = 0;
+    remainder = 0;
+    sum       = 0;
+
+    /* Resolve each "outcome = probability" entry against the known outcomes.
+       At most one entry may be "*", taking whatever probability is left. */
+    for (i = 1; i <= section->num_entries && status == 0; i++)
+    {
+        entry = &cfg->entries[section->first_entry + i - 1];
+        for (j = 1; j <= num_names; j++)
+        {
+            if (strcmp(entry->key, outcome_names[j]) == 0) break;
+        }
+        outcome[i] = j;
+        if (j > num_names)
+        {
+            printf("CONFIG ERROR: %s:%d: Unknown Outcome \"%s\"\n", cfg->origin, entry->line, entry->key);
+            status = -1;
+        }
+        else if (strcmp(entry->value, "*") == 0 && remainder == 0)
+        {
+            remainder = i;
+        }
+        else if (parse_value(entry->value, &prob[i]) != 0)
+        {
+            printf("CONFIG ERROR: %s:%d: \"%s\" Is Not A Probability\n", cfg->origin, entry->line, entry->value);
+            status = -1;
+        }
+        else
+        {
+            sum += prob[i];
+        }
+    }
+    if (remainder != 0)
+        prob[remainder] = 1 - sum;
+
+    if (status == 0)
+        status = route_define(route, section->name, section->num_entries, outcome, prob);
+
+    free(outcome);
+    free(prob);
+    return status;
+}
+
+void route_free(struct route *route) /* Release a route */
+{
+    alias_free(&route->table);
+    free(route->outcome);
+    free(route->prob);
+    route->outcome = NULL;
+    route->prob = NULL;
+    route->num_outcomes = 0;
+}
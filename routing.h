@@ -0,0 +1,28 @@
+/* This is routing.h.  Per-stage discrete routing distributions sampled in O(1)
+   with simlib alias tables. */
+
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include "simlib.h"
+#include "config.h"
+
+struct route {
+    int    num_outcomes;
+    int   *outcome;             /* outcome[1..num_outcomes], caller-defined codes */
+    float *prob;                /* prob[1..num_outcomes] */
+    struct alias_table table;
+};
+
+extern int  route_define(struct route *route, const char *stage, int num_outcomes, int outcome[], float prob[]);
+extern int  route_load(struct route *route, struct config *cfg, struct config_section *section,
+                       const char *outcome_names[], int num_names,
+                       int (*parse_value)(const char *text, float *value));
+extern void route_free(struct route *route);
+
+static inline int route_sample(struct route *route, int stream) /* Draw an outcome code */
+{
+    return route->outcome[alias_sample(&route->table, stream)];
+}
+
+#endif
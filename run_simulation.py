@@ -1,18 +1,11 @@
 #!/usr/bin/python3
 import subprocess
+import sys
 
-INPUTFILE = "er_sim.in"
-NUMARGS = 17
+CONFIGFILE = "er_sim.cfg"
+CACHEFILE = "build/er_sim.bin"
 SIMPROGRAM = "build/er_sim"
 
-simulations = []
-with open(INPUTFILE, "r") as inputfile:
-    for line in inputfile:
-        simulations.append(line.strip().split())
-
-for simulation in simulations:
-    if len(simulation) == NUMARGS:
-        simulation_init = [SIMPROGRAM]
-        for arg in simulation:
-            simulation_init.append(arg)
-        subprocess.Popen(simulation_init)
+# Validate every scenario once into a cache, then run them all from it in parallel.
+subprocess.run([SIMPROGRAM, "--compile", CONFIGFILE, CACHEFILE], check=True)
+sys.exit(subprocess.run([SIMPROGRAM, "--batch", CACHEFILE] + sys.argv[1:2]).returncode)
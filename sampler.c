@@ -0,0 +1,322 @@
+/* This is sampler.c.  Time series of simlib levels, described in sampler.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sampler.h"
+
+SIMLIB_LOCAL struct sampler sampler;
+
+int sampler_load(struct config *cfg, struct config_section *section) /* The [sample] section, or none */
+{
+    char *text, *end;
+
+    sampler_free();
+    if (section == NULL)
+        return 0;
+
+    if ((text = config_value(cfg, section, "interval")) == NULL ||
+        (sampler.interval = strtod(text, &end), end == text || *end != '\0') || !(sampler.interval > 0))
+    {
+        printf("CONFIG ERROR: %s:%d: [sample] Needs A Positive \"interval\"\n", cfg->origin, section->line);
+        sampler.interval = 0;
+        return -1;
+    }
+    if ((text = config_value(cfg, section, "points")) != NULL &&
+        ((sampler.max_rows = strtol(text, &end, 10), end == text || *end != '\0') ||
+         (sampler.max_rows != 0 && sampler.max_rows < 4)))
+    {
+        printf("CONFIG ERROR: %s:%d: [sample] \"points\" Must Be 0 Or At Least 4\n", cfg->origin, section->line);
+        sampler.interval = 0;
+        return -1;
+    }
+    sampler.max_rows &= ~1;     /* Rows are halved. */
+    sampler.mode = SAMPLE_MINMAX;
+    if ((text = config_value(cfg, section, "downsample")) != NULL)
+    {
+        if (strcmp(text, "lttb") == 0)        sampler.mode = SAMPLE_LTTB;
+        else if (strcmp(text, "minmax") != 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [sample] \"downsample\" Must Be minmax Or lttb\n",
+                   cfg->origin, section->line);
+            sampler.interval = 0;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void sampler_column(const char *name, timest_var variable) /* Watch one more timest variable */
+{
+    int n = sampler.num_columns + 1;
+
+    sampler.names     = (char **) realloc(sampler.names, n * sizeof(char *));
+    sampler.variables = (timest_var *) realloc(sampler.variables, n * sizeof(timest_var));
+    sampler.names[n - 1]     = strdup(name);
+    sampler.variables[n - 1] = variable;
+    sampler.num_columns = n;
+    sampler.max_alloc   = 0;    /* Rows are reallocated at the new width. */
+}
+
+static double area(timest_var variable, float time) /* Area under the variable up to time */
+{
+    struct timest_acc *acc = &timest_acc[variable.id];
+
+    return acc->area + (double) (time - acc->tlvc) * acc->preval;
+}
+
+void sampler_start(void) /* Begin the first interval now, once simlib is initialized */
+{
+    int n = sampler.num_columns, i;
+
+    if (sampler.interval <= 0)
+        return;
+    sampler.area        = (double *) realloc(sampler.area, n * sizeof(double));
+    sampler.pending_sum = (float *) realloc(sampler.pending_sum, 3 * n * sizeof(float));
+    sampler.pending_min = sampler.pending_sum + n;
+    sampler.pending_max = sampler.pending_sum + 2 * n;
+    for (i = 0; i < n; i++)
+        sampler.area[i] = area(sampler.variables[i], sim_time);
+    sampler.origin    = sim_time;
+    sampler.intervals = 0;
+    sampler.next      = sim_time + sampler.interval;
+    sampler.num_rows  = 0;
+    sampler.per_row   = 1;
+    sampler.pending   = 0;
+}
+
+static void merge_pairs(void) /* minmax:  halve the rows by merging neighbours */
+{
+    int n = sampler.num_columns, j, i;
+    float *mean = sampler.mean, *min = sampler.min, *max = sampler.max;
+
+    /* Rows of a full buffer all span per_row intervals, so means average evenly. */
+    for (j = 0; j < sampler.num_rows / 2; j++)
+    {
+        sampler.time[j] = sampler.time[2 * j];
+        for (i = 0; i < n; i++)
+        {
+            mean[j * n + i] = (mean[2 * j * n + i] + mean[(2 * j + 1) * n + i]) / 2;
+            min[j * n + i]  = min[2 * j * n + i] < min[(2 * j + 1) * n + i] ? min[2 * j * n + i] : min[(2 * j + 1) * n + i];
+            max[j * n + i]  = max[2 * j * n + i] > max[(2 * j + 1) * n + i] ? max[2 * j * n + i] : max[(2 * j + 1) * n + i];
+        }
+    }
+    sampler.num_rows /= 2;
+    sampler.per_row  *= 2;
+}
+
+static int bucket_end(int bucket, int keep, int rows) /* lttb:  end of a bucket of candidate rows */
+{
+    /* Rows 1 to rows - 2 are shared by keep - 2 buckets;  the first and last row are kept. */
+    if (bucket >= keep - 3)
+        return rows - 1;
+    return 1 + (int) ((double) (bucket + 1) * (rows - 2) / (keep - 2));
+}
+
+static void select_lttb(void) /* lttb:  keep half the rows, the first and last among them */
+{
+    int    n = sampler.num_columns, rows = sampler.num_rows, keep = rows / 2;
+    int    bucket, from, to, next_to, b, c, best, i;
+    float *time = sampler.time, *mean = sampler.mean;
+    double *average = (double *) malloc((n + 1) * sizeof(double));
+    double value, best_value;
+
+    /* Row a, the one kept last, is already at index bucket of the result,
+       below every row still to be read, so the selection is made in place. */
+    for (bucket = 0; bucket < keep - 2; bucket++)
+    {
+        from    = bucket > 0 ? bucket_end(bucket - 1, keep, rows) : 1;
+        to      = bucket_end(bucket, keep, rows);
+        next_to = bucket == keep - 3 ? rows : bucket_end(bucket + 1, keep, rows);
+
+        /* Third point:  the average of the next bucket, average[n] its time. */
+        memset(average, 0, (n + 1) * sizeof(double));
+        for (c = to; c < next_to; c++)
+        {
+            average[n] += time[c];
+            for (i = 0; i < n; i++)
+                average[i] += mean[c * n + i];
+        }
+        for (i = 0; i <= n; i++)
+            average[i] /= next_to - to;
+
+        best = from;
+        best_value = -1;
+        for (b = from; b < to; b++)
+        {
+            value = 0;
+            for (i = 0; i < n; i++)
+                value += fabs((time[bucket] - average[n]) * (mean[b * n + i] - mean[bucket * n + i]) -
+                              (time[bucket] - time[b]) * (average[i] - mean[bucket * n + i]));
+            if (value > best_value)
+            {
+                best_value = value;
+                best = b;
+            }
+        }
+        time[bucket + 1] = time[best];
+        memmove(&mean[(bucket + 1) * n], &mean[best * n], n * sizeof(float));
+    }
+    time[keep - 1] = time[rows - 1];
+    memmove(&mean[(keep - 1) * n], &mean[(rows - 1) * n], n * sizeof(float));
+    sampler.num_rows = keep;
+    free(average);
+}
+
+static void push_row(float time, const float *mean, const float *min, const float *max, int final)
+{
+    int n = sampler.num_columns, r;
+
+    if (sampler.num_rows == sampler.max_alloc)
+    {
+        sampler.max_alloc = sampler.max_rows > 0 ? sampler.max_rows :
+                            sampler.max_alloc > 0 ? 2 * sampler.max_alloc : 256;
+        sampler.time = (float *) realloc(sampler.time, sampler.max_alloc * sizeof(float));
+        sampler.mean = (float *) realloc(sampler.mean, sampler.max_alloc * n * sizeof(float));
+        sampler.min  = (float *) realloc(sampler.min, sampler.max_alloc * n * sizeof(float));
+        sampler.max  = (float *) realloc(sampler.max, sampler.max_alloc * n * sizeof(float));
+    }
+    r = sampler.num_rows++;
+    sampler.time[r] = time;
+    memcpy(&sampler.mean[r * n], mean, n * sizeof(float));
+    memcpy(&sampler.min[r * n], min, n * sizeof(float));
+    memcpy(&sampler.max[r * n], max, n * sizeof(float));
+
+    /* A full buffer is halved at once, so rows of one width never mix. */
+    if (!final && sampler.max_rows > 0 && sampler.num_rows == sampler.max_rows)
+    {
+        if (sampler.mode == SAMPLE_LTTB)
+            select_lttb();
+        else
+            merge_pairs();
+    }
+}
+
+static void flush_pending(int final) /* minmax:  close the row being built */
+{
+    int n = sampler.num_columns, i;
+
+    for (i = 0; i < n; i++)
+        sampler.pending_sum[i] /= sampler.pending_span;
+    push_row(sampler.pending_time, sampler.pending_sum, sampler.pending_min, sampler.pending_max, final);
+    sampler.pending = 0;
+}
+
+static void record(float start, float end, int final) /* One interval, or the last part of one */
+{
+    int   n = sampler.num_columns, i;
+    float value;
+    double now;
+
+    if (sampler.mode == SAMPLE_MINMAX && sampler.pending == 0)
+    {
+        sampler.pending_time = start;
+        sampler.pending_span = 0;
+        for (i = 0; i < n; i++)
+        {
+            sampler.pending_sum[i] = 0;
+            sampler.pending_min[i] = INFINITY;
+            sampler.pending_max[i] = -INFINITY;
+        }
+    }
+    for (i = 0; i < n; i++)
+    {
+        now   = area(sampler.variables[i], end);
+        value = (float) ((now - sampler.area[i]) / (end - start));
+        sampler.area[i] = now;
+        if (sampler.mode == SAMPLE_MINMAX)
+        {
+            sampler.pending_sum[i] += value * (end - start);
+            if (value < sampler.pending_min[i]) sampler.pending_min[i] = value;
+            if (value > sampler.pending_max[i]) sampler.pending_max[i] = value;
+        }
+        else
+            sampler.pending_sum[i] = value;
+    }
+
+    if (sampler.mode == SAMPLE_MINMAX)
+    {
+        sampler.pending_span += end - start;
+        if (++sampler.pending == sampler.per_row)
+            flush_pending(final);
+    }
+    else
+        push_row(start, sampler.pending_sum, sampler.pending_sum, sampler.pending_sum, final);
+}
+
+void sampler_take(float until) /* Record every interval that ends by until */
+{
+    float start;
+
+    while (until >= sampler.next)
+    {
+        start = sampler.next - sampler.interval;
+        record(start, sampler.next, 0);
+        sampler.intervals++;
+        sampler.next = sampler.origin + (sampler.intervals + 1) * sampler.interval;
+    }
+}
+
+int sampler_write(const char *path) /* Close the last interval at sim_time and write the series */
+{
+    FILE *file;
+    int   n = sampler.num_columns, r, i, status;
+    float start = sampler.next - sampler.interval;
+
+    if (sampler.interval <= 0)
+        return 0;
+    if (sim_time > start)
+        record(start, sim_time, 1);
+    if (sampler.mode == SAMPLE_MINMAX && sampler.pending > 0)
+        flush_pending(1);
+
+    if ((file = fopen(path, "w")) == NULL)
+    {
+        printf("FILE ERROR: Series File \"%s\" Cannot Be Opened\n", path);
+        return -1;
+    }
+    status = fprintf(file, "minutes") < 0;
+    for (i = 0; i < n; i++)
+    {
+        if (sampler.mode == SAMPLE_MINMAX)
+            status |= fprintf(file, ",%s,%s_min,%s_max", sampler.names[i], sampler.names[i], sampler.names[i]) < 0;
+        else
+            status |= fprintf(file, ",%s", sampler.names[i]) < 0;
+    }
+    status |= fprintf(file, "\n") < 0;
+    for (r = 0; r < sampler.num_rows; r++)
+    {
+        status |= fprintf(file, "%.3f", sampler.time[r]) < 0;
+        for (i = 0; i < n; i++)
+        {
+            if (sampler.mode == SAMPLE_MINMAX)
+                status |= fprintf(file, ",%.3f,%.3f,%.3f", sampler.mean[r * n + i],
+                                  sampler.min[r * n + i], sampler.max[r * n + i]) < 0;
+            else
+                status |= fprintf(file, ",%.3f", sampler.mean[r * n + i]) < 0;
+        }
+        status |= fprintf(file, "\n") < 0;
+    }
+    if ((fclose(file) != 0) | status)
+    {
+        printf("FILE ERROR: Series File \"%s\" Cannot Be Written To\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void sampler_free(void) /* Stop sampling and release the series */
+{
+    int i;
+
+    for (i = 0; i < sampler.num_columns; i++)
+        free(sampler.names[i]);
+    free(sampler.names);
+    free(sampler.variables);
+    free(sampler.area);
+    free(sampler.time);
+    free(sampler.mean);
+    free(sampler.min);
+    free(sampler.max);
+    free(sampler.pending_sum);
+    memset(&sampler, 0, sizeof(sampler));
+}
@@ -0,0 +1,62 @@
+/* This is sampler.h.  Time series of simlib levels at a fixed interval.
+
+   A sampler watches timest variables, such as the lengths of resource lists
+   and stage queues, and records each one's time-weighted average over every
+   interval of simulated time.  The average is the growth of the variable's
+   area since the last boundary, so the event loop only has to call
+   sampler_advance with the time of the next event;  nothing is recorded on
+   the hot paths of simlib.
+
+   With a bound on the number of rows, the series is downsampled as it grows.
+   minmax halves the resolution whenever the rows fill up, merging pairs of
+   rows into their mean, minimum and maximum;  lttb keeps the rows instead,
+   halving them with Largest-Triangle-Three-Buckets over all columns at once.
+   Either way a run of any length keeps at most that many rows.  The series
+   is written as CSV, a row per interval (or bucket) and a column per level. */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "simlib.h"
+#include "config.h"
+
+#define SAMPLE_MINMAX   1       /* Buckets of merged intervals. */
+#define SAMPLE_LTTB     2       /* Selected intervals. */
+
+struct sampler {
+    float  interval;            /* Minutes per sample, 0 when not sampling. */
+    int    max_rows, mode;      /* Bound on the rows kept, 0 for none. */
+    int    num_columns;
+    char **names;
+    timest_var *variables;
+    double *area;               /* Area of each variable at the last boundary. */
+    float  origin;              /* Start of the first interval... */
+    long   intervals;           /* ...intervals recorded since... */
+    float  next;                /* ...and the end of the current one. */
+
+    int    num_rows, max_alloc;
+    float *time;                /* Start of each row... */
+    float *mean, *min, *max;    /* ...and its levels, num_columns per row. */
+    int    per_row;             /* minmax:  intervals merged into each row... */
+    int    pending;             /* ...and into the row being built. */
+    float  pending_time, pending_span, *pending_sum, *pending_min, *pending_max;
+};
+
+extern SIMLIB_LOCAL struct sampler sampler;
+
+extern int   sampler_load(struct config *cfg, struct config_section *section);
+extern void  sampler_column(const char *name, timest_var variable);
+extern void  sampler_start(void);
+extern void  sampler_take(float until);
+extern int   sampler_write(const char *path);
+extern void  sampler_free(void);
+
+static inline void sampler_advance(void) /* Record the intervals ending before the next event */
+{
+    float time;
+
+    if (sampler.interval > 0 && (time = event_next_time()) >= sampler.next)
+        sampler_take(time);
+}
+
+#endif
@@ -0,0 +1,267 @@
+/* This is scenario.c.  Typed run parameters and the scenario cache described
+   in scenario.h. */
+
+#include <errno.h>
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "scenario.h"
+
+const struct param_spec param_specs[NUM_PARAMS] = {
+    {"mean_walkin_arrival",                PARAM_FLOAT,   0.5,  0, FLT_MAX, 1,
+     "Mean walk-in arrival rate",          "patients per minute"},
+    {"mean_ambulance_arrival",             PARAM_FLOAT,   0.1,  0, FLT_MAX, 1,
+     "Mean ambulance arrival rate",        "patients per minute"},
+    {"mean_triage_duration",               PARAM_FLOAT,    10,  0, FLT_MAX, 0,
+     "Mean triage duration",               "minutes"},
+    {"mean_initial_assessment_duration",   PARAM_FLOAT,    10,  0, FLT_MAX, 0,
+     "Mean initial assessment duration",   "minutes"},
+    {"mean_test_duration",                 PARAM_FLOAT,    10,  0, FLT_MAX, 0,
+     "Mean test duration",                 "minutes"},
+    {"mean_follow_up_assessment_duration", PARAM_FLOAT,    10,  0, FLT_MAX, 0,
+     "Mean follow-up assessment duration", "minutes"},
+    {"mean_hospital_duration",             PARAM_FLOAT,    10,  0, FLT_MAX, 0,
+     "Mean hospital stay duration",        "minutes"},
+    {"mean_severity",                      PARAM_FLOAT,     3, -FLT_MAX, FLT_MAX, 0,
+     "Mean patient severity",              ""},
+    {"num_doctors",                        PARAM_INT,     100,  0, 1e6, 0,
+     "Number of doctors available",        ""},
+    {"num_nurses",                         PARAM_INT,     100,  0, 1e6, 0,
+     "Number of nurses available",         ""},
+    {"num_exam_rooms",                     PARAM_INT,     100,  0, 1e6, 0,
+     "Number of exam rooms available",     ""},
+    {"num_labs",                           PARAM_INT,     100,  0, 1e6, 0,
+     "Number of labs available",           ""},
+    {"num_hospital_rooms",                 PARAM_INT,     100,  0, 1e6, 0,
+     "Number of hospital rooms available", ""},
+    {"addmittance_chance",                 PARAM_FLOAT,   0.4,  0, 1, 0,
+     "Chance to be admitted to the hospital", ""},
+    {"specialist_chance",                  PARAM_FLOAT,   0.4,  0, 1, 0,
+     "Chance to see a specialist",         ""},
+    {"goal_patients_simulated",            PARAM_INT,   50000,  1, 1e9, 0,
+     "Number of patients to simulate",     ""}};
+
+void scenario_defaults(struct scenario *scenario) /* Reset to the built-in defaults */
+{
+    int i;
+
+    memset(scenario, 0, sizeof(struct scenario));
+    for (i = 0; i < NUM_PARAMS; i++)
+        scenario->value[i] = param_specs[i].value;
+}
+
+int scenario_set(struct scenario *scenario, const char *key, const char *text) /* Set one parameter */
+{
+    char  *end;
+    double value;
+    long   seed;
+    int    i;
+
+    if (strcmp(key, "seed") == 0)
+    {
+        errno = 0;
+        seed = strtol(text, &end, 10);
+        if (end == text || *end != '\0' || errno != 0 || seed < 0 || seed > 2147483646L)
+        {
+            printf("INPUT ERROR: \"%s\" Is Not A Valid seed\n", text);
+            return -1;
+        }
+        scenario->seed = seed;
+        return 0;
+    }
+
+    for (i = 0; i < NUM_PARAMS && strcmp(param_specs[i].name, key) != 0; i++)
+        ;
+    if (i == NUM_PARAMS)
+    {
+        printf("INPUT ERROR: Unknown Parameter \"%s\"\n", key);
+        return -1;
+    }
+    if (param_parse(&param_specs[i], text, &value) != 0)
+    {
+        printf("INPUT ERROR: \"%s\" Is Not A Valid %s\n", text, param_specs[i].name);
+        return -1;
+    }
+    scenario->value[i] = value;
+    return 0;
+}
+
+int param_parse(const struct param_spec *spec, const char *text, double *value) /* A value the spec allows */
+{
+    char *end;
+
+    /* Numbers must parse completely, integers must be whole, and both must
+       lie in range.  Zero is valid wherever the range allows it. */
+    errno = 0;
+    *value = strtod(text, &end);
+    if (end == text || *end != '\0' || errno != 0 ||
+        (spec->type == PARAM_INT && *value != (long) *value) ||
+        *value < spec->min || (spec->min_exclusive && *value == spec->min) || *value > spec->max)
+        return -1;
+    return 0;
+}
+
+int scenario_load(struct scenario *scenario, struct config *cfg, struct config_section *section) /* Apply a section */
+{
+    struct config_entry *entry;
+    int i;
+
+    for (i = section->first_entry; i < section->first_entry + section->num_entries; i++)
+    {
+        entry = &cfg->entries[i];
+        if (scenario_set(scenario, entry->key, entry->value) != 0)
+        {
+            printf("INPUT ERROR: %s:%d: In [%s%s%s]\n", cfg->origin, entry->line, section->type,
+                   *section->name ? " " : "", section->name);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int cache_compile(const char *config_path, const char *cache_path) /* Write the cache of a scenario file */
+{
+    struct config       cfg;
+    struct config_section *defaults;
+    struct cache_header header;
+    struct scenario    *scenarios;
+    FILE  *file;
+    char  *text;
+    long   size;
+    int    i, j, n, status;
+
+    /* Read the file once for its text, which becomes the cached model... */
+    if ((file = fopen(config_path, "r")) == NULL)
+    {
+        printf("CONFIG ERROR: Config File \"%s\" Cannot Be Opened\n", config_path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    rewind(file);
+    text = (char *) malloc(size + 1);
+    size = fread(text, 1, size, file);
+    text[size] = '\0';
+    fclose(file);
+
+    /* ...and validate every scenario in it now, so workers never have to. */
+    if (config_parse(&cfg, text, config_path) != 0)
+    {
+        free(text);
+        return -1;
+    }
+    scenarios = (struct scenario *) calloc(cfg.num_sections + 1, sizeof(struct scenario));
+    defaults  = config_find(&cfg, "defaults", NULL);
+    status = 0;
+    for (i = n = 0; i < cfg.num_sections && status == 0; i++)
+    {
+        if (strcmp(cfg.sections[i].type, "scenario") != 0) continue;
+        if (strlen(cfg.sections[i].name) == 0 || strlen(cfg.sections[i].name) >= SCENARIO_NAME_LIMIT)
+        {
+            printf("CONFIG ERROR: %s:%d: Scenario Name Must Have 1 To %d Characters\n",
+                   config_path, cfg.sections[i].line, SCENARIO_NAME_LIMIT - 1);
+            status = -1;
+            break;
+        }
+        for (j = 0; j < n && strcmp(scenarios[j].name, cfg.sections[i].name) != 0; j++)
+            ;
+        if (j < n)
+        {
+            printf("CONFIG ERROR: %s:%d: [scenario %s] Defined Twice\n",
+                   config_path, cfg.sections[i].line, cfg.sections[i].name);
+            status = -1;
+            break;
+        }
+        scenario_defaults(&scenarios[n]);
+        strcpy(scenarios[n].name, cfg.sections[i].name);
+        if ((defaults != NULL && scenario_load(&scenarios[n], &cfg, defaults) != 0) ||
+            scenario_load(&scenarios[n], &cfg, &cfg.sections[i]) != 0)
+            status = -1;
+        n++;
+    }
+    config_free(&cfg);
+
+    if (status == 0 && n == 0)
+    {
+        printf("CONFIG ERROR: %s: No [scenario] Sections\n", config_path);
+        status = -1;
+    }
+
+    /* Header, scenario records, then the model text. */
+    if (status == 0)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+        header.num_params      = NUM_PARAMS;
+        header.num_scenarios   = n;
+        header.scenario_offset = sizeof(header);
+        header.model_offset    = header.scenario_offset + n * sizeof(struct scenario);
+        header.model_size      = size + 1;
+
+        if ((file = fopen(cache_path, "wb")) == NULL ||
+            fwrite(&header, sizeof(header), 1, file) != 1 ||
+            fwrite(scenarios, sizeof(struct scenario), n, file) != (size_t) n ||
+            fwrite(text, 1, size + 1, file) != (size_t) size + 1 ||
+            fclose(file) != 0)
+        {
+            printf("FILE ERROR: Cache File \"%s\" Cannot Be Written To\n", cache_path);
+            status = -1;
+        }
+    }
+    free(scenarios);
+    free(text);
+    return status;
+}
+
+int cache_open(struct scenario_cache *cache, const char *path) /* Map a cache file read-only */
+{
+    struct stat info;
+    int fd;
+
+    memset(cache, 0, sizeof(struct scenario_cache));
+    if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &info) != 0)
+    {
+        printf("FILE ERROR: Cache File \"%s\" Cannot Be Opened\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    cache->size = info.st_size;
+    cache->map  = mmap(NULL, cache->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (cache->map == MAP_FAILED)
+    {
+        printf("FILE ERROR: Cache File \"%s\" Cannot Be Mapped\n", path);
+        cache->map = NULL;
+        return -1;
+    }
+
+    /* Reject files from another build or truncated files before trusting any offset. */
+    cache->header = (struct cache_header *) cache->map;
+    if (cache->size < (long) sizeof(struct cache_header) ||
+        memcmp(cache->header->magic, CACHE_MAGIC, sizeof(cache->header->magic)) != 0 ||
+        cache->header->num_params != NUM_PARAMS ||
+        cache->header->scenario_offset + cache->header->num_scenarios * (long) sizeof(struct scenario) > cache->size ||
+        cache->header->model_offset + cache->header->model_size > cache->size ||
+        cache->header->model_size < 1 ||
+        ((char *) cache->map)[cache->header->model_offset + cache->header->model_size - 1] != '\0')
+    {
+        printf("FILE ERROR: \"%s\" Is Not A Scenario Cache For This Build\n", path);
+        cache_close(cache);
+        return -1;
+    }
+    cache->scenarios = (struct scenario *) ((char *) cache->map + cache->header->scenario_offset);
+    cache->model     = (const char *) cache->map + cache->header->model_offset;
+    return 0;
+}
+
+void cache_close(struct scenario_cache *cache) /* Unmap a cache file */
+{
+    if (cache->map != NULL)
+        munmap(cache->map, cache->size);
+    memset(cache, 0, sizeof(struct scenario_cache));
+}
@@ -0,0 +1,83 @@
+/* This is scenario.h.  Typed run parameters, scenarios read from config files
+   and the binary scenario cache.
+
+   A scenario file holds a [defaults] section, any number of [scenario name]
+   sections overriding it, and optionally the pathway sections of pathway.h
+   shared by every scenario.  Compiling it produces a cache file:  a header,
+   the pathway text and an array of fixed-size scenario records that batch
+   workers map and read in place. */
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "config.h"
+
+#define SCENARIO_NAME_LIMIT 42  /* Longest scenario name + 1, fits "out/<name>.out". */
+#define CACHE_MAGIC  "ERSIMSC1" /* First bytes of a scenario cache file. */
+
+#define PARAM_FLOAT         1
+#define PARAM_INT           2
+
+/* Parameter indices, in the order of the legacy positional arguments. */
+
+#define P_MEAN_WALKIN_ARRIVAL                 0
+#define P_MEAN_AMBULANCE_ARRIVAL              1
+#define P_MEAN_TRIAGE_DURATION                2
+#define P_MEAN_INITIAL_ASSESSMENT_DURATION    3
+#define P_MEAN_TEST_DURATION                  4
+#define P_MEAN_FOLLOW_UP_ASSESSMENT_DURATION  5
+#define P_MEAN_HOSPITAL_DURATION              6
+#define P_MEAN_SEVERITY                       7
+#define P_NUM_DOCTORS                         8
+#define P_NUM_NURSES                          9
+#define P_NUM_EXAM_ROOMS                     10
+#define P_NUM_LABS                           11
+#define P_NUM_HOSPITAL_ROOMS                 12
+#define P_ADDMITTANCE_CHANCE                 13
+#define P_SPECIALIST_CHANCE                  14
+#define P_GOAL_PATIENTS_SIMULATED            15
+#define NUM_PARAMS                           16
+
+struct param_spec {
+    const char *name;
+    int         type;
+    float       value;          /* Default. */
+    float       min, max;       /* Valid range, inclusive... */
+    int         min_exclusive;  /* ...except min when this is set. */
+    const char *label;          /* Report wording. */
+    const char *unit;
+};
+
+struct scenario {
+    char  name[SCENARIO_NAME_LIMIT];
+    long  seed;                 /* 0 draws a seed from the clock. */
+    float value[NUM_PARAMS];
+};
+
+struct cache_header {
+    char  magic[8];
+    int   num_params;
+    int   num_scenarios;
+    long  model_offset, model_size;  /* Pathway text, NUL terminated. */
+    long  scenario_offset;           /* struct scenario[num_scenarios]. */
+};
+
+struct scenario_cache {
+    void                *map;
+    long                 size;
+    struct cache_header *header;
+    struct scenario     *scenarios;
+    const char          *model;
+};
+
+extern const struct param_spec param_specs[NUM_PARAMS];
+
+extern void  scenario_defaults(struct scenario *scenario);
+extern int   scenario_set(struct scenario *scenario, const char *key, const char *text);
+extern int   param_parse(const struct param_spec *spec, const char *text, double *value);
+extern int   scenario_load(struct scenario *scenario, struct config *cfg, struct config_section *section);
+extern int   cache_compile(const char *config_path, const char *cache_path);
+extern int   cache_open(struct scenario_cache *cache, const char *path);
+extern void  cache_close(struct scenario_cache *cache);
+
+#endif
@@ -0,0 +1,362 @@
+/* This is screen.c.  The analytic approximation of a pathway described in
+   screen.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "screen.h"
+
+#define SCREEN_ITERATIONS  1000 /* Most rounds of the wait and load fixed point. */
+
+SIMLIB_LOCAL struct screen screen;
+
+int screen_load(struct config *cfg, struct config_section *section) /* The [screen] section, or none */
+{
+    char *text, *end;
+
+    screen_free();
+    if (section == NULL)
+        return 0;
+    screen.enabled = 1;
+
+    if ((text = config_value(cfg, section, "unstable")) != NULL)
+    {
+        if (strcmp(text, "skip") == 0)      screen.skip_unstable = 1;
+        else if (strcmp(text, "flag") != 0)
+        {
+            printf("CONFIG ERROR: %s:%d: [screen] \"unstable\" Must Be skip Or flag\n", cfg->origin, section->line);
+            screen_free();
+            return -1;
+        }
+    }
+    if ((text = config_value(cfg, section, "patients")) != NULL &&
+        ((screen.min_patients = strtol(text, &end, 10)) < 1 || end == text ||
+         (screen.max_patients = strtol(end, &end, 10)) < screen.min_patients || *end != '\0'))
+    {
+        printf("CONFIG ERROR: %s:%d: [screen] \"patients\" Must Be A Minimum And A Maximum Run Length\n",
+               cfg->origin, section->line);
+        screen_free();
+        return -1;
+    }
+    return 0;
+}
+
+static int holds(const int *lists, int n, int r) /* Is resource list r among n lists? */
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (lists[i] == r)
+            return 1;
+    }
+    return 0;
+}
+
+static double variance(const struct duration *d) /* Variance of a duration distribution */
+{
+    switch (d->dist)
+    {
+        case DIST_EXPON:
+            return d->a * d->a;
+        case DIST_NORMAL:
+            return 1;
+        case DIST_UNIFORM:
+            return (d->b - d->a) * (d->b - d->a) / 12;
+        case DIST_ERLANG:
+            return d->a * d->a / d->b;
+        default:
+            return 0;
+    }
+}
+
+static int traffic(double **route, const double *pass, const double *source, const double *external, double *flow)
+{
+
+/* Solve flow[s] = external[s] + sum over p of route[p][s] (pass[p] flow[p] +
+   source[p]) for stages 1..n by Gaussian elimination.  Returns -1 if the
+   routes trap patients in a loop with no way out. */
+
+    int    n = pathway.num_stages, i, j, k, pivot;
+    double *a = (double *) calloc(n * (n + 1), sizeof(double)), factor, swap;
+
+#define A(i, j) a[(i) * (n + 1) + (j)]
+    for (i = 0; i < n; i++)
+    {
+        A(i, n) = external[i + 1];
+        for (j = 0; j < n; j++)
+        {
+            A(i, j) = (i == j) - route[j + 1][i + 1] * pass[j + 1];
+            A(i, n) += route[j + 1][i + 1] * source[j + 1];
+        }
+    }
+    for (k = 0; k < n; k++)
+    {
+        for (pivot = k, i = k + 1; i < n; i++)
+        {
+            if (fabs(A(i, k)) > fabs(A(pivot, k)))
+                pivot = i;
+        }
+        if (fabs(A(pivot, k)) < 1e-12)
+        {
+            free(a);
+            return -1;
+        }
+        for (j = k; j <= n; j++)
+        {
+            swap = A(k, j);  A(k, j) = A(pivot, j);  A(pivot, j) = swap;
+        }
+        for (i = 0; i < n; i++)
+        {
+            if (i == k) continue;
+            factor = A(i, k) / A(k, k);
+            for (j = k; j <= n; j++)
+                A(i, j) -= factor * A(k, j);
+        }
+    }
+    for (i = 0; i < n; i++)
+        flow[i + 1] = A(i, n) / A(i, i);
+#undef A
+    free(a);
+    return 0;
+}
+
+static double erlang_c(int servers, double load) /* Chance an arrival waits in an M/M/c queue */
+{
+    double blocked = 1;
+    int    k;
+
+    for (k = 1; k <= servers; k++)
+        blocked = load * blocked / (k + load * blocked);
+    return blocked / (1 - load / servers * (1 - blocked));
+}
+
+int screen_approximate(void)
+{
+
+/* Approximate the compiled pathway into screen.  Returns -1 if it cannot be
+   approximated:  it replays traces, or its routes never let patients out. */
+
+    struct stage    *stage;
+    struct resource *resource;
+    int    n = pathway.num_stages, m = pathway.num_resources, s, p, r, k, iteration;
+    double **route, *zero, *one, *external, *service, *spread, *pass, *source;
+    double **during, **carried, **boarded, *spreads, *seized;
+    double arrivals, severity, severe, wait, hold, change, skip;
+
+    screen.screened = 0;
+    screen.visits  = (double *) realloc(screen.visits, (n + 1) * sizeof(double));
+    screen.wait    = (double *) realloc(screen.wait, (n + 1) * sizeof(double));
+    screen.waiting = (double *) realloc(screen.waiting, (n + 1) * sizeof(double));
+    screen.load    = (double *) realloc(screen.load, (m + 1) * sizeof(double));
+    for (s = 1; s <= n; s++)
+    {
+        if (pathway.stages[s].kind == STAGE_ARRIVAL && pathway.stages[s].trace.path != NULL)
+            return -1;
+    }
+
+    /* route[p][s], the chance of going from stage p to stage s. */
+    route = (double **) malloc((n + 1) * sizeof(double *));
+    for (p = 1; p <= n; p++)
+    {
+        route[p] = (double *) calloc(n + 1, sizeof(double));
+        stage = &pathway.stages[p];
+        if (stage->kind == STAGE_EXIT)
+            continue;
+        if (stage->route.num_outcomes > 0)
+        {
+            for (k = 1; k <= stage->route.num_outcomes; k++)
+                route[p][stage->route.outcome[k]] += stage->route.prob[k];
+        }
+        else if (stage->next > 0)
+            route[p][stage->next] = 1;
+    }
+
+    zero     = (double *) calloc(n + 1, sizeof(double));
+    one      = (double *) calloc(n + 1, sizeof(double));
+    external = (double *) calloc(n + 1, sizeof(double));
+    service  = (double *) calloc(n + 1, sizeof(double));
+    spread   = (double *) calloc(n + 1, sizeof(double));
+    pass     = (double *) calloc(n + 1, sizeof(double));
+    source   = (double *) calloc(n + 1, sizeof(double));
+    during   = (double **) malloc((m + 1) * sizeof(double *));
+    carried  = (double **) malloc((m + 1) * sizeof(double *));
+    boarded  = (double **) malloc((m + 1) * sizeof(double *));
+    spreads  = (double *) calloc(m + 1, sizeof(double));
+    seized   = (double *) calloc(m + 1, sizeof(double));
+    for (r = 1; r <= m; r++)
+    {
+        during[r]  = (double *) calloc(n + 1, sizeof(double));
+        carried[r] = (double *) calloc(n + 1, sizeof(double));
+        boarded[r] = (double *) calloc(n + 1, sizeof(double));
+    }
+
+    /* Visit rates. */
+    for (arrivals = 0, s = 1; s <= n; s++)
+    {
+        one[s] = 1;
+        if (pathway.stages[s].kind == STAGE_ARRIVAL)
+            arrivals += external[s] = 1 / pathway_mean_duration(&pathway.stages[s]);
+    }
+    if (traffic(route, one, zero, external, screen.visits) != 0)
+        goto unscreened;
+
+    /* Service times, fast-track stages skipping theirs for severities drawn
+       at or above the threshold, with the mean of the draws. */
+    for (severity = 0, severe = 0, s = 1; s <= n; s++)
+    {
+        if (pathway.stages[s].samples_severity)
+        {
+            severity += screen.visits[s] * pathway.stages[s].mean_severity;
+            severe   += screen.visits[s];
+        }
+    }
+    for (s = 1; s <= n; s++)
+    {
+        stage = &pathway.stages[s];
+        if (stage->kind != STAGE_SERVICE)
+            continue;
+        service[s] = fmax(pathway_mean_duration(stage), pathway.min_duration);
+        spread[s]  = variance(&stage->duration);
+        if (stage->fast_track && severe > 0)
+        {
+            skip = 0.5 * erfc((stage->threshold_severity - severity / severe) / sqrt(2.0));
+            spread[s]  = (1 - skip) * spread[s] +
+                         skip * (1 - skip) * (service[s] - pathway.min_duration) * (service[s] - pathway.min_duration);
+            service[s] = (1 - skip) * service[s] + skip * pathway.min_duration;
+        }
+    }
+
+    /* Patients holding each resource through a stage (during), into it
+       (carried) and into its queue only (boarded), which they leave at once
+       for a stage seizing it.  Per seizure by a service stage, the variance
+       of the services it is held through. */
+    for (r = 1; r <= m; r++)
+    {
+        for (p = 1; p <= n; p++)
+        {
+            stage = &pathway.stages[p];
+            k = holds(stage->seize, stage->num_seize, r);
+            pass[p]   = !k && !holds(stage->release, stage->num_release, r);
+            source[p] = k && !holds(stage->release, stage->num_release, r) ? screen.visits[p] : 0;
+        }
+        if (traffic(route, pass, source, zero, carried[r]) != 0)
+            goto unscreened;
+        for (p = 1; p <= n; p++)
+        {
+            stage = &pathway.stages[p];
+            during[r][p] = holds(stage->seize, stage->num_seize, r) ? screen.visits[p] : carried[r][p];
+            if (holds(stage->hold, stage->num_hold, r))
+            {
+                for (s = 1; s <= n; s++)
+                {
+                    if (!holds(pathway.stages[s].seize, pathway.stages[s].num_seize, r))
+                        boarded[r][s] += route[p][s] * during[r][p];
+                }
+            }
+            if (stage->kind == STAGE_SERVICE && holds(stage->seize, stage->num_seize, r))
+                seized[r] += screen.visits[p];
+            spreads[r] += during[r][p] * spread[p];
+        }
+    }
+
+    /* Loads from waits, waits from loads, until they settle or a load
+       reaches its capacity. */
+    for (s = 1; s <= n; s++)
+        screen.wait[s] = 0;
+    screen.stable = 1;
+    for (iteration = 0; iteration < SCREEN_ITERATIONS; iteration++)
+    {
+        screen.utilization = 0;
+        for (r = 1; r <= m; r++)
+        {
+            resource = &pathway.resources[r];
+            screen.load[r] = 0;
+            for (s = 1; s <= n; s++)
+                screen.load[r] += during[r][s] * service[s] + (carried[r][s] + boarded[r][s]) * screen.wait[s];
+            if (screen.load[r] > 0 && screen.load[r] >= resource->capacity)
+                screen.stable = 0;
+            if (screen.load[r] > 0 && screen.load[r] / resource->capacity >= screen.utilization)
+            {
+                screen.utilization = screen.load[r] / resource->capacity;
+                screen.bottleneck  = r;
+            }
+        }
+        if (!screen.stable)
+            break;
+
+        for (change = 0, s = 1; s <= n; s++)
+        {
+            stage = &pathway.stages[s];
+            if (stage->kind != STAGE_SERVICE)
+                continue;
+            /* M/G/c waits, by Allen and Cunneen's correction of M/M/c. */
+            for (wait = 0, k = 0; k < stage->num_seize; k++)
+            {
+                r = stage->seize[k];
+                resource = &pathway.resources[r];
+                if (seized[r] == 0 || screen.load[r] == 0)
+                    continue;
+                hold = screen.load[r] / seized[r];
+                wait += erlang_c(resource->capacity, screen.load[r]) * hold / (resource->capacity - screen.load[r]) *
+                        (1 + spreads[r] / seized[r] / (hold * hold)) / 2;
+            }
+            change = fmax(change, fabs(wait - screen.wait[s]));
+            screen.wait[s] = wait;
+        }
+        if (change < 1e-6)
+            break;
+    }
+
+    for (screen.events = 0, s = 1; s <= n; s++)
+    {
+        screen.waiting[s] = screen.stable ? screen.visits[s] * screen.wait[s] : INFINITY;
+        if (pathway.stages[s].kind != STAGE_EXIT)
+            screen.events += screen.visits[s] / arrivals;
+    }
+    screen.screened = 1;
+
+unscreened:
+    for (p = 1; p <= n; p++)
+        free(route[p]);
+    for (r = 1; r <= m; r++)
+    {
+        free(during[r]);
+        free(carried[r]);
+        free(boarded[r]);
+    }
+    free(route);
+    free(during);
+    free(carried);
+    free(boarded);
+    free(zero);
+    free(one);
+    free(external);
+    free(service);
+    free(spread);
+    free(spreads);
+    free(seized);
+    free(pass);
+    free(source);
+    return screen.screened ? 0 : -1;
+}
+
+long screen_patients(long goal) /* Run length for the approximated pathway */
+{
+    double busy;
+
+    if (screen.min_patients == 0 || !screen.screened)
+        return goal;
+    if (!screen.stable)
+        return screen.max_patients;
+    busy = screen.min_patients / ((1 - screen.utilization) * (1 - screen.utilization));
+    return busy < screen.max_patients ? (long) busy : screen.max_patients;
+}
+
+void screen_free(void) /* Forget the section and the approximation */
+{
+    free(screen.visits);
+    free(screen.wait);
+    free(screen.waiting);
+    free(screen.load);
+    memset(&screen, 0, sizeof(screen));
+}
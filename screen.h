@@ -0,0 +1,53 @@
+/* This is screen.h.  An analytic approximation of a compiled pathway, used
+   to screen the scenarios of a batch before simulating them.
+
+   Visit rates of the stages solve the traffic equations of the routes, and
+   the patients holding each resource through each stage solve them again
+   from the stages that seize it to those that release it.  A resource's
+   load, the mean units in use, is then the holding rate times the service
+   time of every stage it is held through, plus the waits for the stages it
+   is held (or boarded) across.  A stage waits for each resource it seizes
+   as an M/G/c queue with the resource's load and capacity, by Erlang C with
+   Allen and Cunneen's correction for the spread of the holding times, and
+   since waits add to loads, the two are iterated to a fixed point.  Fast-track stages
+   are shortened by the chance of a normal severity draw passing their
+   threshold;  patience, diversion and transfers are ignored.
+
+   A pathway is unstable when some resource's load reaches its capacity.  A
+   [screen] section then lets a batch skip such scenarios (or just flag
+   them), run the most expensive first, and choose run lengths that grow as
+   1/(1 - utilization)^2 with the busiest resource, which keeps the relative
+   precision of the estimates about even across a sweep.  The report of a
+   simulated scenario compares the approximation with the simulation. */
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include "pathway.h"
+#include "config.h"
+
+struct screen {
+    int    enabled;             /* A [screen] section was given... */
+    int    skip_unstable;       /* ...to skip unstable scenarios, not flag them... */
+    long   min_patients;        /* ...and to scale run lengths from this... */
+    long   max_patients;        /* ...up to this, 0 to keep them. */
+
+    int    screened;            /* The pathway has an approximation:  no traces. */
+    int    stable;
+    int    bottleneck;          /* The busiest resource... */
+    double utilization;         /* ...its load over its capacity. */
+    double *visits;             /* Patients per minute into stages 1..num_stages. */
+    double *wait;               /* Minutes waited for each stage... */
+    double *waiting;            /* ...and patients waiting for it. */
+    double *load;               /* Units in use of resources 1..num_resources. */
+    double events;              /* Events per patient. */
+};
+
+extern SIMLIB_LOCAL struct screen screen;
+
+extern int   screen_load(struct config *cfg, struct config_section *section);
+extern int   screen_approximate(void);
+extern long  screen_patients(long goal);
+extern void  screen_free(void);
+
+#endif
@@ -0,0 +1,244 @@
+/* This is sensitivity.c.  Derivatives by perturbation analysis, described in
+   sensitivity.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sensitivity.h"
+
+SIMLIB_LOCAL struct sensitivity sensitivity;
+
+static int referenced(int param, int kind) /* Stages of a kind (0 for any) with this mean or rate */
+{
+    int i, n = 0;
+
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        n += pathway.stages[i].duration.param == param && pathway.stages[i].trace.path == NULL &&
+             (kind == 0 || pathway.stages[i].kind == kind);
+    }
+    return n;
+}
+
+static void add_param(struct param params[], int param) /* Differentiate by one more parameter */
+{
+    int n = sensitivity.num_params++;
+
+    sensitivity.params = (int *) realloc(sensitivity.params, (n + 1) * sizeof(int));
+    sensitivity.names  = realloc(sensitivity.names, (n + 1) * sizeof(*sensitivity.names));
+    sensitivity.values = (float *) realloc(sensitivity.values, (n + 1) * sizeof(float));
+    sensitivity.rates  = (int *) realloc(sensitivity.rates, (n + 1) * sizeof(int));
+    sensitivity.params[n] = param;
+    strcpy(sensitivity.names[n], params[param - 1].name);
+    sensitivity.values[n] = params[param - 1].value;
+    sensitivity.rates[n]  = referenced(param, STAGE_ARRIVAL) > 0;
+}
+
+int sensitivity_load(struct config *cfg, struct config_section *section,
+                     struct param params[], int num_params)
+{
+
+/* The [sensitivity] section, or none:  the parameters it names, or every
+   parameter that is the mean or rate of some stage's durations, and the
+   window of the rates.  Returns 0, or -1 after printing the error. */
+
+    char  copy[CONFIG_LINE_LIMIT], *word, *text, *end;
+    int   i;
+
+    sensitivity_free();
+    if (section == NULL)
+        return 0;
+
+    sensitivity.window = 480;
+    if ((text = config_value(cfg, section, "window")) != NULL &&
+        ((sensitivity.window = strtod(text, &end), end == text || *end != '\0') || !(sensitivity.window > 0)))
+    {
+        printf("CONFIG ERROR: %s:%d: [sensitivity] \"window\" Must Be Positive Minutes\n", cfg->origin, section->line);
+        return -1;
+    }
+    if ((text = config_value(cfg, section, "parameters")) == NULL)
+    {
+        for (i = 1; i <= num_params; i++)
+        {
+            if (referenced(i, 0))
+                add_param(params, i);
+        }
+        return 0;
+    }
+    strncpy(copy, text, CONFIG_LINE_LIMIT - 1);
+    copy[CONFIG_LINE_LIMIT - 1] = '\0';
+    for (word = strtok(copy, " \t,"); word != NULL; word = strtok(NULL, " \t,"))
+    {
+        for (i = 1; i <= num_params && strcmp(params[i - 1].name, word) != 0; i++)
+            ;
+        if (i > num_params || !referenced(i, 0))
+        {
+            printf("CONFIG ERROR: %s:%d: [sensitivity] \"%s\" Is Not The Mean Or Rate Of Any Stage\n",
+                   cfg->origin, section->line, word);
+            sensitivity_free();
+            return -1;
+        }
+        add_param(params, i);
+    }
+    return 0;
+}
+
+void sensitivity_level(timest_var variable) /* Differentiate the average of one more level */
+{
+    sensitivity.levels = (timest_var *) realloc(sensitivity.levels,
+                                                (sensitivity.num_levels + 1) * sizeof(timest_var));
+    sensitivity.levels[sensitivity.num_levels++] = variable;
+}
+
+static double *derivatives(struct stage *stage, int p) /* Of the time of the stage's or patient's event */
+{
+    if (stage->kind == STAGE_PATIENCE)
+        return &sensitivity.patience[p * sensitivity.num_params];
+    if (stage->kind == STAGE_ARRIVAL)
+        return &sensitivity.arrivals[stage->type * sensitivity.num_params];
+    return &sensitivity.completions[p * sensitivity.num_params];
+}
+
+static void schedule(struct stage *stage, int p, float duration) /* on_schedule:  the event's derivatives */
+{
+    int    n = sensitivity.num_params, j;
+    double *d;
+
+    if (p > sensitivity.max_patients)
+    {
+        sensitivity.max_patients = pathway.max_patients;
+        sensitivity.completions = (double *) realloc(sensitivity.completions,
+                                                     (pathway.max_patients + 1) * n * sizeof(double));
+        sensitivity.patience    = (double *) realloc(sensitivity.patience,
+                                                     (pathway.max_patients + 1) * n * sizeof(double));
+    }
+    d = derivatives(stage, p);
+
+    /* Times replayed from a log do not move;  others move with the event
+       scheduling them, plus their own draw unless it was cut to the minimum
+       or is an interarrival time, left to the likelihood ratio. */
+    if (stage->trace.path != NULL)
+    {
+        memset(d, 0, n * sizeof(double));
+        return;
+    }
+    memcpy(d, sensitivity.clock, n * sizeof(double));
+    if (stage->duration.param == 0 || stage->kind != STAGE_SERVICE || duration <= pathway.min_duration)
+        return;
+    for (j = 0; j < n; j++)
+    {
+        if (sensitivity.params[j] != stage->duration.param)
+            continue;
+        switch (stage->duration.dist)
+        {
+            case DIST_EXPON:
+            case DIST_ERLANG:
+                d[j] += duration / sensitivity.values[j];
+                break;
+            case DIST_NORMAL:
+            case DIST_CONSTANT:
+                d[j] += 1;
+                break;
+        }
+    }
+}
+
+void sensitivity_start(void) /* Start from zero derivatives, before the first arrivals are scheduled */
+{
+    int n = sensitivity.num_params;
+
+    if (n == 0)
+        return;
+    sensitivity.clock    = (double *) realloc(sensitivity.clock, n * sizeof(double));
+    sensitivity.area     = (double *) realloc(sensitivity.area, sensitivity.num_levels * n * sizeof(double));
+    sensitivity.arrivals = (double *) realloc(sensitivity.arrivals, (pathway.num_stages + 2) * n * sizeof(double));
+    memset(sensitivity.clock, 0, n * sizeof(double));
+    memset(sensitivity.area, 0, sensitivity.num_levels * n * sizeof(double));
+    memset(sensitivity.arrivals, 0, (pathway.num_stages + 2) * n * sizeof(double));
+    sensitivity.max_patients = -1;
+    sensitivity.recent       = (double *) realloc(sensitivity.recent, n * sizeof(double));
+    sensitivity.recent_area  = (double *) realloc(sensitivity.recent_area, n * sizeof(double));
+    sensitivity.product_area = (double *) realloc(sensitivity.product_area,
+                                                  sensitivity.num_levels * n * sizeof(double));
+    memset(sensitivity.recent, 0, n * sizeof(double));
+    memset(sensitivity.recent_area, 0, n * sizeof(double));
+    memset(sensitivity.product_area, 0, sensitivity.num_levels * n * sizeof(double));
+    sensitivity.last = sim_time;
+    pathway.on_schedule = schedule;
+}
+
+void sensitivity_event(void)
+{
+
+/* Add the gap up to the current event to the areas' derivatives, and to the
+   areas of the tapered arrival counts and their products with the levels,
+   then count the event if it is an arrival. */
+
+    int    n = sensitivity.num_params, type = next_event_type, v, j;
+    float  level;
+    double *d, decay, integral;
+    struct stage *stage;
+
+    if (type < 1 || type > pathway.num_stages + 1)
+        return;
+    stage = &pathway.stages[type];
+    d = derivatives(stage, (int) transfer[ATTR_PATIENT]);
+    decay = exp(-(sim_time - sensitivity.last) / sensitivity.window);
+    for (j = 0; j < n; j++)
+    {
+        if (!sensitivity.rates[j])
+            continue;
+        integral = sensitivity.recent[j] * sensitivity.window * (1 - decay);
+        sensitivity.recent_area[j] += integral;
+        for (v = 0; v < sensitivity.num_levels; v++)
+            sensitivity.product_area[v * n + j] += timest_acc[sensitivity.levels[v].id].preval * integral;
+        sensitivity.recent[j] = sensitivity.recent[j] * decay +
+                                (stage->kind == STAGE_ARRIVAL && stage->duration.param == sensitivity.params[j]);
+    }
+    for (v = 0; v < sensitivity.num_levels; v++)
+    {
+        if ((level = timest_acc[sensitivity.levels[v].id].preval) == 0)
+            continue;
+        for (j = 0; j < n; j++)
+            sensitivity.area[v * n + j] += level * (d[j] - sensitivity.clock[j]);
+    }
+    memcpy(sensitivity.clock, d, n * sizeof(double));
+    sensitivity.last = sim_time;
+}
+
+double sensitivity_derivative(int level, int param) /* Of the level's average up to now */
+{
+    struct timest_acc *acc = &timest_acc[sensitivity.levels[level].id];
+    int    k = level * sensitivity.num_params + param;
+    double average, derivative;
+
+    if (sim_time <= 0)
+        return 0;
+    average = (acc->area + (double) (sim_time - acc->tlvc) * acc->preval) / sim_time;
+    derivative = (sensitivity.area[k] - average * sensitivity.clock[param]) / sim_time;
+
+    /* The covariance of the level with the tapered arrivals, over the rate */
+    if (sensitivity.rates[param])
+        derivative += (sensitivity.product_area[k] - average * sensitivity.recent_area[param]) /
+                      sim_time / sensitivity.values[param];
+    return derivative;
+}
+
+void sensitivity_free(void) /* Stop differentiating and release the derivatives */
+{
+    if (pathway.on_schedule == schedule)
+        pathway.on_schedule = NULL;
+    free(sensitivity.params);
+    free(sensitivity.names);
+    free(sensitivity.values);
+    free(sensitivity.rates);
+    free(sensitivity.levels);
+    free(sensitivity.clock);
+    free(sensitivity.area);
+    free(sensitivity.arrivals);
+    free(sensitivity.completions);
+    free(sensitivity.patience);
+    free(sensitivity.recent);
+    free(sensitivity.recent_area);
+    free(sensitivity.product_area);
+    memset(&sensitivity, 0, sizeof(sensitivity));
+}
@@ -0,0 +1,82 @@
+/* This is sensitivity.h.  Derivatives of a run's averages by the means of
+   stage durations and the rates of arrivals, from the run itself.
+
+   Durations are differentiated by infinitesimal perturbation analysis
+   (IPA).  A draw X of a scale distribution (expon, erlang) with mean m
+   moves by X/m per unit of m;  a normal or constant draw moves with its
+   mean one for one, and a duration cut to the minimum does not move.  Every
+   event is scheduled by some earlier one, so its time moves as that event's
+   time plus its own draw:  the derivative of each event time, one per
+   parameter, is kept with the patient (or arrival stage) whose event it is,
+   set by the pathway's on_schedule hook.  A patient who waits starts when
+   the event freeing the resources happens, and so takes that event's
+   derivative.  The area under a level n(t) is the sum of n times the gaps
+   between events, so its derivative is the sum of n times the differences
+   of their derivatives, added up between each event and the next;  the
+   derivative of the average is then (area' - average * T') / T.
+
+   Arrival rates are not:  a rate moves every later arrival further, and
+   which patient is served first changes far too often along a long run for
+   the path's derivative to be that of the average.  They are
+   differentiated by the likelihood ratio instead.  The score of a Poisson
+   stream with rate r over a window is its arrivals in the window over r,
+   less the window, so the derivative of the average of n is the covariance
+   of n(t) with the arrivals just before t, over r.  The arrivals are
+   counted with weights exp(-age / window), which tapers the window and is
+   integrated exactly between events;  the window must span the time the
+   department takes to forget a busy spell, and longer ones are unbiased
+   further but noisier.
+
+   Routing chances, severities and capacities are not differentiable this
+   way, and the derivatives ignore that a perturbation may change which
+   patient abandons or is diverted. */
+
+#ifndef SENSITIVITY_H
+#define SENSITIVITY_H
+
+#include "simlib.h"
+#include "config.h"
+#include "pathway.h"
+
+struct sensitivity {
+    int    num_params;          /* Parameters differentiated, 0 when not... */
+    int   *params;              /* ...their indices into names, 1-based as in durations... */
+    char (*names)[PATHWAY_NAME_LIMIT];
+    float *values;              /* ...and their values... */
+    int   *rates;               /* ...which are the rates of some arrival stages. */
+    float  window;              /* Minutes the arrival counts taper over. */
+    int    num_levels;          /* Occupancies, then stage queues. */
+    timest_var *levels;
+
+    /* Perturbation analysis of the durations. */
+    double *clock;              /* Derivatives of the current event's time... */
+    double *area;               /* ...and of each level's area, num_params per level. */
+    double *arrivals;           /* Of the next event of stages 1..num_stages... */
+    double *completions;        /* ...and each patient's completion... */
+    double *patience;           /* ...and patience timer, num_params per patient. */
+    int    max_patients;
+
+    /* Likelihood ratio of the rates. */
+    float  last;                /* Time of the last event. */
+    double *recent;             /* Tapered arrivals of each rate up to it... */
+    double *recent_area;        /* ...and their area... */
+    double *product_area;       /* ...and that of their products with each level. */
+};
+
+extern SIMLIB_LOCAL struct sensitivity sensitivity;
+
+extern int   sensitivity_load(struct config *cfg, struct config_section *section,
+                              struct param params[], int num_params);
+extern void  sensitivity_level(timest_var variable);
+extern void  sensitivity_start(void);
+extern void  sensitivity_event(void);
+extern double sensitivity_derivative(int level, int param);
+extern void  sensitivity_free(void);
+
+static inline void sensitivity_advance(void) /* Take up the event timing() just chose */
+{
+    if (sensitivity.num_params > 0)
+        sensitivity_event();
+}
+
+#endif
@@ -0,0 +1,176 @@
+/* This is serve.c.  What-if queries, described in serve.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "serve.h"
+#include "replication.h"
+#include "scenario.h"
+
+SIMLIB_LOCAL struct serve serve;
+
+static int get_count(struct config *cfg, struct config_section *section, const char *key,
+                     int *count, int minimum) /* A whole number of at least minimum, if the key is given */
+{
+    char *text, *end;
+
+    if (section == NULL || (text = config_value(cfg, section, key)) == NULL)
+        return 0;
+    *count = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || *count < minimum)
+    {
+        printf("CONFIG ERROR: %s:%d: [serve] \"%s\" Must Be At Least %d\n", cfg->origin, section->line, key, minimum);
+        return -1;
+    }
+    return 0;
+}
+
+int serve_load(struct config *cfg, struct config_section *section)
+{
+
+/* The [serve] section, or the defaults when there is none.  Returns 0, or
+   -1 after printing the error. */
+
+    char *text, *end;
+
+    memset(&serve, 0, sizeof(serve));
+    serve.warmup       = 2000;
+    serve.snapshots    = 4;
+    serve.spacing      = 250;
+    serve.patients     = 2000;
+    serve.replications = 8;
+    if (get_count(cfg, section, "warmup", &serve.warmup, 0) != 0 ||
+        get_count(cfg, section, "snapshots", &serve.snapshots, 1) != 0 ||
+        get_count(cfg, section, "spacing", &serve.spacing, 1) != 0 ||
+        get_count(cfg, section, "patients", &serve.patients, 1) != 0 ||
+        get_count(cfg, section, "replications", &serve.replications, 1) != 0 ||
+        get_count(cfg, section, "workers", &serve.workers, 0) != 0)
+        return -1;
+    if (section != NULL && (text = config_value(cfg, section, "precision")) != NULL &&
+        ((serve.precision = strtod(text, &end), end == text || *end != '\0') || !(serve.precision > 0)))
+    {
+        printf("CONFIG ERROR: %s:%d: [serve] \"precision\" Must Be Positive\n", cfg->origin, section->line);
+        return -1;
+    }
+    return 0;
+}
+
+int serve_parse(char *line, struct param params[], int num_params,
+                struct serve_query *query, char *error, int size)
+{
+
+/* The changes of a query line, with any patients= and replications= of its
+   own.  Changes are to scenario parameters, checked as in a scenario file.
+   Returns 0, or -1 with the reason in error. */
+
+    char  *word, *value, *end;
+    double number;
+    int    i;
+
+    query->num_changes  = 0;
+    query->patients     = serve.patients;
+    query->replications = serve.replications;
+    for (word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n"))
+    {
+        if ((value = strchr(word, '=')) == NULL)
+        {
+            snprintf(error, size, "\"%s\" Is Not name=value", word);
+            return -1;
+        }
+        *value++ = '\0';
+        if (strcmp(word, "patients") == 0 || strcmp(word, "replications") == 0)
+        {
+            number = strtod(value, &end);
+            if (end == value || *end != '\0' || !(number > 0) || number != floor(number) || number > 1e9)
+            {
+                snprintf(error, size, "\"%s\" Must Be A Positive Whole Number", word);
+                return -1;
+            }
+            *(word[0] == 'p' ? &query->patients : &query->replications) = (int) number;
+            continue;
+        }
+        for (i = 0; i < num_params && strcmp(params[i].name, word) != 0; i++)
+            ;
+        if (i == num_params || i >= NUM_PARAMS || pathway_uses(i + 1) == 0)
+        {
+            snprintf(error, size, "\"%s\" Is Not A Capacity, Mean Or Rate Of The Model", word);
+            return -1;
+        }
+        if (param_parse(&param_specs[i], value, &number) != 0)
+        {
+            snprintf(error, size, "\"%s\" Is Not A Valid %s", value, word);
+            return -1;
+        }
+        if (query->num_changes == SERVE_MAX_CHANGES)
+        {
+            snprintf(error, size, "More Than %d Changes", SERVE_MAX_CHANGES);
+            return -1;
+        }
+        query->params[query->num_changes]   = i + 1;
+        query->values[query->num_changes++] = number;
+    }
+    return 0;
+}
+
+int serve_level(timest_var variable, const char *name, int occupancy) /* Average one more level, -1 if full */
+{
+    if (serve.num_levels == SERVE_MAX_LEVELS)
+        return -1;
+    serve.levels[serve.num_levels] = variable;
+    snprintf(serve.names[serve.num_levels++], PATHWAY_NAME_LIMIT, "%s", name);
+    serve.num_occupancies += occupancy;
+    return 0;
+}
+
+void serve_areas(double area[]) /* Area under each level up to now */
+{
+    struct timest_acc *acc;
+    int    v;
+
+    for (v = 0; v < serve.num_levels; v++)
+    {
+        acc = &timest_acc[serve.levels[v].id];
+        area[v] = acc->area + (double) (sim_time - acc->tlvc) * acc->preval;
+    }
+}
+
+void serve_begin(void) /* No replications of the query yet */
+{
+    serve.count = 0;
+    memset(serve.mean, 0, sizeof(serve.mean));
+    memset(serve.sum_squares, 0, sizeof(serve.sum_squares));
+}
+
+void serve_record(const struct serve_result *result) /* Take up a successful replication */
+{
+    double delta;
+    int    v;
+
+    serve.count++;
+    for (v = 0; v < serve.num_levels; v++)
+    {
+        delta = result->averages[v] - serve.mean[v];
+        serve.mean[v] += delta / serve.count;
+        serve.sum_squares[v] += delta * (result->averages[v] - serve.mean[v]);
+    }
+}
+
+double serve_half_width(int level) /* Of the 95% confidence interval, from two replications on */
+{
+    if (serve.count < 2)
+        return INFINITY;
+    return t_quantile(serve.count - 1) * sqrt(serve.sum_squares[level] / (serve.count - 1) / serve.count);
+}
+
+int serve_converged(void) /* Is every occupancy within the precision of its mean? */
+{
+    int v;
+
+    if (serve.precision <= 0 || serve.count < SERVE_MIN_REPLICATIONS)
+        return 0;
+    for (v = 0; v < serve.num_occupancies; v++)
+    {
+        if (serve_half_width(v) > serve.precision * serve.mean[v])
+            return 0;
+    }
+    return 1;
+}
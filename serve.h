@@ -0,0 +1,80 @@
+/* This is serve.h.  What-if queries answered from a warmed-up state.
+
+   A server warms a scenario up once, copying simlib and the pathway
+   (simlib_save, pathway_save) at each of a few points after the warm-up,
+   and then answers queries.  A query is a line of parameter changes,
+
+       num_nurses=6 mean_walkin_arrival=0.09 replications=16
+
+   each a scenario parameter that sets some capacity, mean duration or
+   arrival rate of the compiled pathway;  patients= and replications=
+   override the run length and count of [serve] for this query only.  Every
+   replication is a process forked from the server, which starts from one of
+   the copies in turn, applies the changes with pathway_adjust, reseeds the
+   stage streams and runs a short way on.  Its averages over that stretch
+   come back in a fixed-size record through a pipe shared by all of them,
+   each written whole since it is shorter than PIPE_BUF.
+
+   The estimates of a query are updated as the records come in, and the
+   query stops early once every occupancy's 95% confidence interval is
+   within the precision of its mean. */
+
+#ifndef SERVE_H
+#define SERVE_H
+
+#include "simlib.h"
+#include "config.h"
+#include "pathway.h"
+
+#define SERVE_MAX_LEVELS        64  /* Occupancies and stage queues reported. */
+#define SERVE_MAX_CHANGES       16  /* Parameter changes of one query. */
+#define SERVE_MIN_REPLICATIONS   3  /* Replications before a query can converge. */
+#define SERVE_MESSAGE_LIMIT     96  /* Error text a failed replication returns. */
+
+struct serve_query {
+    int    number;              /* Queries are numbered from 1 as they arrive. */
+    int    num_changes;
+    int    params[SERVE_MAX_CHANGES];   /* 1-based, as in durations... */
+    float  values[SERVE_MAX_CHANGES];   /* ...and their new values. */
+    int    patients, replications;
+};
+
+struct serve_result {           /* Record of one replication, written to the pipe. */
+    int    query, replication;
+    int    status;              /* 0, or the exit status of the error... */
+    char   message[SERVE_MESSAGE_LIMIT];    /* ...with its text. */
+    float  averages[SERVE_MAX_LEVELS];
+};
+
+struct serve {
+    int    warmup;              /* Patients completed before the first copy... */
+    int    snapshots;           /* ...copies kept... */
+    int    spacing;             /* ...and patients completed between them. */
+    int    patients;            /* Patients completed by each replication. */
+    int    replications;        /* Most replications of a query. */
+    float  precision;           /* Relative half-width that stops a query, 0 for none. */
+    int    workers;             /* Replications run at once, 0 for one per CPU. */
+
+    /* Levels averaged by each replication, the occupancies first. */
+    int    num_levels, num_occupancies;
+    timest_var levels[SERVE_MAX_LEVELS];
+    char   names[SERVE_MAX_LEVELS][PATHWAY_NAME_LIMIT];
+
+    /* Estimates of the current query, by Welford's updates. */
+    int    count;
+    double mean[SERVE_MAX_LEVELS], sum_squares[SERVE_MAX_LEVELS];
+};
+
+extern SIMLIB_LOCAL struct serve serve;
+
+extern int   serve_load(struct config *cfg, struct config_section *section);
+extern int   serve_parse(char *line, struct param params[], int num_params,
+                         struct serve_query *query, char *error, int size);
+extern int   serve_level(timest_var variable, const char *name, int occupancy);
+extern void  serve_areas(double area[]);
+extern void  serve_begin(void);
+extern void  serve_record(const struct serve_result *result);
+extern double serve_half_width(int level);
+extern int   serve_converged(void);
+
+#endif
@@ -1,794 +1,1250 @@
-/* This is simlib.c (adapted from SUPERSIMLIB, written by Gregory Glockner). */
-
-/* Include files. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include "simlibdefs.h"
-
-/* Declare simlib global variables. */
-
-int    *list_rank, *list_size, next_event_type, maxatr = 0, maxlist = 0;
-float  *transfer, sim_time, prob_distrib[26];
-struct master {
-    float  *value;
-    struct master *pr;
-    struct master *sr;
-} **head, **tail;
-
-/* Declare simlib functions. */
-
-void  init_simlib(void);
-void  list_file(int option, int list);
-void  list_remove(int option, int list);
-void  timing(void);
-void  event_schedule(float time_of_event, int type_of_event);
-int   event_cancel(int event_type);
-float sampst(float value, int variable);
-float timest(float value, int variable);
-float filest(int list);
-void  out_sampst(FILE *unit, int lowvar, int highvar);
-void  out_timest(FILE *unit, int lowvar, int highvar);
-void  out_filest(FILE *unit, int lowlist, int highlist);
-void  pprint_out(FILE *unit, int i);
-float expon(float mean, int stream);
-int   random_integer(float prob_distrib[], int stream);
-float uniform(float a, float b, int stream);
-float erlang(int m, float mean, int stream);
-float lcgrand(int stream);
-void  lcgrandst(long zset, int stream);
-long  lcgrandgt(int stream);
-
-
-void init_simlib()
-{
-
-/* Initialize simlib.c.  List LIST_EVENT is reserved for event list, ordered by
-   event time.  init_simlib must be called from main by user. */
-
-    int list, listsize;
-
-    if (maxlist < 1) maxlist = MAX_LIST;
-    listsize = maxlist + 1;
-
-    /* Initialize system attributes. */
-
-    sim_time = 0.0;
-    if (maxatr < 4) maxatr = MAX_ATTR;
-
-    /* Allocate space for the lists. */
-
-    list_rank = (int *)            calloc(listsize,   sizeof(int));
-    list_size = (int *)            calloc(listsize,   sizeof(int));
-    head      = (struct master **) calloc(listsize,   sizeof(struct master *));
-    tail      = (struct master **) calloc(listsize,   sizeof(struct master *));
-    transfer  = (float *)          calloc(maxatr + 1, sizeof(float));
-
-    /* Initialize list attributes. */
-
-    for(list = 1; list <= maxlist; ++list) {
-        head [list]     = NULL;
-        tail [list]     = NULL;
-        list_size[list] = 0;
-        list_rank[list] = 0;
-    }
-
-    /* Set event list to be ordered by event time. */
-
-    list_rank[LIST_EVENT] = EVENT_TIME;
-
-    /* Initialize statistical routines. */
-
-    sampst(0.0, 0);
-    timest(0.0, 0);
-}
-
-
-void list_file(int option, int list)
-{
-
-/* Place transfr into list "list".
-   Update timest statistics for the list.
-   option = FIRST place at start of list
-            LAST  place at end of list
-            INCREASING  place in increasing order on attribute list_rank(list)
-            DECREASING  place in decreasing order on attribute list_rank(list)
-            (ties resolved by FIFO) */
-
-    struct master *row, *ahead, *behind, *ihead, *itail;
-    int    item, postest;
-
-    /* If the list value is improper, stop the simulation. */
-
-    if(!((list >= 0) && (list <= MAX_LIST))) {
-        printf("\nInvalid list %d for list_file at time %f\n", list, sim_time);
-        exit(1);
-    }
-
-    /* Increment the list size. */
-
-    list_size[list]++;
-
-    /* If the option value is improper, stop the simulation. */
-
-    if(!((option >= 1) && (option <= DECREASING))) {
-        printf(
-            "\n%d is an invalid option for list_file on list %d at time %f\n",
-            option, list, sim_time);
-        exit(1);
-    }
-
-    /* If this is the first record in this list, just make space for it. */
-
-    if(list_size[list] == 1) {
-
-        row        = (struct master *) malloc(sizeof(struct master));
-        head[list] = row ;
-        tail[list] = row ;
-        (*row).pr  = NULL;
-        (*row).sr  = NULL;
-    }
-
-    else { /* There are other records in the list. */
-
-        /* Check the value of option. */
-
-        if ((option == INCREASING) || (option == DECREASING)) {
-            item = list_rank[list];
-            if(!((item >= 1) && (item <= maxatr))) {
-                printf(
-                    "%d is an improper value for rank of list %d at time %f\n",
-                    item, list, sim_time) ;
-                exit(1);
-            }
-
-            row    = head[list];
-            behind = NULL; /* Dummy value for the first iteration. */
-
-            /* Search for the correct location. */
-
-            if (option == INCREASING) {
-                postest = (transfer[item] >= (*row).value[item]);
-                while (postest) {
-                    behind  = row;
-                    row     = (*row).sr;
-                    postest = (behind != tail[list]);
-                    if (postest)
-                        postest = (transfer[item] >= (*row).value[item]);
-                }
-            }
-
-            else {
-
-                postest = (transfer[item] <= (*row).value[item]);
-                while (postest) {
-                    behind  = row;
-                    row     = (*row).sr;
-                    postest = (behind != tail[list]);
-                    if (postest)
-                        postest = (transfer[item] <= (*row).value[item]);
-                }
-            }
-
-            /* Check to see if position is first or last.  If so, take care of
-               it below. */
-
-            if (row == head[list])
-
-                option = FIRST;
-
-            else
-
-                if (behind == tail[list])
-
-                    option = LAST;
-
-                else { /* Insert between preceding and succeeding records. */
-
-                    ahead        = (*behind).sr;
-                    row          = (struct master *)
-                                        malloc(sizeof(struct master));
-                    (*row).pr    = behind;
-                    (*behind).sr = row;
-                    (*ahead).pr  = row;
-                    (*row).sr    = ahead;
-                }
-        } /* End if inserting in increasing or decreasing order. */
-
-        if (option == FIRST) {
-            row         = (struct master *) malloc(sizeof(struct master));
-            ihead       = head[list];
-            (*ihead).pr = row;
-            (*row).sr   = ihead;
-            (*row).pr   = NULL;
-            head[list]  = row;
-        }
-        if (option == LAST) {
-            row         = (struct master *) malloc(sizeof(struct master));
-            itail       = tail[list];
-            (*row).pr   = itail;
-            (*itail).sr = row;
-            (*row).sr   = NULL;
-            tail[list]  = row;
-        }
-    }
-
-    /* Copy the row values from the transfer array. */
-
-    (*row).value = (float *) calloc(maxatr + 1, sizeof(float));
-    for (item = 0; item <= maxatr; ++item)
-        (*row).value[item] = transfer[item];
-
-
-    /* Update the area under the number-in-list curve. */
-
-    timest((float)list_size[list], TIM_VAR + list);
-}
-
-
-void list_remove(int option, int list)
-{
-
-/* Remove a record from list "list" and copy attributes into transfer.
-   Update timest statistics for the list.
-   option = FIRST remove first record in the list
-            LAST  remove last record in the list */
-
-    struct master *row, *ihead, *itail;
-
-    /* If the list value is improper, stop the simulation. */
-
-    if(!((list >= 0) && (list <= MAX_LIST))) {
-        printf("\nInvalid list %d for list_remove at time %f\n",
-               list, sim_time);
-        exit(1);
-    }
-
-    /* If the list is empty, stop the simulation. */
-
-    if(list_size[list] <= 0) {
-        printf("\nUnderflow of list %d at time %f\n", list, sim_time);
-        exit(1);
-    }
-
-    /* Decrement the list size. */
-
-    list_size[list]--;
-
-    /* If the option value is improper, stop the simulation. */
-
-    if(!(option == FIRST || option == LAST)) {
-        printf(
-            "\n%d is an invalid option for list_remove on list %d at time %f\n",
-            option, list, sim_time);
-        exit(1);
-    }
-
-    if(list_size[list] == 0) {
-
-        /* There is only 1 record, so remove it. */
-
-        row        = head[list];
-        head[list] = NULL;
-        tail[list] = NULL;
-    }
-
-    else {
-
-        /* There is more than 1 record, so remove according to the desired
-           option. */
-
-        switch(option) {
-
-            /* Remove the first record in the list. */
-
-            case FIRST:
-                row         = head[list];
-                ihead       = (*row).sr;
-                (*ihead).pr = NULL;
-                head[list]  = ihead;
-                break;
-
-            /* Remove the last record in the list. */
-
-            case LAST:
-                row         = tail[list];
-                itail       = (*row).pr;
-                (*itail).sr = NULL;
-                tail[list]  = itail;
-                break;
-        }
-    }
-
-    /* Copy the data and free memory. */
-
-    free((char *)transfer);
-    transfer = (*row).value;
-    free((char *)row);
-
-    /* Update the area under the number-in-list curve. */
-
-    timest((float)list_size[list], TIM_VAR + list);
-}
-
-
-void timing()
-{
-
-/* Remove next event from event list, placing its attributes in transfer.
-   Set sim_time (simulation time) to event time, transfer[1].
-   Set next_event_type to this event type, transfer[2]. */
-
-    /* Remove the first event from the event list and put it in transfer[]. */
-
-    list_remove(FIRST, LIST_EVENT);
-
-    /* Check for a time reversal. */
-
-    if(transfer[EVENT_TIME] < sim_time) {
-        printf(
-            "\nAttempt to schedule event type %f for time %f at time %f\n",
-            transfer[EVENT_TYPE], transfer[EVENT_TIME], sim_time);
-        exit(1);
-    }
-
-    /* Advance the simulation clock and set the next event type. */
-
-    sim_time        = transfer[EVENT_TIME];
-    next_event_type = transfer[EVENT_TYPE];
-}
-
-
-void event_schedule(float time_of_event, int type_of_event)
-{
-
-/* Schedule an event at time event_time of type event_type.  If attributes
-   beyond the first two (reserved for the event time and the event type) are
-   being used in the event list, it is the user's responsibility to place their
-   values into the transfer array before invoking event_schedule. */
-
-    transfer[EVENT_TIME] = time_of_event;
-    transfer[EVENT_TYPE] = type_of_event;
-    list_file(INCREASING, LIST_EVENT);
-}
-
-
-int event_cancel(int event_type)
-{
-
-/* Remove the first event of type event_type from the event list, leaving its
-   attributes in transfer.  If something is cancelled, event_cancel returns 1;
-   if no match is found, event_cancel returns 0. */
-
-    struct       master *row, *ahead, *behind;
-    static float high, low, value;
-
-    /* If the event list is empty, do nothing and return 0. */
-
-    if(list_size[LIST_EVENT] == 0) return 0;
-
-    /* Search the event list. */
-
-    row   = head[LIST_EVENT];
-    low   = event_type - EPSILON;
-    high  = event_type + EPSILON;
-    value = (*row).value[EVENT_TYPE] ;
-
-    while (((value <= low) || (value >= high)) && (row != tail[LIST_EVENT])) {
-        row   = (*row).sr;
-        value = (*row).value[EVENT_TYPE];
-    }
-
-    /* Check to see if this is the end of the event list. */
-
-    if (row == tail[LIST_EVENT]) {
-
-        /* Double check to see that this is a match. */
-
-        if ((value > low) && (value < high)) {
-            list_remove(LAST, LIST_EVENT);
-            return 1;
-        }
-
-        else /* no match */
-            return 0;
-    }
-
-    /* Check to see if this is the head of the list.  If it is at the head, then
-       it MUST be a match. */
-
-    if (row == head[LIST_EVENT]) {
-        list_remove(FIRST, LIST_EVENT);
-        return 1;
-    }
-
-    /* Else remove this event somewhere in the middle of the event list. */
-
-    /* Update pointers. */
-
-    ahead        = (*row).sr;
-    behind       = (*row).pr;
-    (*behind).sr = ahead;
-    (*ahead).pr  = behind;
-
-    /* Decrement the size of the event list. */
-
-    list_size[LIST_EVENT]--;
-
-    /* Copy and free memory. */
-
-    free((char *)transfer);       /* Free the old transfer. */
-    transfer = (*row).value;      /* Transfer the data. */
-    free((char *)row);            /* Free the space vacated by row. */
-
-    /* Update the area under the number-in-event-list curve. */
-
-    timest((float)list_size[LIST_EVENT], TIM_VAR + LIST_EVENT);
-    return 1;
-}
-
-
-float sampst(float value, int variable)
-{
-
-/* Initialize, update, or report statistics on discrete-time processes:
-   sum/average, max (default -1E30), min (default 1E30), number of observations
-   for sampst variable "variable", where "variable":
-       = 0 initializes accumulators
-       > 0 updates sum, count, min, and max accumulators with new observation
-       < 0 reports stats on variable "variable" and returns them in transfer:
-           [1] = average of observations
-           [2] = number of observations
-           [3] = maximum of observations
-           [4] = minimum of observations */
-
-    static int   ivar, num_observations[SVAR_SIZE];
-    static float max[SVAR_SIZE], min[SVAR_SIZE], sum[SVAR_SIZE];
-
-    /* If the variable value is improper, stop the simulation. */
-
-    if(!(variable >= -MAX_SVAR) && (variable <= MAX_SVAR)) {
-        printf("\n%d is an improper value for a sampst variable at time %f\n",
-            variable, sim_time);
-        exit(1);
-    }
-
-    /* Execute the desired option. */
-
-    if(variable > 0) { /* Update. */
-        sum[variable] += value;
-        if(value > max[variable]) max[variable] = value;
-        if(value < min[variable]) min[variable] = value;
-        num_observations[variable]++;
-        return 0.0;
-    }
-
-    if(variable < 0) { /* Report summary statistics in transfer. */
-        ivar        = -variable;
-        transfer[2] = (float) num_observations[ivar];
-        transfer[3] = max[ivar];
-        transfer[4] = min[ivar];
-        if(num_observations[ivar] == 0)
-            transfer[1] = 0.0;
-        else
-            transfer[1] = sum[ivar] / transfer[2];
-        return transfer[1];
-    }
-
-    /* Initialize the accumulators. */
-
-    for(ivar=1; ivar <= MAX_SVAR; ++ivar) {
-        sum[ivar]              = 0.0;
-        max[ivar]              = -INFINITY;
-        min[ivar]              =  INFINITY;
-        num_observations[ivar] = 0;
-    }
-}
-
-
-float timest(float value, int variable)
-{
-
-/* Initialize, update, or report statistics on continuous-time processes:
-   integral/average, max (default -1E30), min (default 1E30)
-   for timest variable "variable", where "variable":
-       = 0 initializes counters
-       > 0 updates area, min, and max accumulators with new level of variable
-       < 0 reports stats on variable "variable" and returns them in transfer:
-           [1] = time-average of variable updated to the time of this call
-           [2] = maximum value variable has attained
-           [3] = minimum value variable has attained
-   Note that variables TIM_VAR + 1 through TVAR_SIZE are used for automatic
-   record keeping on the length of lists 1 through MAX_LIST. */
-
-    int          ivar;
-    static float area[TVAR_SIZE], max[TVAR_SIZE], min[TVAR_SIZE],
-                 preval[TVAR_SIZE], tlvc[TVAR_SIZE], treset;
-
-    /* If the variable value is improper, stop the simulation. */
-
-    if(!(variable >= -MAX_TVAR) && (variable <= MAX_TVAR)) {
-        printf("\n%d is an improper value for a timest variable at time %f\n",
-            variable, sim_time);
-        exit(1);
-    }
-
-    /* Execute the desired option. */
-
-    if(variable > 0) { /* Update. */
-        area[variable] += (sim_time - tlvc[variable]) * preval[variable];
-        if(value > max[variable]) max[variable] = value;
-        if(value < min[variable]) min[variable] = value;
-        preval[variable] = value;
-        tlvc[variable]   = sim_time;
-        return 0.0;
-    }
-
-    if(variable < 0) { /* Report summary statistics in transfer. */
-        ivar         = -variable;
-        area[ivar]   += (sim_time - tlvc[ivar]) * preval[ivar];
-        tlvc[ivar]   = sim_time;
-        transfer[1]  = area[ivar] / (sim_time - treset);
-        transfer[2]  = max[ivar];
-        transfer[3]  = min[ivar];
-        return transfer[1];
-    }
-
-    /* Initialize the accumulators. */
-
-    for(ivar = 1; ivar <= MAX_TVAR; ++ivar) {
-        area[ivar]   = 0.0;
-        max[ivar]    = -INFINITY;
-        min[ivar]    =  INFINITY;
-        preval[ivar] = 0.0;
-        tlvc[ivar]   = sim_time;
-    }
-    treset = sim_time;
-}
-
-
-float filest(int list)
-{
-
-/* Report statistics on the length of list "list" in transfer:
-       [1] = time-average of list length updated to the time of this call
-       [2] = maximum length list has attained
-       [3] = minimum length list has attained
-   This uses timest variable TIM_VAR + list. */
-
-    return timest(0.0, -(TIM_VAR + list));
-}
-
-
-void out_sampst(FILE *unit, int lowvar, int highvar)
-{
-
-/* Write sampst statistics for variables lowvar through highvar on file
-   "unit". */
-
-    int ivar, iatrr;
-
-    if(lowvar>highvar || lowvar > MAX_SVAR || highvar > MAX_SVAR) return;
-
-    fprintf(unit, "\n sampst                         Number");
-    fprintf(unit, "\nvariable                          of");
-    fprintf(unit, "\n number       Average           values          Maximum");
-    fprintf(unit, "          Minimum");
-    fprintf(unit, "\n___________________________________");
-    fprintf(unit, "_____________________________________");
-    for(ivar = lowvar; ivar <= highvar; ++ivar) {
-        fprintf(unit, "\n\n%5d", ivar);
-        sampst(0.00, -ivar);
-        for(iatrr = 1; iatrr <= 4; ++iatrr) pprint_out(unit, iatrr);
-    }
-    fprintf(unit, "\n___________________________________");
-    fprintf(unit, "_____________________________________\n\n\n");
-}
-
-
-void out_timest(FILE *unit, int lowvar, int highvar)
-{
-
-/* Write timest statistics for variables lowvar through highvar on file
-   "unit". */
-
-    int ivar, iatrr;
-
-    if(lowvar > highvar || lowvar > TIM_VAR || highvar > TIM_VAR ) return;
-
-
-    fprintf(unit, "\n  timest");
-    fprintf(unit, "\n variable       Time");
-    fprintf(unit, "\n  number       average          Maximum          Minimum");
-    fprintf(unit, "\n________________________________________________________");
-    for(ivar = lowvar; ivar <= highvar; ++ivar) {
-        fprintf(unit, "\n\n%5d", ivar);
-        timest(0.00, -ivar);
-        for(iatrr = 1; iatrr <= 3; ++iatrr) pprint_out(unit, iatrr);
-    }
-    fprintf(unit, "\n________________________________________________________");
-    fprintf(unit, "\n\n\n");
-}
-
-
-void out_filest(FILE *unit, int lowlist, int highlist)
-{
-
-/* Write timest list-length statistics for lists lowlist through highlist on
-   file "unit". */
-
-    int list, iatrr;
-
-    if(lowlist > highlist || lowlist > MAX_LIST || highlist > MAX_LIST) return;
-
-    fprintf(unit, "\n  File         Time");
-    fprintf(unit, "\n number       average          Maximum          Minimum");
-    fprintf(unit, "\n_______________________________________________________");
-    for(list = lowlist; list <= highlist; ++list) {
-        fprintf(unit, "\n\n%5d", list);
-        filest(list);
-        for(iatrr = 1; iatrr <= 3; ++iatrr) pprint_out(unit, iatrr);
-    }
-    fprintf(unit, "\n_______________________________________________________");
-    fprintf(unit, "\n\n\n");
-}
-
-
-void pprint_out(FILE *unit, int i) /* Write ith entry in transfer to file
-                                      "unit". */
-{
-    if(transfer[i] == -1e30 || transfer[i] == 1e30)
-        fprintf(unit," %#15.6G ", 0.00);
-    else
-        fprintf(unit," %#15.6G ", transfer[i]);
-}
-
-
-float expon(float mean, int stream) /* Exponential variate generation
-                                       function. */
-{
-    return -mean * log(lcgrand(stream));
-
-}
-
-
-int random_integer(float prob_distrib[], int stream) /* Discrete-variate
-                                                        generation function. */
-{
-    int   i;
-    float u;
-
-    u = lcgrand(stream);
-
-    for (i = 1; u >= prob_distrib[i]; ++i)
-        ;
-    return i;
-}
-
-
-float uniform(float a, float b, int stream) /* Uniform variate generation
-                                               function. */
-{
-    return a + lcgrand(stream) * (b - a);
-}
-
-
-float erlang(int m, float mean, int stream)  /* Erlang variate generation
-                                                function. */
-{
-    int   i;
-    float mean_exponential, sum;
-
-    mean_exponential = mean / m;
-    sum = 0.0;
-    for (i = 1; i <= m; ++i)
-        sum += expon(mean_exponential, stream);
-    return sum;
-}
-
-float normal(float m, int stream) /* Normal distribution centered at m with
-                                     a standard deviation of 1*/
-{
-    float a, b;
-    a = uniform(0, 1, stream);
-    b = uniform(0, 1, stream);
-
-    float Z = (float)(sqrt(-2 * log((double)a)) * cos(2 * M_PI * (double)b));
-    return Z + m;
-}
-
-
-/* Prime modulus multiplicative linear congruential generator
-
-   Z[i] = (630360016 * Z[i-1]) (mod(pow(2,31) - 1)), based on Marse and
-   Roberts' portable FORTRAN random-number generator UNIRAN.  Multiple
-   (100) streams are supported, with seeds spaced 100,000 apart.
-   Throughout, input argument "stream" must be an int giving the
-   desired stream number.  The header file lcgrand.h must be included in
-   the calling program (#include "lcgrand.h") before using these
-   functions.
-
-   Usage: (Three functions)
-
-   1. To obtain the next U(0,1) random number from stream "stream,"
-      execute
-          u = lcgrand(stream);
-      where lcgrand is a float function.  The float variable u will
-      contain the next random number.
-
-   2. To set the seed for stream "stream" to a desired value zset,
-      execute
-          lcgrandst(zset, stream);
-      where lcgrandst is a void function and zset must be a long set to
-      the desired seed, a number between 1 and 2147483646 (inclusive). 
-      Default seeds for all 100 streams are given in the code.
-
-   3. To get the current (most recently used) integer in the sequence
-      being generated for stream "stream" into the long variable zget,
-      execute
-          zget = lcgrandgt(stream);
-      where lcgrandgt is a long function. */
-
-/* Define the constants. */
-
-#define MODLUS 2147483647
-#define MULT1       24112
-#define MULT2       26143
-
-/* Set the default seeds for all 100 streams. */
-
-static long zrng[] =
-{         1,
- 1973272912, 281629770,  20006270,1280689831,2096730329,1933576050,
-  913566091, 246780520,1363774876, 604901985,1511192140,1259851944,
-  824064364, 150493284, 242708531,  75253171,1964472944,1202299975,
-  233217322,1911216000, 726370533, 403498145, 993232223,1103205531,
-  762430696,1922803170,1385516923,  76271663, 413682397, 726466604,
-  336157058,1432650381,1120463904, 595778810, 877722890,1046574445,
-   68911991,2088367019, 748545416, 622401386,2122378830, 640690903,
- 1774806513,2132545692,2079249579,  78130110, 852776735,1187867272,
- 1351423507,1645973084,1997049139, 922510944,2045512870, 898585771,
-  243649545,1004818771, 773686062, 403188473, 372279877,1901633463,
-  498067494,2087759558, 493157915, 597104727,1530940798,1814496276,
-  536444882,1663153658, 855503735,  67784357,1432404475, 619691088,
-  119025595, 880802310, 176192644,1116780070, 277854671,1366580350,
- 1142483975,2026948561,1053920743, 786262391,1792203830,1494667770,
- 1923011392,1433700034,1244184613,1147297105, 539712780,1545929719,
-  190641742,1645390429, 264907697, 620389253,1502074852, 927711160,
-  364849192,2049576050, 638580085, 547070247 };
-
-/* Generate the next random number. */
-
-float lcgrand(int stream)
-{
-    long zi, lowprd, hi31;
-
-    zi     = zrng[stream];
-    lowprd = (zi & 65535) * MULT1;
-    hi31   = (zi >> 16) * MULT1 + (lowprd >> 16);
-    zi     = ((lowprd & 65535) - MODLUS) +
-             ((hi31 & 32767) << 16) + (hi31 >> 15);
-    if (zi < 0) zi += MODLUS;
-    lowprd = (zi & 65535) * MULT2;
-    hi31   = (zi >> 16) * MULT2 + (lowprd >> 16);
-    zi     = ((lowprd & 65535) - MODLUS) +
-             ((hi31 & 32767) << 16) + (hi31 >> 15);
-    if (zi < 0) zi += MODLUS;
-    zrng[stream] = zi;
-    return (zi >> 7 | 1) / 16777216.0;
-}
-
-
-void lcgrandst (long zset, int stream) /* Set the current zrng for stream
-                                          "stream" to zset. */
-{
-    zrng[stream] = zset;
-}
-
-
-long lcgrandgt (int stream) /* Return the current zrng for stream "stream". */
-{
-    return zrng[stream];
-}
-
+/* This is simlib.c (adapted from SUPERSIMLIB, written by Gregory Glockner). */
+
+/* Include files. */
+
+#include <string.h>
+#include "simlib.h"
+
+/* Declare simlib global variables. */
+
+SIMLIB_LOCAL int    *list_rank, *list_size, next_event_type, maxatr = 0, maxlist = 0;
+SIMLIB_LOCAL int    maxsvar = 0, maxtvar = 0;
+SIMLIB_LOCAL float  *transfer, sim_time, prob_distrib[26];
+SIMLIB_LOCAL long   sim_events;
+SIMLIB_LOCAL struct master **head, **tail;
+
+/* State of the inline fast paths in simlib.h. */
+
+SIMLIB_LOCAL struct sampst_acc   *sampst_acc;
+SIMLIB_LOCAL struct timest_acc   *timest_acc;
+SIMLIB_LOCAL struct event_key    *event_heap;
+SIMLIB_LOCAL struct event_record *event_pool;
+SIMLIB_LOCAL float  *event_values;
+SIMLIB_LOCAL int    event_heap_size, event_pool_size, event_free, event_tombstones;
+SIMLIB_LOCAL long   event_seq;
+SIMLIB_LOCAL int    lcgrand_antithetic;
+static SIMLIB_LOCAL float timest_reset;      /* Time statistics were last initialized. */
+static SIMLIB_LOCAL int   num_lists;         /* Lists allocated by the last init_simlib. */
+
+/* Declare simlib functions. */
+
+void  init_simlib(void);
+void  list_file(int option, int list);
+void  list_remove(int option, int list);
+void  list_file_id(int option, list_id list);
+void  list_remove_id(int option, list_id list);
+sampst_var sampst_register(int variable);
+timest_var timest_register(int variable);
+list_id    list_register(int list);
+void  timing(void);
+float event_next_time(void);
+int   event_cancel(int event_type);
+int   event_cancel_handle(event_handle handle);
+float sampst(float value, int variable);
+float timest(float value, int variable);
+float filest(int list);
+void  out_sampst(FILE *unit, int lowvar, int highvar);
+void  out_timest(FILE *unit, int lowvar, int highvar);
+void  out_filest(FILE *unit, int lowlist, int highlist);
+void  pprint_out(FILE *unit, int i);
+int   random_integer(float prob_distrib[], int stream);
+int   alias_setup(struct alias_table *table, float prob[], int n);
+int   alias_sample(struct alias_table *table, int stream);
+void  alias_free(struct alias_table *table);
+float erlang(int m, float mean, int stream);
+void  event_grow(void);
+void  simlib_save(struct simlib_state *state);
+void  simlib_restore(const struct simlib_state *state);
+void  simlib_state_free(struct simlib_state *state);
+void  lcgrandst(long zset, int stream);
+long  lcgrandgt(int stream);
+long  stream_seed(long seed, int stream);
+
+
+void init_simlib()
+{
+
+/* Initialize simlib.c.  List LIST_EVENT is reserved for event list, ordered by
+   event time.  init_simlib must be called from main by user.  The lists and
+   statistics are sized from maxlist, maxatr, maxsvar and maxtvar, so a model
+   sets these first;  each registry is a single array. */
+
+    int list, listsize;
+    struct master *row, *next;
+
+    /* Release the lists of any previous run. */
+
+    for (list = 1; head != NULL && list <= num_lists; ++list) {
+        for (row = head[list]; row != NULL; row = next) {
+            next = row->sr;
+            free(row->value);
+            free(row);
+        }
+    }
+    free(list_rank);
+    free(list_size);
+    free(head);
+    free(tail);
+    free(transfer);
+    free(sampst_acc);
+    free(timest_acc);
+
+    if (maxlist < 1) maxlist = MAX_LIST;
+    if (maxsvar < 1) maxsvar = MAX_SVAR;
+    if (maxtvar < 1) maxtvar = TIM_VAR;
+    listsize  = maxlist + 1;
+    num_lists = maxlist;
+
+    /* Initialize system attributes. */
+
+    sim_time = 0.0;
+    sim_events = 0;
+    if (maxatr < 4) maxatr = MAX_ATTR;
+
+    /* Allocate space for the lists. */
+
+    list_rank = (int *)            calloc(listsize,   sizeof(int));
+    list_size = (int *)            calloc(listsize,   sizeof(int));
+    head      = (struct master **) calloc(listsize,   sizeof(struct master *));
+    tail      = (struct master **) calloc(listsize,   sizeof(struct master *));
+    transfer  = (float *)          calloc(maxatr + 1, sizeof(float));
+    sampst_acc = (struct sampst_acc *) calloc(maxsvar + 1, sizeof(struct sampst_acc));
+    timest_acc = (struct timest_acc *) calloc(maxtvar + listsize, sizeof(struct timest_acc));
+
+    /* Initialize list attributes. */
+
+    for(list = 1; list <= maxlist; ++list) {
+        head [list]     = NULL;
+        tail [list]     = NULL;
+        list_size[list] = 0;
+        list_rank[list] = 0;
+    }
+
+    /* Set event list to be ordered by event time, and empty the event heap. */
+
+    list_rank[LIST_EVENT] = EVENT_TIME;
+    free(event_pool);
+    free(event_heap);
+    free(event_values);
+    event_pool       = NULL;
+    event_heap       = NULL;
+    event_values     = NULL;
+    event_pool_size  = 0;
+    event_heap_size  = 0;
+    event_free       = -1;
+    event_tombstones = 0;
+    event_seq        = 0;
+
+    /* Initialize statistical routines. */
+
+    sampst(0.0, 0);
+    timest(0.0, 0);
+}
+
+
+void list_file(int option, int list)
+{
+
+/* Place transfr into list "list".
+   Update timest statistics for the list.
+   option = FIRST place at start of list
+            LAST  place at end of list
+            INCREASING  place in increasing order on attribute list_rank(list)
+            DECREASING  place in decreasing order on attribute list_rank(list)
+            (ties resolved by FIFO) */
+
+    /* If the list value is improper, stop the simulation. */
+
+    if(list < 1 || list > maxlist) {
+        printf("\nInvalid list %d for list_file at time %f\n", list, sim_time);
+        exit(1);
+    }
+
+    /* If the option value is improper, stop the simulation. */
+
+    if(!((option >= 1) && (option <= DECREASING))) {
+        printf(
+            "\n%d is an invalid option for list_file on list %d at time %f\n",
+            option, list, sim_time);
+        exit(1);
+    }
+
+    /* If the rank attribute of an ordered list is improper, stop the simulation. */
+
+    if((option == INCREASING || option == DECREASING) &&
+       !((list_rank[list] >= 1) && (list_rank[list] <= maxatr))) {
+        printf("%d is an improper value for rank of list %d at time %f\n",
+               list_rank[list], list, sim_time);
+        exit(1);
+    }
+
+    list_file_id(option, (list_id){list});
+}
+
+
+void list_file_id(int option, list_id id)
+{
+
+/* list_file on a registered list, with no checks outside debug builds. */
+
+    struct master *row, *ahead, *behind, *ihead, *itail;
+    int    item, postest, list = id.id;
+
+    assert(list >= 1 && list <= maxlist);
+    assert(option >= FIRST && option <= DECREASING);
+
+    /* Increment the list size. */
+
+    list_size[list]++;
+
+    /* If this is the first record in this list, just make space for it. */
+
+    if(list_size[list] == 1) {
+
+        row        = (struct master *) malloc(sizeof(struct master));
+        head[list] = row ;
+        tail[list] = row ;
+        (*row).pr  = NULL;
+        (*row).sr  = NULL;
+    }
+
+    else { /* There are other records in the list. */
+
+        /* Check the value of option. */
+
+        if ((option == INCREASING) || (option == DECREASING)) {
+            item = list_rank[list];
+            assert(item >= 1 && item <= maxatr);
+
+            row    = head[list];
+            behind = NULL; /* Dummy value for the first iteration. */
+
+            /* Search for the correct location. */
+
+            if (option == INCREASING) {
+                postest = (transfer[item] >= (*row).value[item]);
+                while (postest) {
+                    behind  = row;
+                    row     = (*row).sr;
+                    postest = (behind != tail[list]);
+                    if (postest)
+                        postest = (transfer[item] >= (*row).value[item]);
+                }
+            }
+
+            else {
+
+                postest = (transfer[item] <= (*row).value[item]);
+                while (postest) {
+                    behind  = row;
+                    row     = (*row).sr;
+                    postest = (behind != tail[list]);
+                    if (postest)
+                        postest = (transfer[item] <= (*row).value[item]);
+                }
+            }
+
+            /* Check to see if position is first or last.  If so, take care of
+               it below. */
+
+            if (row == head[list])
+
+                option = FIRST;
+
+            else
+
+                if (behind == tail[list])
+
+                    option = LAST;
+
+                else { /* Insert between preceding and succeeding records. */
+
+                    ahead        = (*behind).sr;
+                    row          = (struct master *)
+                                        malloc(sizeof(struct master));
+                    (*row).pr    = behind;
+                    (*behind).sr = row;
+                    (*ahead).pr  = row;
+                    (*row).sr    = ahead;
+                }
+        } /* End if inserting in increasing or decreasing order. */
+
+        if (option == FIRST) {
+            row         = (struct master *) malloc(sizeof(struct master));
+            ihead       = head[list];
+            (*ihead).pr = row;
+            (*row).sr   = ihead;
+            (*row).pr   = NULL;
+            head[list]  = row;
+        }
+        if (option == LAST) {
+            row         = (struct master *) malloc(sizeof(struct master));
+            itail       = tail[list];
+            (*row).pr   = itail;
+            (*itail).sr = row;
+            (*row).sr   = NULL;
+            tail[list]  = row;
+        }
+    }
+
+    /* Copy the row values from the transfer array. */
+
+    (*row).value = (float *) calloc(maxatr + 1, sizeof(float));
+    for (item = 0; item <= maxatr; ++item)
+        (*row).value[item] = transfer[item];
+
+
+    /* Update the area under the number-in-list curve. */
+
+    timest_update((float)list_size[list], (timest_var){maxtvar + list});
+}
+
+
+void list_remove(int option, int list)
+{
+
+/* Remove a record from list "list" and copy attributes into transfer.
+   Update timest statistics for the list.
+   option = FIRST remove first record in the list
+            LAST  remove last record in the list */
+
+    /* If the list value is improper, stop the simulation. */
+
+    if(list < 1 || list > maxlist) {
+        printf("\nInvalid list %d for list_remove at time %f\n",
+               list, sim_time);
+        exit(1);
+    }
+
+    /* If the option value is improper, stop the simulation. */
+
+    if(!(option == FIRST || option == LAST)) {
+        printf(
+            "\n%d is an invalid option for list_remove on list %d at time %f\n",
+            option, list, sim_time);
+        exit(1);
+    }
+
+    list_remove_id(option, (list_id){list});
+}
+
+
+void list_remove_id(int option, list_id id)
+{
+
+/* list_remove on a registered list, with no checks outside debug builds. */
+
+    struct master *row, *ihead, *itail;
+    int    list = id.id;
+
+    assert(list >= 1 && list <= maxlist);
+    assert(option == FIRST || option == LAST);
+
+    /* If the list is empty, stop the simulation. */
+
+    if(list_size[list] <= 0) {
+        printf("\nUnderflow of list %d at time %f\n", list, sim_time);
+        exit(1);
+    }
+
+    /* Decrement the list size. */
+
+    list_size[list]--;
+
+    if(list_size[list] == 0) {
+
+        /* There is only 1 record, so remove it. */
+
+        row        = head[list];
+        head[list] = NULL;
+        tail[list] = NULL;
+    }
+
+    else {
+
+        /* There is more than 1 record, so remove according to the desired
+           option. */
+
+        switch(option) {
+
+            /* Remove the first record in the list. */
+
+            case FIRST:
+                row         = head[list];
+                ihead       = (*row).sr;
+                (*ihead).pr = NULL;
+                head[list]  = ihead;
+                break;
+
+            /* Remove the last record in the list. */
+
+            case LAST:
+                row         = tail[list];
+                itail       = (*row).pr;
+                (*itail).sr = NULL;
+                tail[list]  = itail;
+                break;
+        }
+    }
+
+    /* Copy the data and free memory. */
+
+    free((char *)transfer);
+    transfer = (*row).value;
+    free((char *)row);
+
+    /* Update the area under the number-in-list curve. */
+
+    timest_update((float)list_size[list], (timest_var){maxtvar + list});
+}
+
+
+static int event_before(struct event_key *a, struct event_key *b)
+{
+    return a->time < b->time || (a->time == b->time && a->seq < b->seq);
+}
+
+
+static void event_sift_down(int i)
+{
+    struct event_key key = event_heap[i];
+    int    child;
+
+    while ((child = 2 * i + 1) < event_heap_size) {
+        if (child + 1 < event_heap_size &&
+            event_before(&event_heap[child + 1], &event_heap[child]))
+            ++child;
+        if (!event_before(&event_heap[child], &key)) break;
+        event_heap[i] = event_heap[child];
+        i = child;
+    }
+    event_heap[i] = key;
+}
+
+
+static void event_release(int slot)
+{
+    event_pool[slot].state     = EVENT_FREE;
+    event_pool[slot].next_free = event_free;
+    event_free                 = slot;
+}
+
+
+static void event_compact(void)
+{
+
+/* Drop every tombstone from the heap and restore heap order in linear time. */
+
+    int i, n;
+
+    for (i = n = 0; i < event_heap_size; ++i) {
+        if (event_pool[event_heap[i].slot].state == EVENT_CANCELLED)
+            event_release(event_heap[i].slot);
+        else
+            event_heap[n++] = event_heap[i];
+    }
+    event_heap_size  = n;
+    event_tombstones = 0;
+    for (i = n / 2 - 1; i >= 0; --i)
+        event_sift_down(i);
+}
+
+
+static void event_pop(void)
+{
+    event_heap[0] = event_heap[--event_heap_size];
+    if (event_heap_size > 0) event_sift_down(0);
+}
+
+
+static void event_discard(void)
+{
+
+/* Pop cancelled events off the top of the heap. */
+
+    while (event_heap_size > 0 &&
+           event_pool[event_heap[0].slot].state == EVENT_CANCELLED) {
+        event_release(event_heap[0].slot);
+        event_pop();
+        event_tombstones--;
+    }
+}
+
+
+void timing()
+{
+
+/* Remove next event from event list, placing its attributes in transfer.
+   Set sim_time (simulation time) to event time, transfer[1].
+   Set next_event_type to this event type, transfer[2]. */
+
+    float *value;
+    int    item, slot;
+
+    /* Discard cancelled events at the top of the heap. */
+
+    event_discard();
+
+    /* If the event list is empty, stop the simulation. */
+
+    if (event_heap_size == 0) {
+        printf("\nUnderflow of list %d at time %f\n", LIST_EVENT, sim_time);
+        exit(1);
+    }
+
+    /* Remove the first event from the event list and put it in transfer[]. */
+
+    slot = event_heap[0].slot;
+    event_pop();
+    value = &event_values[slot * (maxatr + 1)];
+    for (item = 0; item <= maxatr; ++item)
+        transfer[item] = value[item];
+    event_release(slot);
+    list_size[LIST_EVENT]--;
+    timest_update((float)list_size[LIST_EVENT], (timest_var){maxtvar + LIST_EVENT});
+
+    /* Check for a time reversal. */
+
+    if(transfer[EVENT_TIME] < sim_time) {
+        printf(
+            "\nAttempt to schedule event type %f for time %f at time %f\n",
+            transfer[EVENT_TYPE], transfer[EVENT_TIME], sim_time);
+        exit(1);
+    }
+
+    /* Advance the simulation clock and set the next event type. */
+
+    sim_time        = transfer[EVENT_TIME];
+    next_event_type = transfer[EVENT_TYPE];
+    sim_events++;
+}
+
+
+float event_next_time(void)
+{
+
+/* Return the time of the next event timing would take, INFINITY if the event
+   list is empty, leaving the event list unchanged apart from discarding
+   cancelled events. */
+
+    event_discard();
+    return event_heap_size > 0 ? event_heap[0].time : INFINITY;
+}
+
+
+void event_grow(void)
+{
+
+/* Double the event pool, and the heap and attribute block with it, when
+   event_schedule finds no free record. */
+
+    int slot, size;
+
+    size         = event_pool_size > 0 ? 2 * event_pool_size : 64;
+    event_pool   = (struct event_record *)
+                       realloc(event_pool, size * sizeof(struct event_record));
+    event_heap   = (struct event_key *)
+                       realloc(event_heap, size * sizeof(struct event_key));
+    event_values = (float *)
+                       realloc(event_values, size * (maxatr + 1) * sizeof(float));
+    for (slot = size - 1; slot >= event_pool_size; --slot) {
+        event_pool[slot].generation = 0;
+        event_release(slot);
+    }
+    event_pool_size = size;
+}
+
+
+int event_cancel_handle(event_handle handle)
+{
+
+/* Cancel the pending event identified by handle, as returned by
+   event_schedule.  The event is only marked cancelled, in O(1), and is
+   discarded when it reaches the head of the event list; once tombstones make
+   up more than EVENT_COMPACT of the heap they are purged together.  Unlike
+   event_cancel, transfer is left untouched.  Returns 1 if the event was
+   pending, 0 if it has already occurred or been cancelled. */
+
+    long long slot = handle & 0xFFFFFFFFLL;
+
+    if (slot < 0 || slot >= event_pool_size ||
+        event_pool[slot].generation != (handle >> 32) ||
+        event_pool[slot].state != EVENT_PENDING)
+        return 0;
+
+    event_pool[slot].state = EVENT_CANCELLED;
+    event_tombstones++;
+    list_size[LIST_EVENT]--;
+    timest_update((float)list_size[LIST_EVENT], (timest_var){maxtvar + LIST_EVENT});
+
+    if (event_tombstones > EVENT_COMPACT_MIN &&
+        event_tombstones > EVENT_COMPACT * event_heap_size)
+        event_compact();
+    return 1;
+}
+
+
+int event_cancel(int event_type)
+{
+
+/* Remove the first event of type event_type from the event list, leaving its
+   attributes in transfer.  If something is cancelled, event_cancel returns 1;
+   if no match is found, event_cancel returns 0.  This searches the whole
+   event list; use event_cancel_handle to cancel a specific event. */
+
+    struct event_key *best;
+    float  low, high, value;
+    int    i, item, slot;
+
+    /* Search the event list for the earliest pending match. */
+
+    low  = event_type - EPSILON;
+    high = event_type + EPSILON;
+    best = NULL;
+    for (i = 0; i < event_heap_size; ++i) {
+        slot  = event_heap[i].slot;
+        value = event_values[slot * (maxatr + 1) + EVENT_TYPE];
+        if (event_pool[slot].state == EVENT_PENDING && value > low &&
+            value < high && (best == NULL || event_before(&event_heap[i], best)))
+            best = &event_heap[i];
+    }
+
+    /* No match. */
+
+    if (best == NULL) return 0;
+
+    /* Copy the attributes to transfer and cancel the event. */
+
+    slot = best->slot;
+    for (item = 0; item <= maxatr; ++item)
+        transfer[item] = event_values[slot * (maxatr + 1) + item];
+    return event_cancel_handle(((event_handle) event_pool[slot].generation << 32) | slot);
+}
+
+
+float sampst(float value, int variable)
+{
+
+/* Initialize, update, or report statistics on discrete-time processes:
+   sum/average, max (default -1E30), min (default 1E30), number of observations
+   for sampst variable "variable", where "variable":
+       = 0 initializes accumulators
+       > 0 updates sum, count, min, and max accumulators with new observation
+       < 0 reports stats on variable "variable" and returns them in transfer:
+           [1] = average of observations
+           [2] = number of observations
+           [3] = maximum of observations
+           [4] = minimum of observations
+   Updates in the event loop should call sampst_update on a registered
+   variable instead. */
+
+    struct sampst_acc *acc;
+    int    ivar;
+
+    /* If the variable value is improper, stop the simulation. */
+
+    if(variable < -maxsvar || variable > maxsvar) {
+        printf("\n%d is an improper value for a sampst variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    /* Execute the desired option. */
+
+    if(variable > 0) { /* Update. */
+        sampst_update(value, (sampst_var){variable});
+        return 0.0;
+    }
+
+    if(variable < 0) { /* Report summary statistics in transfer. */
+        acc         = &sampst_acc[-variable];
+        transfer[2] = (float) acc->count;
+        transfer[3] = acc->max;
+        transfer[4] = acc->min;
+        if(acc->count == 0)
+            transfer[1] = 0.0;
+        else
+            transfer[1] = acc->sum / transfer[2];
+        return transfer[1];
+    }
+
+    /* Initialize the accumulators. */
+
+    for(ivar=1; ivar <= maxsvar; ++ivar) {
+        sampst_acc[ivar].sum   = 0.0;
+        sampst_acc[ivar].max   = -INFINITY;
+        sampst_acc[ivar].min   =  INFINITY;
+        sampst_acc[ivar].count = 0;
+    }
+    return 0.0;
+}
+
+
+float timest(float value, int variable)
+{
+
+/* Initialize, update, or report statistics on continuous-time processes:
+   integral/average, max (default -1E30), min (default 1E30)
+   for timest variable "variable", where "variable":
+       = 0 initializes counters
+       > 0 updates area, min, and max accumulators with new level of variable
+       < 0 reports stats on variable "variable" and returns them in transfer:
+           [1] = time-average of variable updated to the time of this call
+           [2] = maximum value variable has attained
+           [3] = minimum value variable has attained
+   Note that variables maxtvar + 1 through maxtvar + maxlist are used for
+   automatic record keeping on the length of lists 1 through maxlist.  Updates in the
+   event loop should call timest_update on a registered variable instead. */
+
+    struct timest_acc *acc;
+    int    ivar;
+
+    /* If the variable value is improper, stop the simulation. */
+
+    if(variable < -(maxtvar + maxlist) || variable > maxtvar + maxlist) {
+        printf("\n%d is an improper value for a timest variable at time %f\n",
+            variable, sim_time);
+        exit(1);
+    }
+
+    /* Execute the desired option. */
+
+    if(variable > 0) { /* Update. */
+        timest_update(value, (timest_var){variable});
+        return 0.0;
+    }
+
+    if(variable < 0) { /* Report summary statistics in transfer. */
+        acc          = &timest_acc[-variable];
+        acc->area   += (sim_time - acc->tlvc) * acc->preval;
+        acc->tlvc    = sim_time;
+        transfer[1]  = acc->area / (sim_time - timest_reset);
+        transfer[2]  = acc->max;
+        transfer[3]  = acc->min;
+        return transfer[1];
+    }
+
+    /* Initialize the accumulators. */
+
+    for(ivar = 1; ivar <= maxtvar + maxlist; ++ivar) {
+        timest_acc[ivar].area   = 0.0;
+        timest_acc[ivar].max    = -INFINITY;
+        timest_acc[ivar].min    =  INFINITY;
+        timest_acc[ivar].preval = 0.0;
+        timest_acc[ivar].tlvc   = sim_time;
+    }
+    timest_reset = sim_time;
+    return 0.0;
+}
+
+
+float filest(int list)
+{
+
+/* Report statistics on the length of list "list" in transfer:
+       [1] = time-average of list length updated to the time of this call
+       [2] = maximum length list has attained
+       [3] = minimum length list has attained
+   This uses timest variable maxtvar + list. */
+
+    if(list < 1 || list > maxlist) {
+        printf("\nInvalid list %d for filest at time %f\n", list, sim_time);
+        exit(1);
+    }
+    return timest(0.0, -(maxtvar + list));
+}
+
+
+sampst_var sampst_register(int variable)
+{
+
+/* Validate sampst variable "variable" once, for sampst_update.  Call after
+   init_simlib, which sizes the variables. */
+
+    if(variable < 1 || variable > maxsvar) {
+        printf("\n%d is an improper value for a sampst variable\n", variable);
+        exit(1);
+    }
+    return (sampst_var){variable};
+}
+
+
+timest_var timest_register(int variable)
+{
+
+/* Validate timest variable "variable" once, for timest_update.  Call after
+   init_simlib;  variables above maxtvar belong to the lists and cannot be
+   registered. */
+
+    if(variable < 1 || variable > maxtvar) {
+        printf("\n%d is an improper value for a timest variable\n", variable);
+        exit(1);
+    }
+    return (timest_var){variable};
+}
+
+
+list_id list_register(int list)
+{
+
+/* Validate list "list" once, for list_file_id and list_remove_id.  Call after
+   init_simlib, which sizes the lists. */
+
+    if(list < 1 || list > maxlist || list == LIST_EVENT) {
+        printf("\nInvalid list %d\n", list);
+        exit(1);
+    }
+    return (list_id){list};
+}
+
+
+void out_sampst(FILE *unit, int lowvar, int highvar)
+{
+
+/* Write sampst statistics for variables lowvar through highvar on file
+   "unit". */
+
+    int ivar, iatrr;
+
+    if(lowvar>highvar || lowvar > maxsvar || highvar > maxsvar) return;
+
+    fprintf(unit, "\n sampst                         Number");
+    fprintf(unit, "\nvariable                          of");
+    fprintf(unit, "\n number       Average           values          Maximum");
+    fprintf(unit, "          Minimum");
+    fprintf(unit, "\n___________________________________");
+    fprintf(unit, "_____________________________________");
+    for(ivar = lowvar; ivar <= highvar; ++ivar) {
+        fprintf(unit, "\n\n%5d", ivar);
+        sampst(0.00, -ivar);
+        for(iatrr = 1; iatrr <= 4; ++iatrr) pprint_out(unit, iatrr);
+    }
+    fprintf(unit, "\n___________________________________");
+    fprintf(unit, "_____________________________________\n\n\n");
+}
+
+
+void out_timest(FILE *unit, int lowvar, int highvar)
+{
+
+/* Write timest statistics for variables lowvar through highvar on file
+   "unit". */
+
+    int ivar, iatrr;
+
+    if(lowvar > highvar || lowvar > maxtvar || highvar > maxtvar ) return;
+
+
+    fprintf(unit, "\n  timest");
+    fprintf(unit, "\n variable       Time");
+    fprintf(unit, "\n  number       average          Maximum          Minimum");
+    fprintf(unit, "\n________________________________________________________");
+    for(ivar = lowvar; ivar <= highvar; ++ivar) {
+        fprintf(unit, "\n\n%5d", ivar);
+        timest(0.00, -ivar);
+        for(iatrr = 1; iatrr <= 3; ++iatrr) pprint_out(unit, iatrr);
+    }
+    fprintf(unit, "\n________________________________________________________");
+    fprintf(unit, "\n\n\n");
+}
+
+
+void out_filest(FILE *unit, int lowlist, int highlist)
+{
+
+/* Write timest list-length statistics for lists lowlist through highlist on
+   file "unit". */
+
+    int list, iatrr;
+
+    if(lowlist > highlist || lowlist > maxlist || highlist > maxlist) return;
+
+    fprintf(unit, "\n  File         Time");
+    fprintf(unit, "\n number       average          Maximum          Minimum");
+    fprintf(unit, "\n_______________________________________________________");
+    for(list = lowlist; list <= highlist; ++list) {
+        fprintf(unit, "\n\n%5d", list);
+        filest(list);
+        for(iatrr = 1; iatrr <= 3; ++iatrr) pprint_out(unit, iatrr);
+    }
+    fprintf(unit, "\n_______________________________________________________");
+    fprintf(unit, "\n\n\n");
+}
+
+
+void pprint_out(FILE *unit, int i) /* Write ith entry in transfer to file
+                                      "unit". */
+{
+    if(transfer[i] == -1e30 || transfer[i] == 1e30)
+        fprintf(unit," %#15.6G ", 0.00);
+    else
+        fprintf(unit," %#15.6G ", transfer[i]);
+}
+
+
+int random_integer(float prob_distrib[], int stream) /* Discrete-variate
+                                                        generation function. */
+{
+    int   i;
+    float u;
+
+    u = lcgrand(stream);
+
+    for (i = 1; u >= prob_distrib[i]; ++i)
+        ;
+    return i;
+}
+
+
+int alias_setup(struct alias_table *table, float prob[], int n)
+{
+
+/* Build a Walker/Vose alias table for the discrete distribution prob[1]
+   through prob[n] (individual probabilities, not cumulative as for
+   random_integer).  The distribution is validated here, once, so that
+   alias_sample needs no checks:  every prob[i] must be nonnegative and the
+   sum must be within PROB_EPSILON of 1.  Returns 0 on success, 1 if n is
+   improper, 2 if a probability is negative, 3 if the sum is not 1. */
+
+    int    i, l, g, *small, *large, num_small, num_large;
+    double sum, *scaled;
+
+    if (n < 1) return 1;
+
+    sum = 0.0;
+    for (i = 1; i <= n; ++i) {
+        if (prob[i] < 0.0) return 2;
+        sum += prob[i];
+    }
+    if (fabs(sum - 1.0) > PROB_EPSILON) return 3;
+
+    table->n     = n;
+    table->prob  = (float *) calloc(n, sizeof(float));
+    table->alias = (int *)   calloc(n, sizeof(int));
+    scaled       = (double *) calloc(n, sizeof(double));
+    small        = (int *)    calloc(n, sizeof(int));
+    large        = (int *)    calloc(n, sizeof(int));
+
+    /* Scale to mean 1 (renormalizing away the tolerated error) and split the
+       columns into those below and above the mean. */
+
+    num_small = num_large = 0;
+    for (i = 0; i < n; ++i) {
+        scaled[i] = prob[i + 1] * n / sum;
+        if (scaled[i] < 1.0)
+            small[num_small++] = i;
+        else
+            large[num_large++] = i;
+    }
+
+    /* Fill each short column from a tall one. */
+
+    while (num_small > 0 && num_large > 0) {
+        l = small[--num_small];
+        g = large[--num_large];
+        table->prob[l]  = scaled[l];
+        table->alias[l] = g;
+        scaled[g] = (scaled[g] + scaled[l]) - 1.0;
+        if (scaled[g] < 1.0)
+            small[num_small++] = g;
+        else
+            large[num_large++] = g;
+    }
+
+    /* Whatever is left is full up to rounding error. */
+
+    while (num_large > 0) {
+        g = large[--num_large];
+        table->prob[g]  = 1.0;
+        table->alias[g] = g;
+    }
+    while (num_small > 0) {
+        l = small[--num_small];
+        table->prob[l]  = 1.0;
+        table->alias[l] = l;
+    }
+
+    free(scaled);
+    free(small);
+    free(large);
+    return 0;
+}
+
+
+int alias_sample(struct alias_table *table, int stream) /* Discrete-variate
+                                                           generation in O(1)
+                                                           from an alias
+                                                           table. */
+{
+    int   i;
+    float u;
+
+    u = lcgrand(stream) * table->n;
+    i = (int) u;
+    if (i >= table->n) i = table->n - 1;
+    if (u - i < table->prob[i])
+        return i + 1;
+    return table->alias[i] + 1;
+}
+
+
+void alias_free(struct alias_table *table) /* Release an alias table. */
+{
+    free(table->prob);
+    free(table->alias);
+    table->prob  = NULL;
+    table->alias = NULL;
+    table->n     = 0;
+}
+
+
+float erlang(int m, float mean, int stream)  /* Erlang variate generation
+                                                function. */
+{
+    float mean_exponential, sum, u[ERLANG_BATCH];
+    int   i, j, n;
+
+    /* Draw the uniforms in batches, summing the exponentials in order. */
+
+    mean_exponential = mean / m;
+    sum = 0.0;
+    for (i = 0; i < m; i += n) {
+        n = m - i < ERLANG_BATCH ? m - i : ERLANG_BATCH;
+        lcgrand_fill(u, n, stream);
+        for (j = 0; j < n; ++j)
+            sum += (float)(-mean_exponential * log(u[j]));
+    }
+    return sum;
+}
+
+/* Prime modulus multiplicative linear congruential generator
+
+   Z[i] = (630360016 * Z[i-1]) (mod(pow(2,31) - 1)), based on Marse and
+   Roberts' portable FORTRAN random-number generator UNIRAN.  Multiple
+   (100) streams are supported, with seeds spaced 100,000 apart.
+   Throughout, input argument "stream" must be an int giving the
+   desired stream number.  The header file lcgrand.h must be included in
+   the calling program (#include "lcgrand.h") before using these
+   functions.
+
+   Usage: (Three functions)
+
+   1. To obtain the next U(0,1) random number from stream "stream,"
+      execute
+          u = lcgrand(stream);
+      where lcgrand is a float function.  The float variable u will
+      contain the next random number.
+
+   2. To set the seed for stream "stream" to a desired value zset,
+      execute
+          lcgrandst(zset, stream);
+      where lcgrandst is a void function and zset must be a long set to
+      the desired seed, a number between 1 and 2147483646 (inclusive). 
+      Default seeds for all 100 streams are given in the code.
+
+   3. To get the current (most recently used) integer in the sequence
+      being generated for stream "stream" into the long variable zget,
+      execute
+          zget = lcgrandgt(stream);
+      where lcgrandgt is a long function. */
+
+/* Define the constants. */
+
+#define MODLUS 2147483647
+#define MULT1       24112
+#define MULT2       26143
+
+/* Set the default seeds for all 100 streams. */
+
+SIMLIB_LOCAL long zrng[] =
+{         1,
+ 1973272912, 281629770,  20006270,1280689831,2096730329,1933576050,
+  913566091, 246780520,1363774876, 604901985,1511192140,1259851944,
+  824064364, 150493284, 242708531,  75253171,1964472944,1202299975,
+  233217322,1911216000, 726370533, 403498145, 993232223,1103205531,
+  762430696,1922803170,1385516923,  76271663, 413682397, 726466604,
+  336157058,1432650381,1120463904, 595778810, 877722890,1046574445,
+   68911991,2088367019, 748545416, 622401386,2122378830, 640690903,
+ 1774806513,2132545692,2079249579,  78130110, 852776735,1187867272,
+ 1351423507,1645973084,1997049139, 922510944,2045512870, 898585771,
+  243649545,1004818771, 773686062, 403188473, 372279877,1901633463,
+  498067494,2087759558, 493157915, 597104727,1530940798,1814496276,
+  536444882,1663153658, 855503735,  67784357,1432404475, 619691088,
+  119025595, 880802310, 176192644,1116780070, 277854671,1366580350,
+ 1142483975,2026948561,1053920743, 786262391,1792203830,1494667770,
+ 1923011392,1433700034,1244184613,1147297105, 539712780,1545929719,
+  190641742,1645390429, 264907697, 620389253,1502074852, 927711160,
+  364849192,2049576050, 638580085, 547070247 };
+
+void lcgrandst (long zset, int stream) /* Set the current zrng for stream
+                                          "stream" to zset. */
+{
+    zrng[stream] = zset;
+}
+
+
+long lcgrandgt (int stream) /* Return the current zrng for stream "stream". */
+{
+    return zrng[stream];
+}
+
+
+long stream_seed(long seed, int stream) /* Seed of a stream, from a run seed, for lcgrandst */
+{
+    unsigned long long z = (unsigned long long)seed * 0x9E3779B97F4A7C15ULL + stream;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (long)(z % 2147483646ULL) + 1;
+}
+
+
+/* Copy the whole simlib state of this thread, and restore it later.  These
+   follow the random-number generator because they copy every stream. */
+
+#define NUM_STREAMS ((int) (sizeof(zrng) / sizeof(zrng[0])))
+
+void simlib_save(struct simlib_state *state)
+{
+
+/* Copy the lists, the statistics, the event list and the random-number
+   streams into state, which must be zeroed or previously saved into.  The
+   sizes set at init_simlib must not change until the copy is restored. */
+
+    struct master *row;
+    int    list, records, n;
+
+    for (list = 1, records = 0; list <= maxlist; ++list)
+        records += list_size[list];
+    records -= list_size[LIST_EVENT];
+
+    state->sim_time        = sim_time;
+    state->timest_reset    = timest_reset;
+    state->next_event_type = next_event_type;
+    state->sim_events      = sim_events;
+
+    state->list_rank = (int *)   realloc(state->list_rank, (maxlist + 1) * sizeof(int));
+    state->list_size = (int *)   realloc(state->list_size, (maxlist + 1) * sizeof(int));
+    state->records   = (float *) realloc(state->records, (records + 1) * (maxatr + 1) * sizeof(float));
+    state->transfer  = (float *) realloc(state->transfer, (maxatr + 1) * sizeof(float));
+    memcpy(state->list_rank, list_rank, (maxlist + 1) * sizeof(int));
+    memcpy(state->list_size, list_size, (maxlist + 1) * sizeof(int));
+    memcpy(state->transfer,  transfer,  (maxatr + 1) * sizeof(float));
+    for (list = 1, n = 0; list <= maxlist; ++list) {
+        for (row = head[list]; row != NULL; row = row->sr, ++n)
+            memcpy(&state->records[n * (maxatr + 1)], row->value, (maxatr + 1) * sizeof(float));
+    }
+
+    state->sampst_acc = (struct sampst_acc *)
+        realloc(state->sampst_acc, (maxsvar + 1) * sizeof(struct sampst_acc));
+    state->timest_acc = (struct timest_acc *)
+        realloc(state->timest_acc, (maxtvar + maxlist + 1) * sizeof(struct timest_acc));
+    memcpy(state->sampst_acc, sampst_acc, (maxsvar + 1) * sizeof(struct sampst_acc));
+    memcpy(state->timest_acc, timest_acc, (maxtvar + maxlist + 1) * sizeof(struct timest_acc));
+
+    state->event_heap   = (struct event_key *)
+        realloc(state->event_heap, (event_heap_size + 1) * sizeof(struct event_key));
+    state->event_pool   = (struct event_record *)
+        realloc(state->event_pool, (event_pool_size + 1) * sizeof(struct event_record));
+    state->event_values = (float *)
+        realloc(state->event_values, (event_pool_size + 1) * (maxatr + 1) * sizeof(float));
+    memcpy(state->event_heap, event_heap, event_heap_size * sizeof(struct event_key));
+    memcpy(state->event_pool, event_pool, event_pool_size * sizeof(struct event_record));
+    memcpy(state->event_values, event_values, event_pool_size * (maxatr + 1) * sizeof(float));
+    state->event_heap_size  = event_heap_size;
+    state->event_pool_size  = event_pool_size;
+    state->event_free       = event_free;
+    state->event_tombstones = event_tombstones;
+    state->event_seq        = event_seq;
+
+    state->zrng = (long *) realloc(state->zrng, NUM_STREAMS * sizeof(long));
+    memcpy(state->zrng, zrng, NUM_STREAMS * sizeof(long));
+}
+
+
+void simlib_restore(const struct simlib_state *state)
+{
+
+/* Return simlib to the state copied by simlib_save.  The list records are
+   rebuilt;  the event pool keeps the slots and generations it was saved with,
+   so handles returned before the copy are valid again. */
+
+    struct master *row, *next;
+    int    list, item, n;
+
+    for (list = 1; list <= maxlist; ++list) {
+        for (row = head[list]; row != NULL; row = next) {
+            next = row->sr;
+            free(row->value);
+            free(row);
+        }
+        head[list] = tail[list] = NULL;
+    }
+
+    sim_time        = state->sim_time;
+    timest_reset    = state->timest_reset;
+    next_event_type = state->next_event_type;
+    sim_events      = state->sim_events;
+
+    memcpy(list_rank, state->list_rank, (maxlist + 1) * sizeof(int));
+    memcpy(list_size, state->list_size, (maxlist + 1) * sizeof(int));
+    memcpy(transfer,  state->transfer,  (maxatr + 1) * sizeof(float));
+    for (list = 1, n = 0; list <= maxlist; ++list) {
+        if (list == LIST_EVENT)
+            continue;
+        for (item = 0; item < list_size[list]; ++item, ++n) {
+            row        = (struct master *) malloc(sizeof(struct master));
+            row->value = (float *) malloc((maxatr + 1) * sizeof(float));
+            memcpy(row->value, &state->records[n * (maxatr + 1)], (maxatr + 1) * sizeof(float));
+            row->pr    = tail[list];
+            row->sr    = NULL;
+            if (tail[list] != NULL)
+                tail[list]->sr = row;
+            else
+                head[list] = row;
+            tail[list] = row;
+        }
+    }
+
+    memcpy(sampst_acc, state->sampst_acc, (maxsvar + 1) * sizeof(struct sampst_acc));
+    memcpy(timest_acc, state->timest_acc, (maxtvar + maxlist + 1) * sizeof(struct timest_acc));
+
+    if (event_pool_size < state->event_pool_size) {
+        event_heap   = (struct event_key *)
+            realloc(event_heap, state->event_pool_size * sizeof(struct event_key));
+        event_values = (float *)
+            realloc(event_values, state->event_pool_size * (maxatr + 1) * sizeof(float));
+    }
+    event_pool = (struct event_record *)
+        realloc(event_pool, (state->event_pool_size + 1) * sizeof(struct event_record));
+    memcpy(event_heap, state->event_heap, state->event_heap_size * sizeof(struct event_key));
+    memcpy(event_pool, state->event_pool, state->event_pool_size * sizeof(struct event_record));
+    memcpy(event_values, state->event_values, state->event_pool_size * (maxatr + 1) * sizeof(float));
+    event_heap_size  = state->event_heap_size;
+    event_pool_size  = state->event_pool_size;
+    event_free       = state->event_free;
+    event_tombstones = state->event_tombstones;
+    event_seq        = state->event_seq;
+
+    memcpy(zrng, state->zrng, NUM_STREAMS * sizeof(long));
+}
+
+
+void simlib_state_free(struct simlib_state *state)
+{
+
+/* Release a copy made by simlib_save. */
+
+    free(state->list_rank);
+    free(state->list_size);
+    free(state->records);
+    free(state->transfer);
+    free(state->sampst_acc);
+    free(state->timest_acc);
+    free(state->event_heap);
+    free(state->event_pool);
+    free(state->event_values);
+    free(state->zrng);
+    memset(state, 0, sizeof(*state));
+}
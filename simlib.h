@@ -1,42 +1,284 @@
-/* This is simlib.h. */
-
-/* Include files. */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <math.h>
-#include "simlibdefs.h"
-
-/* Declare simlib global variables. */
-
-extern int    *list_rank, *list_size, next_event_type, maxatr, maxlist;
-extern float  *transfer, sim_time, prob_distrib[26];
-extern struct master {
-    float  *value;
-    struct master *pr;
-    struct master *sr;
-} **head, **tail;
-
-/* Declare simlib functions. */
-
-extern void  init_simlib(void);
-extern void  list_file(int option, int list);
-extern void  list_remove(int option, int list);
-extern void  timing(void);
-extern void  event_schedule(float time_of_event, int type_of_event);
-extern int   event_cancel(int event_type);
-extern float sampst(float value, int varibl);
-extern float timest(float value, int varibl);
-extern float filest(int list);
-extern void  out_sampst(FILE *unit, int lowvar, int highvar);
-extern void  out_timest(FILE *unit, int lowvar, int highvar);
-extern void  out_filest(FILE *unit, int lowlist, int highlist);
-extern float expon(float mean, int stream);
-extern int   random_integer(float prob_distrib[], int stream);
-extern float uniform(float a, float b, int stream);
-extern float erlang(int m, float mean, int stream);
-extern float normal(float m, int stream);
-extern float lcgrand(int stream);
-extern void  lcgrandst(long zset, int stream);
-extern long  lcgrandgt(int stream);
-
+/* This is simlib.h. */
+
+#ifndef SIMLIB_H
+#define SIMLIB_H
+
+/* Include files. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "simlibdefs.h"
+
+/* Declare simlib global variables.  Each thread has its own copy of the
+   simlib state, so separate simulations may run on separate threads. */
+
+#define SIMLIB_LOCAL _Thread_local
+
+struct master {
+    float  *value;
+    struct master *pr;
+    struct master *sr;
+};
+extern SIMLIB_LOCAL int    *list_rank, *list_size, next_event_type, maxatr, maxlist;
+extern SIMLIB_LOCAL int    maxsvar, maxtvar;  /* sampst and timest variables, set before init_simlib. */
+extern SIMLIB_LOCAL float  *transfer, sim_time, prob_distrib[26];
+extern SIMLIB_LOCAL long   sim_events;      /* Events taken by timing() since init_simlib(). */
+extern SIMLIB_LOCAL struct master **head, **tail;
+struct alias_table {
+    int    n;
+    float *prob;
+    int   *alias;
+};
+
+/* init_simlib sizes every registry from maxlist, maxatr, maxsvar and maxtvar
+   (MAX_LIST, MAX_ATTR, MAX_SVAR and TIM_VAR when left at zero).  List maxlist
+   is the event list, LIST_EVENT, and timest variables maxtvar + 1 through
+   maxtvar + maxlist track the lengths of lists 1 through maxlist. */
+
+/* Typed handles of statistics and lists.  The register functions validate a
+   number once and stop the simulation if it is out of range;  the functions
+   taking handles then only assert it, in debug builds. */
+
+typedef struct { int id; } sampst_var;
+typedef struct { int id; } timest_var;
+typedef struct { int id; } list_id;
+typedef long long event_handle; /* (generation << 32) | slot, 64 bits even where long is 32. */
+
+/* Copy of the simlib state of one thread, for simulations that roll back. */
+
+struct simlib_state {
+    float  sim_time, timest_reset;
+    int    next_event_type;
+    long   sim_events;
+    int   *list_rank, *list_size;
+    float *records;             /* Attributes of every list record, list by list. */
+    float *transfer;
+    struct sampst_acc   *sampst_acc;
+    struct timest_acc   *timest_acc;
+    struct event_key    *event_heap;
+    struct event_record *event_pool;
+    float *event_values;
+    int    event_heap_size, event_pool_size, event_free, event_tombstones;
+    long   event_seq;
+    long  *zrng;
+};
+
+/* Declare simlib functions. */
+
+extern void  init_simlib(void);
+extern void  list_file(int option, int list);
+extern void  list_remove(int option, int list);
+extern void  list_file_id(int option, list_id list);
+extern void  list_remove_id(int option, list_id list);
+extern sampst_var sampst_register(int variable);
+extern timest_var timest_register(int variable);
+extern list_id    list_register(int list);
+extern void  timing(void);
+extern float event_next_time(void);
+extern int   event_cancel(int event_type);
+extern int   event_cancel_handle(event_handle handle);
+extern float sampst(float value, int varibl);
+extern float timest(float value, int varibl);
+extern float filest(int list);
+extern void  out_sampst(FILE *unit, int lowvar, int highvar);
+extern void  out_timest(FILE *unit, int lowvar, int highvar);
+extern void  out_filest(FILE *unit, int lowlist, int highlist);
+extern int   random_integer(float prob_distrib[], int stream);
+extern int   alias_setup(struct alias_table *table, float prob[], int n);
+extern int   alias_sample(struct alias_table *table, int stream);
+extern void  alias_free(struct alias_table *table);
+extern float erlang(int m, float mean, int stream);
+extern void  event_grow(void);
+extern void  simlib_save(struct simlib_state *state);
+extern void  simlib_restore(const struct simlib_state *state);
+extern void  simlib_state_free(struct simlib_state *state);
+extern void  lcgrandst(long zset, int stream);
+extern long  lcgrandgt(int stream);
+extern long  stream_seed(long seed, int stream);
+
+/* Inline fast paths.  lcgrand, the variates built on it, event_schedule and
+   the *_update entry points of sampst and timest are called on every event,
+   so they are defined here, where every caller can inline them without LTO.
+   The state below is exported for them alone;  models should not touch it. */
+
+struct sampst_acc {             /* Accumulators of one sampst variable. */
+    float sum, max, min;
+    int   count;
+};
+struct timest_acc {             /* Accumulators of one timest variable. */
+    double area;                /* In double, so areas of long runs still difference well. */
+    float max, min;
+    float preval;               /* Current level. */
+    float tlvc;                 /* Time of the last change of level. */
+};
+extern SIMLIB_LOCAL struct sampst_acc *sampst_acc;   /* [1..maxsvar] */
+extern SIMLIB_LOCAL struct timest_acc *timest_acc;   /* [1..maxtvar + maxlist] */
+
+/* The event list is a binary heap of (time, sequence) keys over a pool of
+   event records.  Cancelled events stay in the heap as tombstones until they
+   reach the top or the heap is compacted. */
+
+struct event_key {
+    float time;
+    int   slot;
+    long  seq;                  /* Ties in time are resolved FIFO. */
+};
+struct event_record {
+    int    generation;          /* 1..2^30, advanced on reuse;  part of the handle. */
+    int    state;
+    int    next_free;
+};
+extern SIMLIB_LOCAL struct event_key    *event_heap;
+extern SIMLIB_LOCAL struct event_record *event_pool;
+extern SIMLIB_LOCAL float *event_values;     /* Attributes 0..maxatr of each record, end to end. */
+extern SIMLIB_LOCAL int    event_heap_size, event_pool_size, event_free, event_tombstones;
+extern SIMLIB_LOCAL long   event_seq;
+
+extern SIMLIB_LOCAL long   zrng[];           /* Current state of each lcgrand stream. */
+
+/* While lcgrand_antithetic is set, every stream returns 1 - U in place of U,
+   so a run repeated from the same seeds is the antithetic of the first. */
+
+extern SIMLIB_LOCAL int    lcgrand_antithetic;
+
+static inline void sampst_update(float value, sampst_var variable) /* Record an observation */
+{
+    struct sampst_acc *acc = &sampst_acc[variable.id];
+
+    assert(variable.id >= 1 && variable.id <= maxsvar);
+    acc->sum += value;
+    if (value > acc->max) acc->max = value;
+    if (value < acc->min) acc->min = value;
+    acc->count++;
+}
+
+static inline void timest_update(float value, timest_var variable) /* Record a new level */
+{
+    struct timest_acc *acc = &timest_acc[variable.id];
+
+    assert(variable.id >= 1 && variable.id <= maxtvar + maxlist);
+    acc->area  += (sim_time - acc->tlvc) * acc->preval;
+    if (value > acc->max) acc->max = value;
+    if (value < acc->min) acc->min = value;
+    acc->preval = value;
+    acc->tlvc   = sim_time;
+}
+
+static inline long lcgrand_next(long zi) /* One step of the lcgrand recurrence */
+{
+    /* Z * 630360016 mod (2^31 - 1), the product of the two UNIRAN multipliers,
+       reduced with one 64-bit multiply instead of four 16-bit partial products. */
+
+    unsigned long long product = (unsigned long long) zi * 630360016ULL;
+
+    /* The sum reaches about 2.78e9, so it is reduced before narrowing to a
+       long, which may be 32 bits. */
+    product = (product & 2147483647ULL) + (product >> 31);
+    if (product >= 2147483647ULL) product -= 2147483647ULL;
+    return (long) product;
+}
+
+static inline float lcgrand(int stream) /* Next U(0,1) from stream "stream" */
+{
+    long zi = lcgrand_next(zrng[stream]);
+
+    zrng[stream] = zi;
+    if (lcgrand_antithetic)
+        return (16777216 - (zi >> 7 | 1)) / 16777216.0;
+    return (zi >> 7 | 1) / 16777216.0;
+}
+
+static inline void lcgrand_fill(float u[], int n, int stream) /* n uniforms at once */
+{
+    /* The stream state stays in a register for the whole batch. */
+
+    long zi = zrng[stream];
+    int  i;
+
+    for (i = 0; i < n; ++i) {
+        zi   = lcgrand_next(zi);
+        u[i] = (lcgrand_antithetic ? 16777216 - (zi >> 7 | 1) : (zi >> 7 | 1)) / 16777216.0;
+    }
+    zrng[stream] = zi;
+}
+
+static inline float expon(float mean, int stream) /* Exponential variate */
+{
+    return -mean * log(lcgrand(stream));
+}
+
+static inline float uniform(float a, float b, int stream) /* Uniform variate */
+{
+    return a + lcgrand(stream) * (b - a);
+}
+
+static inline float normal(float m, int stream) /* Normal variate, mean m and standard deviation 1 */
+{
+    float u[2];
+
+    lcgrand_fill(u, 2, stream);
+    return (float)(sqrt(-2 * log((double)u[0])) * cos(2 * M_PI * (double)u[1])) + m;
+}
+
+static inline event_handle event_schedule_seq(float time_of_event, int type_of_event, long seq)
+{
+
+/* event_schedule, with events of equal time taken in increasing order of seq
+   instead of FIFO.  event_schedule numbers its events from 0 up, so negative
+   values order a caller's events among themselves and ahead of those. */
+
+    struct event_key key;
+    float *value;
+    int    item, slot, i;
+
+    transfer[EVENT_TIME] = time_of_event;
+    transfer[EVENT_TYPE] = type_of_event;
+
+    /* Take a free record;  growing the pool is the rare, out-of-line case. */
+
+    if (event_free < 0) event_grow();
+    slot       = event_free;
+    event_free = event_pool[slot].next_free;
+    event_pool[slot].state = EVENT_PENDING;
+    event_pool[slot].generation = (event_pool[slot].generation & 0x3FFFFFFF) + 1;
+    value = &event_values[slot * (maxatr + 1)];
+    for (item = 0; item <= maxatr; ++item)
+        value[item] = transfer[item];
+
+    /* Sift the key up from the end of the heap. */
+
+    key.time = time_of_event;
+    key.seq  = seq;
+    key.slot = slot;
+    for (i = event_heap_size++; i > 0; i = (i - 1) / 2) {
+        struct event_key *parent = &event_heap[(i - 1) / 2];
+        if (!(key.time < parent->time || (key.time == parent->time && key.seq < parent->seq)))
+            break;
+        event_heap[i] = *parent;
+    }
+    event_heap[i] = key;
+
+    /* Update the area under the number-in-event-list curve. */
+
+    list_size[LIST_EVENT]++;
+    timest_update((float)list_size[LIST_EVENT], (timest_var){maxtvar + LIST_EVENT});
+
+    return ((event_handle) event_pool[slot].generation << 32) | slot;
+}
+
+static inline event_handle event_schedule(float time_of_event, int type_of_event)
+{
+
+/* Schedule an event at time event_time of type event_type.  If attributes
+   beyond the first two (reserved for the event time and the event type) are
+   being used in the event list, it is the user's responsibility to place their
+   values into the transfer array before invoking event_schedule.  Returns a
+   handle that event_cancel_handle accepts for as long as the event is
+   pending. */
+
+    return event_schedule_seq(time_of_event, type_of_event, event_seq++);
+}
+
+#endif
@@ -0,0 +1,185 @@
+/* This is splitting.c.  Multilevel splitting of rare events, described in
+   splitting.h. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "splitting.h"
+#include "replication.h"
+
+SIMLIB_LOCAL struct splitting splitting;
+
+static int load_error(struct config *cfg, struct config_section *section, const char *message)
+{
+    printf("CONFIG ERROR: %s:%d: [splitting] %s\n", cfg->origin, section->line, message);
+    splitting_free();
+    return -1;
+}
+
+int splitting_load(struct config *cfg, struct config_section *section) /* The [splitting] section, or none */
+{
+    char   copy[CONFIG_LINE_LIMIT], *text, *end, *word;
+    long   level;
+
+    splitting_free();
+    if (section == NULL)
+        return 0;
+
+    if ((text = config_value(cfg, section, "resource")) == NULL)
+        return load_error(cfg, section, "Needs A \"resource\"");
+    splitting.resource = strdup(text);
+
+    if ((text = config_value(cfg, section, "levels")) == NULL)
+        return load_error(cfg, section, "Needs \"levels\"");
+    strncpy(copy, text, CONFIG_LINE_LIMIT - 1);
+    copy[CONFIG_LINE_LIMIT - 1] = '\0';
+    for (word = strtok(copy, " \t,"); word != NULL; word = strtok(NULL, " \t,"))
+    {
+        level = strtol(word, &end, 10);
+        if (*end != '\0' || level < 1 ||
+            (splitting.num_levels > 0 && level <= splitting.levels[splitting.num_levels - 1]))
+            return load_error(cfg, section, "\"levels\" Must Be Increasing Positive Whole Numbers");
+        splitting.levels = (int *) realloc(splitting.levels, (splitting.num_levels + 1) * sizeof(int));
+        splitting.levels[splitting.num_levels++] = (int) level;
+    }
+    if (splitting.num_levels == 0)
+        return load_error(cfg, section, "Needs \"levels\"");
+
+    if ((text = config_value(cfg, section, "horizon")) == NULL ||
+        (splitting.horizon = strtod(text, &end), end == text || *end != '\0') || !(splitting.horizon > 0))
+        return load_error(cfg, section, "Needs A Positive \"horizon\"");
+
+    splitting.effort = 100;
+    if ((text = config_value(cfg, section, "effort")) != NULL &&
+        ((splitting.effort = strtol(text, &end, 10), end == text || *end != '\0') || splitting.effort < 1))
+        return load_error(cfg, section, "\"effort\" Must Be At Least 1");
+
+    splitting.runs = 10;
+    if ((text = config_value(cfg, section, "runs")) != NULL &&
+        ((splitting.runs = strtol(text, &end, 10), end == text || *end != '\0') || splitting.runs < 2))
+        return load_error(cfg, section, "\"runs\" Must Be At Least 2");
+
+    splitting.estimates = (double *) calloc(splitting.runs, sizeof(double));
+    splitting.started   = (long *) calloc(splitting.num_levels, sizeof(long));
+    splitting.crossed   = (long *) calloc(splitting.num_levels, sizeof(long));
+
+    /* Copies are saved into again and again, so they start zeroed. */
+    splitting.from = (struct splitting_state *) calloc(splitting.effort, sizeof(struct splitting_state));
+    splitting.to   = (struct splitting_state *) calloc(splitting.effort, sizeof(struct splitting_state));
+    return 0;
+}
+
+static int trajectory(int level, int first) /* Run until the occupancy reaches level, 1, or the horizon passes, 0 */
+{
+    float start = sim_time;
+    long  events = 0;
+    int   crossed;
+
+    while (!(crossed = list_size[splitting.list] >= level))
+    {
+        if (list_size[LIST_EVENT] == 0 || event_next_time() > splitting.horizon)
+            break;
+        timing();
+        pathway_dispatch();
+        events++;
+    }
+    splitting.events += events;
+
+    /* Trajectories to the first level run at the pace of a crude run. */
+    if (first)
+    {
+        splitting.crude_events  += events;
+        splitting.crude_minutes += (crossed ? sim_time : splitting.horizon) - start;
+    }
+    return crossed;
+}
+
+void splitting_run(int run, void (*reseed)(long trajectory))
+{
+
+/* One estimate, from the model as initialized:  effort trajectories from
+   each level to the next, started from the copies made at the last crossings
+   in turn.  reseed gives each trajectory its own random numbers, numbered
+   from 0 over the runs. */
+
+    struct splitting_state *swap;
+    double estimate = 1;
+    long   number = (long) run * splitting.num_levels * splitting.effort;
+    int    num_from, num_to, k, j;
+
+    simlib_save(&splitting.from[0].simlib);
+    pathway_save(&splitting.from[0].pathway);
+    num_from = 1;
+    for (k = 0; k < splitting.num_levels && num_from > 0; k++)
+    {
+        for (num_to = 0, j = 0; j < splitting.effort; j++)
+        {
+            simlib_restore(&splitting.from[j % num_from].simlib);
+            pathway_restore(&splitting.from[j % num_from].pathway);
+            reseed(number + k * splitting.effort + j);
+            if (trajectory(splitting.levels[k], k == 0))
+            {
+                simlib_save(&splitting.to[num_to].simlib);
+                pathway_save(&splitting.to[num_to].pathway);
+                num_to++;
+            }
+        }
+        splitting.started[k] += splitting.effort;
+        splitting.crossed[k] += num_to;
+        estimate *= (double) num_to / splitting.effort;
+
+        swap = splitting.from;
+        splitting.from = splitting.to;
+        splitting.to = swap;
+        num_from = num_to;
+    }
+    splitting.estimates[run] = num_from > 0 ? estimate : 0;
+}
+
+void splitting_estimate(double *mean, double *half_width, double *crude_runs, double *speed_up)
+{
+
+/* The mean of the runs' estimates and the half-width of its 95% confidence
+   interval;  the crude runs of horizon minutes that would give the same
+   variance, and how many times the events they would take exceed those
+   simulated.  Both are 0 while the event has not been seen. */
+
+    double variance, per_run;
+    int    n = splitting.runs, r;
+
+    for (*mean = 0, r = 0; r < n; r++)
+        *mean += splitting.estimates[r] / n;
+    for (variance = 0, r = 0; r < n; r++)
+        variance += (splitting.estimates[r] - *mean) * (splitting.estimates[r] - *mean);
+    variance /= (double) (n - 1) * n;
+    *half_width = t_quantile(n - 1) * sqrt(variance);
+
+    /* A crude run estimates p with variance p (1 - p) and costs a horizon's events. */
+    *crude_runs = *speed_up = 0;
+    if (*mean > 0 && variance > 0)
+    {
+        *crude_runs = *mean * (1 - *mean) / variance;
+        per_run     = splitting.crude_events / splitting.crude_minutes * splitting.horizon;
+        *speed_up   = *crude_runs * per_run / splitting.events;
+    }
+}
+
+void splitting_free(void) /* Forget the section, its estimates and copies */
+{
+    int j;
+
+    for (j = 0; splitting.from != NULL && j < splitting.effort; j++)
+    {
+        simlib_state_free(&splitting.from[j].simlib);
+        pathway_state_free(&splitting.from[j].pathway);
+        simlib_state_free(&splitting.to[j].simlib);
+        pathway_state_free(&splitting.to[j].pathway);
+    }
+    free(splitting.from);
+    free(splitting.to);
+    free(splitting.resource);
+    free(splitting.levels);
+    free(splitting.estimates);
+    free(splitting.started);
+    free(splitting.crossed);
+    memset(&splitting, 0, sizeof(splitting));
+}
@@ -0,0 +1,54 @@
+/* This is splitting.h.  Probabilities of rare overcrowding by multilevel
+   splitting.
+
+   A [splitting] section estimates the probability that the occupancy of a
+   resource, such as the patients in the department, reaches its top level
+   within horizon minutes of an empty start.  Crude runs would almost never
+   see it;  fixed-effort splitting instead runs effort trajectories from the
+   start up to the first of the increasing levels, copies the simulation
+   wherever one crosses it, and runs effort trajectories again from those
+   copies, each with fresh random numbers, up to the next level, and so on.
+   The product of the fractions that cross each level is an unbiased
+   estimate of the probability.
+
+   The copies are simlib_save and pathway_save states, reused from level to
+   level.  runs independent estimates give the 95% confidence interval, and
+   the events they simulated are compared with those crude runs would need
+   for the same precision. */
+
+#ifndef SPLITTING_H
+#define SPLITTING_H
+
+#include "simlib.h"
+#include "pathway.h"
+#include "config.h"
+
+struct splitting_state {        /* A copy of the simulation at a crossing. */
+    struct simlib_state  simlib;
+    struct pathway_state pathway;
+};
+
+struct splitting {
+    int    runs;                /* 0 when the scenario is run as usual. */
+    char  *resource;            /* Importance function:  this resource's occupancy... */
+    int    list;                /* ...the length of its list, once resolved. */
+    int    num_levels, *levels; /* Increasing, the last the rare event. */
+    int    effort;              /* Trajectories from each level. */
+    float  horizon;             /* Minutes from the start. */
+
+    double *estimates;          /* Of each run. */
+    long   *started, *crossed;  /* Trajectories from and to each level, over the runs. */
+    long   events;              /* Events of every trajectory. */
+    long   crude_events;        /* Events of those to the first level... */
+    double crude_minutes;       /* ...over this much simulated time. */
+    struct splitting_state *from, *to;  /* Copies at the last level and the next. */
+};
+
+extern SIMLIB_LOCAL struct splitting splitting;
+
+extern int   splitting_load(struct config *cfg, struct config_section *section);
+extern void  splitting_run(int run, void (*reseed)(long trajectory));
+extern void  splitting_estimate(double *mean, double *half_width, double *crude_runs, double *speed_up);
+extern void  splitting_free(void);
+
+#endif
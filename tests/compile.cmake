@@ -0,0 +1,21 @@
+# Scenario file errors, run with cmake -P.  Compiles a scenario file that
+# defines a scenario twice with ER_SIM in WORK_DIR, and fails unless the
+# compile stops with status 13 and the CONFIG ERROR naming the second one.
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR})
+file(WRITE ${WORK_DIR}/twice.cfg "[scenario Base]\n\n[scenario Nurses]\nnum_nurses = 5\n\n[scenario Base]\nnum_nurses = 6\n")
+execute_process(COMMAND ${ER_SIM} --compile twice.cfg twice.bin
+                WORKING_DIRECTORY ${WORK_DIR} RESULT_VARIABLE status OUTPUT_VARIABLE output)
+if(NOT status EQUAL 13)
+    message(FATAL_ERROR "Compile ended with status ${status}, not 13:\n${output}")
+endif()
+set(error "CONFIG ERROR: twice.cfg:6: [scenario Base] Defined Twice")
+string(FIND "${output}" "${error}" at)
+if(at EQUAL -1)
+    message(FATAL_ERROR "Compile did not print ${error}:\n${output}")
+endif()
+if(EXISTS ${WORK_DIR}/twice.bin)
+    message(FATAL_ERROR "Compile wrote a cache")
+endif()
+message(STATUS "Scenario defined twice rejected")
@@ -0,0 +1,298 @@
+/* Golden-output regression test.  Runs one scenario of a scenario file
+   through er_sim.c at a fixed seed and compares its statistics, the event
+   count, the list, queue and sampst summaries and any sampled series,
+   against a stored golden file of "key value" lines.
+
+       golden [scenario_file] [scenario_name] [golden_file] [--update] [--tolerance rel]
+
+   Values match when they differ by at most rel times the golden value (or
+   rel itself near zero).  --update rewrites the golden file instead. */
+
+#include <string.h>
+#include <sys/stat.h>
+#include "simlib.h"
+#include "pathway.h"
+#include "sampler.h"
+#include "replication.h"
+#include "splitting.h"
+#include "screen.h"
+#include "monitor.h"
+#include "sensitivity.h"
+#include "scenario.h"
+
+#define GOLDEN_SEED        12345  /* Seed of scenarios that do not fix one. */
+#define GOLDEN_PATIENTS     5000  /* Patients per scenario, to keep the suite fast. */
+#define GOLDEN_TOLERANCE    1e-4  /* Default relative tolerance. */
+#define GOLDEN_KEY_LIMIT      64
+#define GOLDEN_MAX_VALUES    512
+
+/* From er_sim.c, built with ER_SIM_LIBRARY. */
+extern struct config model;
+extern void load_model(void);
+extern void run_scenario(const struct scenario*);
+
+struct golden_value {
+    char   key[GOLDEN_KEY_LIMIT];
+    double value;
+};
+
+static struct golden_value values[GOLDEN_MAX_VALUES];
+static int num_values;
+
+static void record(double value, const char *format, int index) /* Add one statistic */
+{
+    if (num_values == GOLDEN_MAX_VALUES)
+    {
+        printf("GOLDEN ERROR: More Than %d Statistics\n", GOLDEN_MAX_VALUES);
+        exit(1);
+    }
+    snprintf(values[num_values].key, GOLDEN_KEY_LIMIT, format, index);
+    values[num_values++].value = value;
+}
+
+static void collect(void) /* Snapshot the statistics of the finished run */
+{
+    char key[GOLDEN_KEY_LIMIT];
+    int  i;
+
+    record(sim_events, "events", 0);
+    record(sim_time, "sim_time", 0);
+    record(pathway.num_completed, "completed", 0);
+    record(pathway.num_abandoned, "abandoned", 0);
+
+    /* filest of every resource list and of the event list, whose number
+       follows the resources. */
+    for (i = 1; i <= pathway.num_resources; i++)
+    {
+        record(filest(i), "filest.%d.mean", i);
+        record(transfer[2], "filest.%d.max", i);
+        record(transfer[3], "filest.%d.min", i);
+    }
+    record(filest(LIST_EVENT), "filest.event.mean", 0);
+    record(transfer[2], "filest.event.max", 0);
+
+    /* timest of every stage queue. */
+    for (i = 1; i <= pathway.num_stages; i++)
+    {
+        record(timest(0.0, -i), "timest.%d.mean", i);
+        record(transfer[2], "timest.%d.max", i);
+    }
+
+    /* sampst of every variable with observations. */
+    for (i = 1; i <= maxsvar; i++)
+    {
+        sampst(0.0, -i);
+        if (transfer[2] == 0) continue;
+        record(transfer[1], "sampst.%d.mean", i);
+        record(transfer[2], "sampst.%d.count", i);
+        record(transfer[3], "sampst.%d.max", i);
+        record(transfer[4], "sampst.%d.min", i);
+    }
+
+    /* Patients who left without being seen, by acuity, of models with patience. */
+    if (pathway.has_patience)
+    {
+        for (i = 1; i <= MAX_ACUITY; i++)
+        {
+            record(pathway.arrivals[i], "lwbs.%d.arrivals", i);
+            record(pathway.abandoned[i], "lwbs.%d.abandoned", i);
+        }
+    }
+
+    /* Diversion, of models with policies, up to the end of the run. */
+    if (pathway.num_diversions > 0)
+    {
+        record((pathway.diverting_time + (pathway.diverting ? sim_time - pathway.diverting_since : 0)) / 60,
+               "diversion.hours", 0);
+        record(pathway.num_episodes, "diversion.episodes", 0);
+        record(pathway.num_diverted, "diversion.diverted", 0);
+    }
+
+    /* Estimates over the replications of each resource's occupancy. */
+    if (replications.runs >= 2)
+    {
+        double mean, half_width, factor;
+
+        for (i = 1; i <= replications.num_outputs; i++)
+        {
+            replications_estimate(i - 1, &mean, &half_width, &factor);
+            record(mean, "replications.%d.mean", i);
+            record(half_width, "replications.%d.half_width", i);
+            record(factor, "replications.%d.factor", i);
+        }
+    }
+
+    /* The rare event's probability, estimated by splitting. */
+    if (splitting.runs > 0)
+    {
+        double mean, half_width, crude_runs, speed_up;
+
+        splitting_estimate(&mean, &half_width, &crude_runs, &speed_up);
+        record(mean, "splitting.mean", 0);
+        record(half_width, "splitting.half_width", 0);
+        record(splitting.events, "splitting.events", 0);
+        for (i = 0; i < splitting.num_levels; i++)
+            record(splitting.crossed[i], "splitting.%d.crossed", i);
+    }
+
+    /* The analytic approximation of a screened pathway. */
+    if (screen.enabled && screen.screened)
+    {
+        record(screen.stable, "screen.stable", 0);
+        record(screen.utilization, "screen.utilization", 0);
+        record(screen.events, "screen.events", 0);
+        for (i = 1; i <= pathway.num_resources; i++)
+            record(screen.load[i], "screen.%d.load", i);
+        for (i = 1; i <= pathway.num_stages; i++)
+        {
+            if (pathway.stages[i].kind == STAGE_SERVICE)
+                record(screen.waiting[i], "screen.%d.waiting", i);
+        }
+    }
+
+    /* The batch means of a monitored run, and why it stopped. */
+    if (monitor.batch > 0)
+    {
+        record(monitor.status, "monitor.status", 0);
+        record(monitor.batches, "monitor.batches", 0);
+        record(monitor.kept, "monitor.kept", 0);
+        record(monitor.z, "monitor.z", 0);
+        record(monitor.width, "monitor.width", 0);
+    }
+
+    /* Derivatives of the averaged levels by each parameter. */
+    for (i = 0; i < sensitivity.num_levels; i++)
+    {
+        for (int j = 0; j < sensitivity.num_params; j++)
+        {
+            snprintf(key, GOLDEN_KEY_LIMIT, "sensitivity.%%d.%s", sensitivity.names[j]);
+            record(sensitivity_derivative(i, j), key, i);
+        }
+    }
+
+    /* The sampled series of the last run, each column averaged over its rows. */
+    if (sampler.interval > 0)
+    {
+        record(sampler.num_columns, "series.columns", 0);
+        record(sampler.num_rows, "series.rows", 0);
+        for (i = 0; i < sampler.num_columns; i++)
+        {
+            double sum = 0;
+
+            for (int row = 0; row < sampler.num_rows; row++)
+                sum += sampler.mean[row * sampler.num_columns + i];
+            record(sampler.num_rows > 0 ? sum / sampler.num_rows : 0, "series.%d.mean", i);
+        }
+    }
+}
+
+static int update(const char *path) /* Write the golden file */
+{
+    FILE *file;
+    int   i;
+
+    if ((file = fopen(path, "w")) == NULL)
+    {
+        printf("FILE ERROR: Golden File \"%s\" Cannot Be Opened\n", path);
+        return 4;
+    }
+    for (i = 0; i < num_values; i++)
+        fprintf(file, "%s %.9g\n", values[i].key, values[i].value);
+    fclose(file);
+    return 0;
+}
+
+static int compare(const char *path, double tolerance) /* Check against the golden file */
+{
+    FILE  *file;
+    char   key[GOLDEN_KEY_LIMIT];
+    double expected, limit;
+    int    i, num_golden, num_failed;
+
+    if ((file = fopen(path, "r")) == NULL)
+    {
+        printf("FILE ERROR: Golden File \"%s\" Cannot Be Opened\n", path);
+        return 4;
+    }
+
+    num_golden = num_failed = 0;
+    while (fscanf(file, "%63s %lf", key, &expected) == 2)
+    {
+        num_golden++;
+        for (i = 0; i < num_values && strcmp(values[i].key, key) != 0; i++)
+            ;
+        if (i == num_values)
+        {
+            printf("GOLDEN ERROR: %s Missing From The Run\n", key);
+            num_failed++;
+            continue;
+        }
+        limit = tolerance * (fabs(expected) > 1 ? fabs(expected) : 1);
+        if (fabs(values[i].value - expected) > limit)
+        {
+            printf("GOLDEN ERROR: %s Is %.9g, Golden %.9g\n", key, values[i].value, expected);
+            num_failed++;
+        }
+    }
+    fclose(file);
+
+    if (num_golden != num_values)
+    {
+        printf("GOLDEN ERROR: Run Has %d Statistics, Golden File %d\n", num_values, num_golden);
+        num_failed++;
+    }
+    return num_failed > 0;
+}
+
+int main(int argc, char** argv)
+{
+    struct scenario        scenario;
+    struct config_section *section;
+    double tolerance = GOLDEN_TOLERANCE;
+    int    updating = 0, i;
+
+    for (i = 4; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+            updating = 1;
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else
+            argc = 0;
+    }
+    if (argc < 4)
+    {
+        printf("USAGE ERROR: Usage %s [scenario_file] [scenario_name] [golden_file] [--update] [--tolerance rel]\n",
+               argv[0]);
+        return 1;
+    }
+
+    /* Load the scenario as er_sim does, then pin its seed and length. */
+    if (config_read(&model, argv[1]) != 0)
+        return 13;
+    if ((section = config_find(&model, "scenario", argv[2])) == NULL)
+    {
+        printf("CONFIG ERROR: %s: No [scenario %s] Section\n", argv[1], argv[2]);
+        return 13;
+    }
+    scenario_defaults(&scenario);
+    strcpy(scenario.name, argv[2]);
+    if ((config_find(&model, "defaults", NULL) != NULL &&
+         scenario_load(&scenario, &model, config_find(&model, "defaults", NULL)) != 0) ||
+        scenario_load(&scenario, &model, section) != 0)
+        return 2;
+    if (scenario.seed == 0)
+        scenario.seed = GOLDEN_SEED;
+    /* A monitor stops its run once it converges or finds it unstable. */
+    if (scenario.value[P_GOAL_PATIENTS_SIMULATED] > GOLDEN_PATIENTS &&
+        config_find(&model, "monitor", NULL) == NULL)
+        scenario.value[P_GOAL_PATIENTS_SIMULATED] = GOLDEN_PATIENTS;
+    load_model();
+
+    /* Reports go to out/ under the test's working directory. */
+    mkdir("out", 0777);
+    run_scenario(&scenario);
+    collect();
+
+    return updating ? update(argv[3]) : compare(argv[3], tolerance);
+}
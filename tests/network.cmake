@@ -0,0 +1,68 @@
+# Multi-site determinism test, run with cmake -P.  Runs network NETWORK of
+# CONFIG with ER_SIM in parallel twice, sequentially once and optimistically
+# OPTIMISTIC_RUNS times (default 1), each in its own directory under
+# WORK_DIR, and fails unless every site report is identical;  the optimistic
+# reports up to their synchronization counts, which differ by design.  DELAY,
+# if given, replaces the network's delay, since a short one makes for many
+# rollbacks.
+
+if(DEFINED DELAY)
+    file(READ ${CONFIG} text)
+    string(REGEX REPLACE "\ndelay *= *[^\n]*" "\ndelay = ${DELAY}" text "${text}")
+    set(CONFIG ${WORK_DIR}/network.cfg)
+    file(WRITE ${CONFIG} "${text}")
+endif()
+if(NOT DEFINED OPTIMISTIC_RUNS)
+    set(OPTIMISTIC_RUNS 1)
+endif()
+set(optimistic_runs)
+foreach(i RANGE 1 ${OPTIMISTIC_RUNS})
+    list(APPEND optimistic_runs optimistic_${i})
+endforeach()
+
+foreach(run parallel_1 parallel_2 sequential ${optimistic_runs})
+    file(REMOVE_RECURSE ${WORK_DIR}/${run})
+    file(MAKE_DIRECTORY ${WORK_DIR}/${run}/out)
+    if(run STREQUAL "sequential")
+        set(mode --sequential)
+    elseif(run MATCHES "^optimistic")
+        set(mode --optimistic)
+    else()
+        set(mode)
+    endif()
+    execute_process(COMMAND ${ER_SIM} --network ${CONFIG} ${NETWORK} ${mode}
+                    WORKING_DIRECTORY ${WORK_DIR}/${run} RESULT_VARIABLE status)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "${run} run failed with status ${status}")
+    endif()
+endforeach()
+
+file(GLOB reports RELATIVE ${WORK_DIR}/sequential/out ${WORK_DIR}/sequential/out/*.out)
+list(LENGTH reports num_reports)
+if(num_reports EQUAL 0)
+    message(FATAL_ERROR "No site reports written")
+endif()
+foreach(report ${reports})
+    foreach(run parallel_1 parallel_2)
+        execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files
+                                ${WORK_DIR}/sequential/out/${report} ${WORK_DIR}/${run}/out/${report}
+                        RESULT_VARIABLE status)
+        if(NOT status EQUAL 0)
+            message(FATAL_ERROR "${run} ${report} differs from the sequential run")
+        endif()
+    endforeach()
+    foreach(run sequential ${optimistic_runs})
+        file(READ ${WORK_DIR}/${run}/out/${report} text)
+        string(FIND "${text}" "[SYNCHRONIZATION]" end)
+        if(end EQUAL -1)
+            message(FATAL_ERROR "${run} ${report} has no synchronization counts")
+        endif()
+        string(SUBSTRING "${text}" 0 ${end} ${run}_text)
+    endforeach()
+    foreach(run ${optimistic_runs})
+        if(NOT sequential_text STREQUAL ${run}_text)
+            message(FATAL_ERROR "${run} ${report} differs from the sequential run")
+        endif()
+    endforeach()
+endforeach()
+message(STATUS "${num_reports} site reports identical")
@@ -0,0 +1,247 @@
+/* Process layer test.  Checks the coroutines of process.c on small models:
+   a released unit goes to the first waiter through an event of its own,
+   frames are reused and never move as the pool grows past a chunk, and an
+   M/M/c queue of seizing processes keeps the same units in use, queue and
+   time-average occupancy as the same queue written as events on simlib
+   lists.  Prints each failure and exits with status 1 if there was one. */
+
+#include "simlib.h"
+#include "process.h"
+
+#define EVENT_RESUME     1      /* Process events. */
+#define EVENT_ARRIVAL    2      /* Events of the event-driven queue... */
+#define EVENT_DEPARTURE  3
+#define LIST_SERVERS     1      /* ...units in use... */
+#define LIST_QUEUE       2      /* ...and patients waiting, by arrival time. */
+#define NUM_SERVERS      7
+#define MEAN_ARRIVAL     1.5
+#define MEAN_SERVICE     10.0
+#define RUN_LENGTH       20000.0
+#define SEED             12345
+
+struct visit {                  /* Frame of every test process. */
+    struct process process;
+    int    index;               /* Order of starting... */
+    int    granted;             /* ...and units handed out when it released. */
+};
+
+static struct process_resource nurses;
+static int   num_failed, num_granted, order[3];
+static float granted_at[3];
+static long  completed;
+
+static void check(int ok, const char *what) /* Count and print a failed check */
+{
+    if (!ok)
+    {
+        printf("PROCESS ERROR: %s\n", what);
+        num_failed++;
+    }
+}
+
+static void start_model(void) /* A fresh simlib with the streams at their seeds */
+{
+    maxatr  = 4;
+    maxlist = 3;
+    maxtvar = 1;
+    init_simlib();
+    process_init(sizeof(struct visit), EVENT_RESUME);
+    lcgrandst(stream_seed(SEED, 2), 2);
+    lcgrandst(stream_seed(SEED, 3), 3);
+}
+
+static void run_processes(void) /* Resume processes until none is pending */
+{
+    while (list_size[LIST_EVENT] > 0)
+    {
+        timing();
+        process_resume();
+    }
+}
+
+/* FIFO hand-off. */
+
+static void holder(struct process *self) /* Holds a unit for a minute */
+{
+    struct visit *visit = (struct visit *) self;
+
+    PROCESS_BEGIN(self);
+    PROCESS_SEIZE(self, &nurses);
+    granted_at[num_granted]  = sim_time;
+    order[num_granted++]     = visit->index;
+    PROCESS_DELAY(self, 1);
+    visit->granted = num_granted;
+    process_release(&nurses);
+    check(num_granted == visit->granted, "Release resumed the waiter inside the releasing process");
+    check(nurses.in_use == 1 || nurses.length > 0 || visit->index == 2,
+          "A unit handed to a waiter was counted free");
+    PROCESS_END(self);
+}
+
+static void test_handoff(void)
+{
+    struct visit *visit;
+    int    i;
+
+    start_model();
+    nurses = (struct process_resource) {.capacity = 1, .busy = timest_register(1)};
+    num_granted = 0;
+    for (i = 0; i < 3; i++)
+    {
+        visit = (struct visit *) process_start(holder, 0);
+        visit->index = i;
+    }
+    run_processes();
+
+    check(num_granted == 3, "Not every waiter got the unit");
+    for (i = 0; i < num_granted; i++)
+    {
+        check(order[i] == i, "Waiters were not served first come, first served");
+        check(granted_at[i] == i, "A waiter did not get the unit when it was released");
+    }
+    check(nurses.in_use == 0 && nurses.length == 0 && nurses.head == 0 && nurses.tail == 0,
+          "The resource was not left idle and empty");
+    check(timest(0.0, -1) == 1, "The unit was not busy all the time");
+    check(processes.alive == 0, "Processes were left alive");
+}
+
+/* Frame reuse and pool growth. */
+
+static void wait_minute(struct process *self) /* Waits a minute */
+{
+    PROCESS_BEGIN(self);
+    PROCESS_DELAY(self, 1);
+    PROCESS_END(self);
+}
+
+static void test_pool(void)
+{
+    struct process *first, *again;
+    struct visit   *visit;
+    int    i;
+
+    start_model();
+    first = process_start(wait_minute, 0);
+    visit = (struct visit *) first;
+    visit->index = 42;
+    run_processes();
+    again = process_start(wait_minute, 0);
+    check(again == first && again->id == first->id, "An ended process's frame was not reused");
+    check(((struct visit *) again)->index == 0, "A reused frame was not zeroed");
+    run_processes();
+
+    /* A chunk and one frame alive at once;  the first chunk stays put. */
+    for (i = 0; i <= PROCESS_CHUNK; i++)
+        process_start(wait_minute, 0);
+    check(processes.num_chunks == 2, "The pool did not grow by one chunk past its first");
+    check(processes.alive == PROCESS_CHUNK + 1, "Processes alive were miscounted");
+    check(process_frame(first->id) == first, "A frame moved when the pool grew");
+    run_processes();
+    check(processes.alive == 0, "Processes were left alive");
+
+    for (i = 0; i <= PROCESS_CHUNK; i++)
+        process_start(wait_minute, 0);
+    check(processes.num_chunks == 2, "The pool grew although enough frames were free");
+    run_processes();
+    process_free();
+}
+
+/* An M/M/c queue, as processes and as events. */
+
+static void patient(struct process *self) /* Seizes a nurse for a service time */
+{
+    PROCESS_BEGIN(self);
+    PROCESS_SEIZE(self, &nurses);
+    PROCESS_DELAY(self, expon(MEAN_SERVICE, 2));
+    process_release(&nurses);
+    completed++;
+    PROCESS_END(self);
+}
+
+static void arrivals(struct process *self) /* Starts the patients */
+{
+    PROCESS_BEGIN(self);
+    for (;;)
+    {
+        process_start(patient, 0);
+        PROCESS_DELAY(self, expon(MEAN_ARRIVAL, 3));
+    }
+    PROCESS_END(self);
+}
+
+static void test_queue(void)
+{
+    float occupancy, max_in_use;
+    long  process_completed;
+    int   in_use, waiting;
+
+    /* Processes, with the units in use as timest variable 1. */
+    start_model();
+    nurses = (struct process_resource) {.capacity = NUM_SERVERS, .busy = timest_register(1)};
+    completed = 0;
+    process_start(arrivals, 0);
+    while (event_next_time() <= RUN_LENGTH)
+    {
+        timing();
+        process_resume();
+    }
+    sim_time = RUN_LENGTH;
+    occupancy  = timest(0.0, -1);
+    max_in_use = transfer[2];
+    in_use  = nurses.in_use;
+    waiting = nurses.length;
+    process_completed = completed;
+    process_free();
+
+    /* Events, with the units in use as records of a list. */
+    start_model();
+    completed = 0;
+    event_schedule(0, EVENT_ARRIVAL);
+    while (event_next_time() <= RUN_LENGTH)
+    {
+        timing();
+        if (next_event_type == EVENT_ARRIVAL)
+        {
+            event_schedule(sim_time + expon(MEAN_ARRIVAL, 3), EVENT_ARRIVAL);
+            if (list_size[LIST_SERVERS] < NUM_SERVERS)
+            {
+                list_file(FIRST, LIST_SERVERS);
+                event_schedule(sim_time + expon(MEAN_SERVICE, 2), EVENT_DEPARTURE);
+            }
+            else
+            {
+                transfer[1] = sim_time;
+                list_file(LAST, LIST_QUEUE);
+            }
+        }
+        else
+        {
+            /* The unit passes straight to the first waiter. */
+            if (list_size[LIST_QUEUE] > 0)
+            {
+                list_remove(FIRST, LIST_QUEUE);
+                event_schedule(sim_time + expon(MEAN_SERVICE, 2), EVENT_DEPARTURE);
+            }
+            else
+                list_remove(FIRST, LIST_SERVERS);
+            completed++;
+        }
+    }
+    sim_time = RUN_LENGTH;
+
+    check(process_completed > 0 && process_completed == completed, "Patients completed differ");
+    check(in_use == list_size[LIST_SERVERS], "Units in use at the end differ");
+    check(waiting == list_size[LIST_QUEUE], "Patients waiting at the end differ");
+    check(fabs(occupancy - filest(LIST_SERVERS)) <= 1e-6 * occupancy, "Average units in use differ");
+    check(max_in_use == transfer[2] && max_in_use == NUM_SERVERS, "Most units in use differ");
+}
+
+int main(void)
+{
+    test_handoff();
+    test_pool();
+    test_queue();
+    if (num_failed == 0)
+        printf("Process layer:  hand-off, frames and accounting checked\n");
+    return num_failed > 0;
+}
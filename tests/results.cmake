@@ -0,0 +1,49 @@
+# Result cache test, run with cmake -P.  Compiles CONFIG with ER_SIM and runs
+# the batch twice in WORK_DIR, with a copy of TRACE as models/trace.csv, and
+# fails unless the second batch takes every scenario from the cache with the
+# same reports.  A third, after the trace is edited in place, must take none.
+
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR}/out ${WORK_DIR}/models)
+configure_file(${TRACE} ${WORK_DIR}/models/trace.csv COPYONLY)
+execute_process(COMMAND ${ER_SIM} --compile ${CONFIG} batch.bin
+                WORKING_DIRECTORY ${WORK_DIR} RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "Compiling ${CONFIG} failed with status ${status}")
+endif()
+
+foreach(run first second edited)
+    if(run STREQUAL "edited")
+        file(APPEND ${WORK_DIR}/models/trace.csv "2879.00,walkin,2\n")
+    endif()
+    execute_process(COMMAND ${ER_SIM} --batch batch.bin
+                    WORKING_DIRECTORY ${WORK_DIR} RESULT_VARIABLE status OUTPUT_VARIABLE output)
+    if(NOT status EQUAL 0)
+        message(FATAL_ERROR "${run} batch failed with status ${status}:\n${output}")
+    endif()
+    file(GLOB reports RELATIVE ${WORK_DIR}/out ${WORK_DIR}/out/*.out)
+    list(LENGTH reports num_reports)
+    if(num_reports EQUAL 0)
+        message(FATAL_ERROR "${run} batch wrote no reports")
+    endif()
+    set(${run}_output "${output}")
+    foreach(report ${reports})
+        file(READ ${WORK_DIR}/out/${report} ${run}_${report})
+    endforeach()
+endforeach()
+
+if(first_output MATCHES "Taken From The Result Cache")
+    message(FATAL_ERROR "First batch took scenarios from an empty cache:\n${first_output}")
+endif()
+if(NOT second_output MATCHES "Batch: ${num_reports} Of ${num_reports} Scenarios Taken From The Result Cache")
+    message(FATAL_ERROR "Second batch did not take every scenario from the cache:\n${second_output}")
+endif()
+if(edited_output MATCHES "Taken From The Result Cache")
+    message(FATAL_ERROR "Batch after the trace was edited took scenarios from the cache:\n${edited_output}")
+endif()
+foreach(report ${reports})
+    if(NOT first_${report} STREQUAL second_${report})
+        message(FATAL_ERROR "Cached ${report} differs from the one run")
+    endif()
+endforeach()
+message(STATUS "${num_reports} reports taken from the cache, and run again for an edited trace")
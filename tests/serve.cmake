@@ -0,0 +1,28 @@
+# What-if server test, run with cmake -P.  Sends queries to ER_SIM --serve
+# CONFIG SCENARIO on stdin and fails unless the server warms up, answers a
+# change, rejects a parameter the pathway cannot change and a fractional
+# capacity, and gives the same single replication of the base scenario
+# twice, since replications fork from the same warm copy on the same streams.
+file(MAKE_DIRECTORY ${WORK_DIR}/out)
+file(WRITE ${WORK_DIR}/queries.txt "num_nurses=8\naddmittance_chance=0.5\nreplications=1\nreplications=1\nnum_nurses=7.9\nquit\n")
+execute_process(COMMAND ${ER_SIM} --serve ${CONFIG} ${SCENARIO}
+                INPUT_FILE ${WORK_DIR}/queries.txt OUTPUT_VARIABLE output
+                WORKING_DIRECTORY ${WORK_DIR} RESULT_VARIABLE status)
+if(NOT status EQUAL 0)
+    message(FATAL_ERROR "Server failed with status ${status}:\n${output}")
+endif()
+
+foreach(expected "^ready snapshots=" "\ndone 1 (converged|completed) " "\nerror 2 \"addmittance_chance\" "
+                 "\nanswer 3 1/1 [^\n]*\n" "\nanswer 4 1/1 [^\n]*\n"
+                 "\nerror 5 \"7.9\" Is Not A Valid num_nurses\n")
+    if(NOT output MATCHES "${expected}")
+        message(FATAL_ERROR "No line matching \"${expected}\" in:\n${output}")
+    endif()
+endforeach()
+string(REGEX MATCH "\nanswer 3 1/1 ([^\n]*)" line ${output})
+set(first ${CMAKE_MATCH_1})
+string(REGEX MATCH "\nanswer 4 1/1 ([^\n]*)" line ${output})
+if(NOT first STREQUAL CMAKE_MATCH_1)
+    message(FATAL_ERROR "Repeated query answered differently:\n${output}")
+endif()
+message(STATUS "Server answered every query")
@@ -0,0 +1,29 @@
+# Trace error test, run with cmake -P.  Runs scenario SCENARIO of CONFIG with
+# ER_SIM against malformed copies of its trace, each in its own directory
+# under WORK_DIR as models/trace.csv, and fails unless every run stops with
+# status 13 and the TRACE ERROR naming the bad row.
+
+set(cases bad_time out_of_order bad_acuity)
+set(bad_time_rows "0.60,walkin,3\n3.41,ambulance,4\nnoon,walkin,3\n")
+set(bad_time_error "TRACE ERROR: models/trace.csv:3: Bad Time \"noon\"")
+set(out_of_order_rows "# Arrivals.\n0.60,walkin,3\n8.88,walkin,3\n3.41,ambulance,4\n")
+set(out_of_order_error "TRACE ERROR: models/trace.csv:4: Time Out Of Order \"3.41\"")
+set(bad_acuity_rows "0.60,walkin,3\n3.41,ambulance,12\n")
+set(bad_acuity_error "TRACE ERROR: models/trace.csv:2: Bad Acuity \"12\"")
+
+foreach(case ${cases})
+    file(REMOVE_RECURSE ${WORK_DIR}/${case})
+    file(MAKE_DIRECTORY ${WORK_DIR}/${case}/out)
+    file(WRITE ${WORK_DIR}/${case}/models/trace.csv "${${case}_rows}")
+    execute_process(COMMAND ${ER_SIM} ${CONFIG} ${SCENARIO}
+                    WORKING_DIRECTORY ${WORK_DIR}/${case}
+                    RESULT_VARIABLE status OUTPUT_VARIABLE output)
+    if(NOT status EQUAL 13)
+        message(FATAL_ERROR "${case} run ended with status ${status}, not 13:\n${output}")
+    endif()
+    string(FIND "${output}" "${${case}_error}" at)
+    if(at EQUAL -1)
+        message(FATAL_ERROR "${case} run did not print ${${case}_error}:\n${output}")
+    endif()
+endforeach()
+message(STATUS "${cases} stopped with TRACE ERROR")
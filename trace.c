@@ -0,0 +1,152 @@
+/* This is trace.c.  Arrival traces described in trace.h. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "trace.h"
+
+#define TRACE_FIELD_LIMIT 64    /* Longest field of a row. */
+
+int trace_open(struct trace *trace, const char *path) /* Map a trace file read-only */
+{
+    struct stat info;
+    void  *map;
+    int    fd;
+
+    memset(trace, 0, sizeof(struct trace));
+    if ((fd = open(path, O_RDONLY)) < 0 || fstat(fd, &info) != 0)
+    {
+        printf("FILE ERROR: Trace File \"%s\" Cannot Be Opened\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    /* An empty file maps to nothing and simply has no arrivals. */
+    map = NULL;
+    if (info.st_size > 0)
+    {
+        map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            printf("FILE ERROR: Trace File \"%s\" Cannot Be Mapped\n", path);
+            close(fd);
+            return -1;
+        }
+        madvise(map, info.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    trace->path = strdup(path);
+    trace->data = (const char *) map;
+    trace->size = info.st_size;
+    trace_rewind(trace);
+    return 0;
+}
+
+void trace_rewind(struct trace *trace) /* Read again from the first row */
+{
+    trace->at.offset = 0;
+    trace->at.line   = 1;
+    trace->at.time   = 0;
+    trace->at.acuity = 0;
+}
+
+static size_t field(const char *data, size_t from, size_t end, char *text) /* Copy one field, return its end */
+{
+    size_t to = from;
+
+    while (to < end && data[to] != ',')
+        to++;
+
+    /* Without spaces around it;  a field too long is cut. */
+    while (from < to && (data[from] == ' ' || data[from] == '\t'))
+        from++;
+    while (to > from && (data[to - 1] == ' ' || data[to - 1] == '\t' || data[to - 1] == '\r'))
+        to--;
+    if (to - from >= TRACE_FIELD_LIMIT)
+        to = from + TRACE_FIELD_LIMIT - 1;
+    memcpy(text, data + from, to - from);
+    text[to - from] = '\0';
+
+    while (from < end && data[from] != ',')
+        from++;
+    return from;
+}
+
+int trace_next(struct trace *trace, const char *stage, int max_acuity, char *error, size_t length)
+{
+
+/* Read the next row for the arrival stage named stage into trace->at.
+   Returns 1, or 0 at the end of the trace, or -1 with a message in error
+   when the row is malformed. */
+
+    struct trace_position *at = &trace->at;
+    char   text[TRACE_FIELD_LIMIT], *end;
+    size_t start, stop, next;
+    double time;
+    long   acuity;
+
+    for (; at->offset < trace->size; at->offset = next, at->line++)
+    {
+        start = at->offset;
+        stop  = start;
+        while (stop < trace->size && trace->data[stop] != '\n')
+            stop++;
+        next = stop < trace->size ? stop + 1 : stop;
+
+        /* Skip blank lines and comments. */
+        while (start < stop && (trace->data[start] == ' ' || trace->data[start] == '\t' ||
+                                trace->data[start] == '\r'))
+            start++;
+        if (start == stop || trace->data[start] == '#')
+            continue;
+
+        /* Time. */
+        start = field(trace->data, start, stop, text);
+        time  = strtod(text, &end);
+        if (end == text || *end != '\0' || !((float) time >= at->time))
+        {
+            snprintf(error, length, "TRACE ERROR: %s:%ld: %s \"%s\"\n", trace->path, at->line,
+                     end == text || *end != '\0' ? "Bad Time" : "Time Out Of Order", text);
+            return -1;
+        }
+
+        /* Stage, then acuity, both optional;  further columns are ignored. */
+        if (start < stop)
+        {
+            start = field(trace->data, start + 1, stop, text);
+            if (text[0] != '\0' && strcmp(text, stage) != 0)
+                continue;
+        }
+        acuity = 0;
+        if (start < stop)
+        {
+            start  = field(trace->data, start + 1, stop, text);
+            acuity = text[0] != '\0' ? strtol(text, &end, 10) : 0;
+            if ((text[0] != '\0' && *end != '\0') || acuity < 0 || acuity > max_acuity)
+            {
+                snprintf(error, length, "TRACE ERROR: %s:%ld: Bad Acuity \"%s\"\n",
+                         trace->path, at->line, text);
+                return -1;
+            }
+        }
+
+        at->time   = (float) time;
+        at->acuity = (int) acuity;
+        at->offset = next;
+        at->line++;
+        return 1;
+    }
+    return 0;
+}
+
+void trace_close(struct trace *trace) /* Unmap a trace file */
+{
+    if (trace->data != NULL)
+        munmap((void *) trace->data, trace->size);
+    free(trace->path);
+    memset(trace, 0, sizeof(struct trace));
+}
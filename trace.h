@@ -0,0 +1,40 @@
+/* This is trace.h.  Arrival traces replayed from historical logs.
+
+   A trace is a text file of one arrival per line,
+
+       minutes[,stage[,acuity]]
+
+   with times in minutes from the start of the run, in nondecreasing order.
+   A row naming a stage is taken only by the arrival stage of that name, so
+   one log may feed every arrival mode;  an acuity of 1..MAX_ACUITY replaces
+   the stage's acuity draw.  Blank lines and lines starting with # are
+   skipped, and columns after the acuity are ignored.
+
+   The file is mapped read-only and read one row ahead of the simulation, so
+   a trace of any length costs one pending event per stage and no copy. */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+
+struct trace_position {         /* Where a reader is, saved with the pathway. */
+    size_t offset;              /* Start of the next unread line... */
+    long   line;                /* ...and its line number. */
+    float  time;                /* Time of the row last read... */
+    int    acuity;              /* ...and its acuity, 0 if none. */
+};
+
+struct trace {
+    char  *path;                /* NULL when the stage is not traced. */
+    const char *data;           /* The mapped file... */
+    size_t size;                /* ...of this many bytes. */
+    struct trace_position at;
+};
+
+extern int   trace_open(struct trace *trace, const char *path);
+extern void  trace_rewind(struct trace *trace);
+extern int   trace_next(struct trace *trace, const char *stage, int max_acuity, char *error, size_t length);
+extern void  trace_close(struct trace *trace);
+
+#endif